@@ -27,6 +27,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/animators/Shake.cpp \
     ../../ouzel/assets/Cache.cpp \
     ../../ouzel/assets/Loader.cpp \
+    ../../ouzel/assets/LoadBatch.cpp \
     ../../ouzel/assets/LoaderBMF.cpp \
     ../../ouzel/assets/LoaderCollada.cpp \
     ../../ouzel/assets/LoaderImage.cpp \
@@ -38,19 +39,28 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/assets/LoaderVorbis.cpp \
     ../../ouzel/assets/LoaderWave.cpp \
     ../../ouzel/audio/empty/AudioDeviceEmpty.cpp \
+    ../../ouzel/audio/offline/AudioDeviceOffline.cpp \
     ../../ouzel/audio/opensl/AudioDeviceSL.cpp \
     ../../ouzel/audio/Audio.cpp \
     ../../ouzel/audio/AudioDevice.cpp \
+    ../../ouzel/audio/AudioProfiler.cpp \
     ../../ouzel/audio/Listener.cpp \
     ../../ouzel/audio/Mixer.cpp \
+    ../../ouzel/audio/RenderGraph.cpp \
+    ../../ouzel/audio/RenderWorkers.cpp \
+    ../../ouzel/audio/PCMCache.cpp \
+    ../../ouzel/audio/VoiceManager.cpp \
+    ../../ouzel/audio/Resampler.cpp \
     ../../ouzel/audio/Sound.cpp \
     ../../ouzel/audio/SoundData.cpp \
     ../../ouzel/audio/SoundDataVorbis.cpp \
+    ../../ouzel/audio/SoundDataVorbisStreamed.cpp \
     ../../ouzel/audio/SoundDataWave.cpp \
     ../../ouzel/audio/SoundInput.cpp \
     ../../ouzel/audio/SoundOutput.cpp \
     ../../ouzel/audio/Stream.cpp \
     ../../ouzel/audio/StreamVorbis.cpp \
+    ../../ouzel/audio/StreamVorbisStreamed.cpp \
     ../../ouzel/audio/StreamWave.cpp \
     ../../ouzel/core/android/EngineAndroid.cpp \
     ../../ouzel/core/android/main.cpp \
@@ -64,6 +74,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/events/EventHandler.cpp \
     ../../ouzel/files/Archive.cpp \
     ../../ouzel/files/File.cpp \
+    ../../ouzel/files/FileMapping.cpp \
     ../../ouzel/files/FileSystem.cpp \
     ../../ouzel/graphics/empty/BlendStateResourceEmpty.cpp \
     ../../ouzel/graphics/empty/BufferResourceEmpty.cpp \
@@ -135,6 +146,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/network/Client.cpp \
     ../../ouzel/network/Network.cpp \
     ../../ouzel/scene/Actor.cpp \
+    ../../ouzel/scene/AABBTree.cpp \
     ../../ouzel/scene/ActorContainer.cpp \
     ../../ouzel/scene/Camera.cpp \
     ../../ouzel/scene/Component.cpp \
@@ -151,6 +163,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/scene/SpriteData.cpp \
     ../../ouzel/scene/TextRenderer.cpp \
     ../../ouzel/thread/Condition.cpp \
+    ../../ouzel/thread/JobSystem.cpp \
     ../../ouzel/thread/Mutex.cpp \
     ../../ouzel/thread/Thread.cpp \
     ../../ouzel/utils/INI.cpp \
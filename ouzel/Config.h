@@ -0,0 +1,17 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include "core/Platform.h"
+
+#define OUZEL_ENABLE_OPENGL 1
+#define OUZEL_ENABLE_DIRECT3D11 1
+#define OUZEL_ENABLE_METAL 1
+
+#define OUZEL_ENABLE_OPENAL 1
+#define OUZEL_ENABLE_DIRECTSOUND 1
+#define OUZEL_ENABLE_XAUDIO2 1
+#define OUZEL_ENABLE_OPENSL 1
+#define OUZEL_ENABLE_COREAUDIO 1
+#define OUZEL_ENABLE_ALSA 1
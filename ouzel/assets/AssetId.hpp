@@ -0,0 +1,52 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ouzel
+{
+    namespace assets
+    {
+        // 64-bit FNV-1a
+        const uint64_t ASSET_ID_OFFSET_BASIS = 14695981039346656037ULL;
+        const uint64_t ASSET_ID_PRIME = 1099511628211ULL;
+
+        constexpr uint64_t hashAssetName(const char* name, uint64_t hash = ASSET_ID_OFFSET_BASIS)
+        {
+            return *name ? hashAssetName(name + 1, (hash ^ static_cast<unsigned char>(*name)) * ASSET_ID_PRIME) : hash;
+        }
+
+        inline uint64_t hashAssetName(const std::string& name)
+        {
+            uint64_t hash = ASSET_ID_OFFSET_BASIS;
+
+            for (char c : name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * ASSET_ID_PRIME;
+            }
+
+            return hash;
+        }
+
+        // Asset name hashed once, so that it can be looked up without comparing strings. Keep the ids of the assets
+        // that are looked up often instead of their names.
+        class AssetId final
+        {
+        public:
+            constexpr AssetId(): hash(ASSET_ID_OFFSET_BASIS) {}
+            explicit constexpr AssetId(const char* name): hash(hashAssetName(name)) {}
+            explicit AssetId(const std::string& name): hash(hashAssetName(name)) {}
+
+            constexpr uint64_t getHash() const { return hash; }
+
+            constexpr bool operator==(const AssetId& other) const { return hash == other.hash; }
+            constexpr bool operator!=(const AssetId& other) const { return hash != other.hash; }
+
+        private:
+            uint64_t hash;
+        };
+    } // namespace assets
+} // namespace ouzel
@@ -0,0 +1,209 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "assets/AssetId.hpp"
+#include "utils/Log.hpp"
+
+namespace ouzel
+{
+    namespace assets
+    {
+        // Open addressing hash table (linear probing) from asset ids to assets. The assets are stored separately
+        // from the table, so the references to them stay valid when the table grows.
+        template<class T>
+        class AssetMap final
+        {
+        public:
+            T* find(AssetId id)
+            {
+                uint32_t slot = findSlot(id.getHash());
+                return (slot == NONE) ? nullptr : &entries[slots[slot].entry].value;
+            }
+
+            const T* find(AssetId id) const
+            {
+                uint32_t slot = findSlot(id.getHash());
+                return (slot == NONE) ? nullptr : &entries[slots[slot].entry].value;
+            }
+
+            // returns the existing asset or a default constructed one
+            T& insert(AssetId id, const std::string& name)
+            {
+                uint64_t hash = id.getHash();
+                uint32_t slot = findSlot(hash);
+
+                if (slot != NONE)
+                {
+                    Entry& entry = entries[slots[slot].entry];
+                    if (entry.name != name)
+                    {
+                        Log(Log::Level::ERR) << "Asset names " << entry.name << " and " << name << " have the same hash";
+                    }
+
+                    return entry.value;
+                }
+
+                // keep the load factor under 3/4
+                if ((count + 1) * 4 > slots.size() * 3) rehash(slots.empty() ? 16 : static_cast<uint32_t>(slots.size()) * 2);
+
+                uint32_t entryIndex;
+
+                if (freeEntries.empty())
+                {
+                    entryIndex = static_cast<uint32_t>(entries.size());
+                    entries.push_back(Entry());
+                }
+                else
+                {
+                    entryIndex = freeEntries.back();
+                    freeEntries.pop_back();
+                }
+
+                Entry& entry = entries[entryIndex];
+                entry.name = name;
+
+                uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+                for (slot = getHome(hash) & mask; slots[slot].entry != NONE; slot = (slot + 1) & mask);
+
+                slots[slot].hash = hash;
+                slots[slot].entry = entryIndex;
+                ++count;
+
+                return entry.value;
+            }
+
+            bool erase(AssetId id)
+            {
+                uint32_t slot = findSlot(id.getHash());
+                if (slot == NONE) return false;
+
+                freeEntry(slots[slot].entry);
+                removeSlot(slot);
+
+                return true;
+            }
+
+            template<class Predicate>
+            void eraseIf(Predicate predicate)
+            {
+                for (uint32_t slot = 0; slot < slots.size();)
+                {
+                    if (slots[slot].entry != NONE && predicate(entries[slots[slot].entry].name))
+                    {
+                        freeEntry(slots[slot].entry);
+                        // the next slot can be shifted to this one, so the slot is checked again
+                        removeSlot(slot);
+                    }
+                    else
+                    {
+                        ++slot;
+                    }
+                }
+            }
+
+            void clear()
+            {
+                slots.clear();
+                entries.clear();
+                freeEntries.clear();
+                count = 0;
+            }
+
+            inline uint32_t size() const { return count; }
+
+        private:
+            static const uint32_t NONE = 0xFFFFFFFF;
+
+            struct Slot
+            {
+                uint64_t hash = 0;
+                uint32_t entry = NONE;
+            };
+
+            struct Entry
+            {
+                std::string name;
+                T value = T();
+            };
+
+            static inline uint32_t getHome(uint64_t hash)
+            {
+                return static_cast<uint32_t>(hash ^ (hash >> 32));
+            }
+
+            uint32_t findSlot(uint64_t hash) const
+            {
+                if (slots.empty()) return NONE;
+
+                uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+
+                for (uint32_t slot = getHome(hash) & mask; slots[slot].entry != NONE; slot = (slot + 1) & mask)
+                {
+                    if (slots[slot].hash == hash) return slot;
+                }
+
+                return NONE;
+            }
+
+            void rehash(uint32_t newSize)
+            {
+                std::vector<Slot> oldSlots(newSize);
+                oldSlots.swap(slots);
+
+                uint32_t mask = newSize - 1;
+
+                for (const Slot& oldSlot : oldSlots)
+                {
+                    if (oldSlot.entry == NONE) continue;
+
+                    uint32_t slot;
+                    for (slot = getHome(oldSlot.hash) & mask; slots[slot].entry != NONE; slot = (slot + 1) & mask);
+                    slots[slot] = oldSlot;
+                }
+            }
+
+            void freeEntry(uint32_t entryIndex)
+            {
+                Entry& entry = entries[entryIndex];
+                entry.name.clear();
+                entry.value = T();
+                freeEntries.push_back(entryIndex);
+            }
+
+            // backward shift deletion, so that no tombstones are needed
+            void removeSlot(uint32_t slot)
+            {
+                uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+                uint32_t next = slot;
+
+                for (;;)
+                {
+                    next = (next + 1) & mask;
+                    if (slots[next].entry == NONE) break;
+
+                    // the entry can be moved if its home is not in the (slot, next] range
+                    uint32_t home = getHome(slots[next].hash) & mask;
+                    if (((next - home) & mask) >= ((next - slot) & mask))
+                    {
+                        slots[slot] = slots[next];
+                        slot = next;
+                    }
+                }
+
+                slots[slot] = Slot();
+                --count;
+            }
+
+            std::vector<Slot> slots; // size is a power of two
+            std::deque<Entry> entries;
+            std::vector<uint32_t> freeEntries;
+            uint32_t count = 0;
+        };
+    } // namespace assets
+} // namespace ouzel
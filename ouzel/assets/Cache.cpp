@@ -12,6 +12,7 @@
 #include "scene/ParticleSystemData.hpp"
 #include "scene/SpriteData.hpp"
 #include "files/FileSystem.hpp"
+#include "files/FileMapping.hpp"
 #include "audio/SoundDataWave.hpp"
 #include "audio/SoundDataVorbis.hpp"
 #include "gui/BMFont.hpp"
@@ -22,7 +23,15 @@ namespace ouzel
 {
     namespace assets
     {
-        Cache::Cache()
+        template<class T>
+        static T findAsset(const AssetMap<T>& assets, AssetId id)
+        {
+            const T* asset = assets.find(id);
+            return asset ? *asset : T();
+        }
+
+        Cache::Cache():
+            pcmCache(std::make_shared<audio::PCMCache>())
         {
             addLoader(&loaderBMF);
             addLoader(&loaderCollada);
@@ -79,8 +88,8 @@ namespace ouzel
 
         bool Cache::loadAsset(uint32_t loaderType, const std::string& filename, bool mipmaps) const
         {
-            std::vector<uint8_t> data;
-            if (!engine->getFileSystem()->readFile(filename, data))
+            FileMapping mapping;
+            if (!engine->getFileSystem()->mapFile(filename, mapping))
             {
                 return false;
             }
@@ -94,7 +103,7 @@ namespace ouzel
                 if (loader->getType() == loaderType &&
                     std::find(loader->extensions.begin(), loader->extensions.end(), extension) != loader->extensions.end())
                 {
-                    if (loader->loadAsset(filename, data, mipmaps)) return true;
+                    if (loader->loadAsset(filename, mapping.getData(), mipmaps)) return true;
                 }
             }
 
@@ -104,8 +113,8 @@ namespace ouzel
 
         bool Cache::loadAsset(const std::string& filename, bool mipmaps) const
         {
-            std::vector<uint8_t> data;
-            if (!engine->getFileSystem()->readFile(filename, data))
+            FileMapping mapping;
+            if (!engine->getFileSystem()->mapFile(filename, mapping))
             {
                 return false;
             }
@@ -118,7 +127,7 @@ namespace ouzel
                 Loader* loader = *i;
                 if (std::find(loader->extensions.begin(), loader->extensions.end(), extension) != loader->extensions.end())
                 {
-                    if (loader->loadAsset(filename, data, mipmaps)) return true;
+                    if (loader->loadAsset(filename, mapping.getData(), mipmaps)) return true;
                 }
             }
 
@@ -136,123 +145,170 @@ namespace ouzel
             return true;
         }
 
-        const std::shared_ptr<graphics::Texture>& Cache::getTexture(const std::string& filename, bool mipmaps) const
+        std::shared_ptr<LoadBatch> Cache::loadAssetsAsync(const std::vector<std::string>& filenames,
+                                                          const std::function<void(const LoadBatch&)>& callback,
+                                                          bool mipmaps)
         {
-            auto i = textures.find(filename);
+            std::shared_ptr<LoadBatch> batch = std::make_shared<LoadBatch>(static_cast<uint32_t>(filenames.size()), callback);
 
-            if (i == textures.end())
+            if (filenames.empty())
             {
-                loadAsset(Loader::IMAGE, filename, mipmaps);
+                engine->executeOnUpdateThread(std::bind(&LoadBatch::complete, batch));
+                return batch;
+            }
 
-                i = textures.find(filename);
+            {
+                Lock lock(batchMutex);
 
-                if (i == textures.end())
-                {
-                    std::shared_ptr<graphics::Texture> result;
-                    i = textures.insert(std::make_pair(filename, result)).first;
-                }
+                batches.erase(std::remove_if(batches.begin(), batches.end(),
+                                             [](const std::weak_ptr<LoadBatch>& b) { return b.expired(); }),
+                              batches.end());
+                batches.push_back(batch);
             }
 
-            return i->second;
-        }
-
-        void Cache::setTexture(const std::string& filename, const std::shared_ptr<graphics::Texture>& texture)
-        {
-            textures[filename] = texture;
-        }
+            JobSystem* jobSystem = engine->getJobSystem();
 
-        void Cache::releaseTextures()
-        {
-            for (auto i = textures.begin(); i != textures.end();)
+            for (const std::string& filename : filenames)
             {
-                // don't delete white pixel texture
-                if (i->first == graphics::TEXTURE_WHITE_PIXEL)
+                std::function<void()> job = [this, batch, filename, mipmaps]() {
+                    bool success = !batch->isCancelled() && loadAsset(filename, mipmaps);
+
+                    if (batch->finishAsset(success))
+                    {
+                        engine->executeOnUpdateThread(std::bind(&LoadBatch::complete, batch));
+                    }
+                };
+
+                // without workers the assets are loaded one by one on the update thread
+                if (jobSystem && jobSystem->getWorkerCount() > 0)
                 {
-                    ++i;
+                    jobSystem->runBackground(job, &loadCounter);
                 }
                 else
                 {
-                    i = textures.erase(i);
+                    engine->executeOnUpdateThread(job);
                 }
             }
+
+            return batch;
         }
 
-        const std::shared_ptr<graphics::Shader>& Cache::getShader(const std::string& shaderName) const
+        void Cache::cancelAsyncLoads()
         {
-            auto i = shaders.find(shaderName);
-
-            if (i != shaders.end())
             {
-                return i->second;
+                Lock lock(batchMutex);
+
+                for (const std::weak_ptr<LoadBatch>& b : batches)
+                {
+                    if (std::shared_ptr<LoadBatch> batch = b.lock()) batch->cancel();
+                }
+
+                batches.clear();
             }
-            else
+
+            if (JobSystem* jobSystem = engine->getJobSystem()) jobSystem->wait(loadCounter);
+        }
+
+        std::shared_ptr<graphics::Texture> Cache::getTexture(const std::string& filename, bool mipmaps) const
+        {
+            AssetId id(filename);
+
             {
-                i = shaders.insert(std::make_pair(shaderName, nullptr)).first;
+                Lock lock(assetMutex);
 
-                return i->second;
+                if (const std::shared_ptr<graphics::Texture>* texture = textures.find(id)) return *texture;
             }
+
+            // the loaders call the setters, so the mutex can't be locked while loading
+            loadAsset(Loader::IMAGE, filename, mipmaps);
+
+            Lock lock(assetMutex);
+
+            return textures.insert(id, filename);
+        }
+
+        std::shared_ptr<graphics::Texture> Cache::getTexture(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(textures, id);
+        }
+
+        void Cache::setTexture(const std::string& filename, const std::shared_ptr<graphics::Texture>& texture)
+        {
+            Lock lock(assetMutex);
+            textures.insert(AssetId(filename), filename) = texture;
+        }
+
+        void Cache::releaseTextures()
+        {
+            Lock lock(assetMutex);
+
+            // don't delete white pixel texture
+            textures.eraseIf([](const std::string& name) {
+                return name != graphics::TEXTURE_WHITE_PIXEL;
+            });
+        }
+
+        std::shared_ptr<graphics::Shader> Cache::getShader(const std::string& shaderName) const
+        {
+            Lock lock(assetMutex);
+
+            return shaders.insert(AssetId(shaderName), shaderName);
+        }
+
+        std::shared_ptr<graphics::Shader> Cache::getShader(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(shaders, id);
         }
 
         void Cache::setShader(const std::string& shaderName, const std::shared_ptr<graphics::Shader>& shader)
         {
-            shaders[shaderName] = shader;
+            Lock lock(assetMutex);
+            shaders.insert(AssetId(shaderName), shaderName) = shader;
         }
 
         void Cache::releaseShaders()
         {
-            for (auto i = shaders.begin(); i != shaders.end();)
-            {
-                // don't delete default shaders
-                if (i->first == graphics::SHADER_COLOR ||
-                    i->first == graphics::SHADER_TEXTURE)
-                {
-                    ++i;
-                }
-                else
-                {
-                    i = shaders.erase(i);
-                }
-            }
+            Lock lock(assetMutex);
+
+            // don't delete default shaders
+            shaders.eraseIf([](const std::string& name) {
+                return name != graphics::SHADER_COLOR &&
+                    name != graphics::SHADER_TEXTURE;
+            });
         }
 
-        const std::shared_ptr<graphics::BlendState>& Cache::getBlendState(const std::string& blendStateName) const
+        std::shared_ptr<graphics::BlendState> Cache::getBlendState(const std::string& blendStateName) const
         {
-            auto i = blendStates.find(blendStateName);
+            Lock lock(assetMutex);
 
-            if (i != blendStates.end())
-            {
-                return i->second;
-            }
-            else
-            {
-                i = blendStates.insert(std::make_pair(blendStateName, nullptr)).first;
+            return blendStates.insert(AssetId(blendStateName), blendStateName);
+        }
 
-                return i->second;
-            }
+        std::shared_ptr<graphics::BlendState> Cache::getBlendState(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(blendStates, id);
         }
 
         void Cache::setBlendState(const std::string& blendStateName, const std::shared_ptr<graphics::BlendState>& blendState)
         {
-            blendStates[blendStateName] = blendState;
+            Lock lock(assetMutex);
+            blendStates.insert(AssetId(blendStateName), blendStateName) = blendState;
         }
 
         void Cache::releaseBlendStates()
         {
-            for (auto i = blendStates.begin(); i != blendStates.end();)
-            {
-                // don't delete default blend states
-                if (i->first == graphics::BLEND_NO_BLEND ||
-                    i->first == graphics::BLEND_ADD ||
-                    i->first == graphics::BLEND_MULTIPLY ||
-                    i->first == graphics::BLEND_ALPHA)
-                {
-                    ++i;
-                }
-                else
-                {
-                    i = blendStates.erase(i);
-                }
-            }
+            Lock lock(assetMutex);
+
+            // don't delete default blend states
+            blendStates.eraseIf([](const std::string& name) {
+                return name != graphics::BLEND_NO_BLEND &&
+                    name != graphics::BLEND_ADD &&
+                    name != graphics::BLEND_MULTIPLY &&
+                    name != graphics::BLEND_ALPHA;
+            });
         }
 
         bool Cache::preloadSpriteData(const std::string& filename, bool mipmaps,
@@ -296,7 +352,8 @@ namespace ouzel
 
                 newSpriteData.animations[""] = std::move(animation);
 
-                spriteData[filename] = newSpriteData;
+                Lock lock(assetMutex);
+                spriteData.insert(AssetId(filename), filename) = std::make_shared<const scene::SpriteData>(newSpriteData);
             }
             else
             {
@@ -306,229 +363,258 @@ namespace ouzel
             return true;
         }
 
-        const scene::SpriteData& Cache::getSpriteData(const std::string& filename, bool mipmaps,
-                                                                  uint32_t spritesX, uint32_t spritesY,
-                                                                  const Vector2& pivot) const
+        std::shared_ptr<const scene::SpriteData> Cache::getSpriteData(const std::string& filename, bool mipmaps,
+                                                                      uint32_t spritesX, uint32_t spritesY,
+                                                                      const Vector2& pivot) const
         {
-            auto i = spriteData.find(filename);
+            AssetId id(filename);
 
-            if (i != spriteData.end())
             {
-                return i->second;
+                Lock lock(assetMutex);
+
+                if (const std::shared_ptr<const scene::SpriteData>* data = spriteData.find(id)) return *data;
             }
-            else
+
+            if (std::find(loaderImage.extensions.begin(), loaderImage.extensions.end(),
+                          engine->getFileSystem()->getExtensionPart(filename)) != loaderImage.extensions.end())
             {
-                if (std::find(loaderImage.extensions.begin(), loaderImage.extensions.end(),
-                              engine->getFileSystem()->getExtensionPart(filename)) != loaderImage.extensions.end())
-                {
-                    scene::SpriteData newSpriteData;
+                scene::SpriteData newSpriteData;
 
-                    if (spritesX == 0) spritesX = 1;
-                    if (spritesY == 0) spritesY = 1;
+                if (spritesX == 0) spritesX = 1;
+                if (spritesY == 0) spritesY = 1;
 
-                    newSpriteData.texture = engine->getCache()->getTexture(filename, mipmaps);
+                newSpriteData.texture = engine->getCache()->getTexture(filename, mipmaps);
 
-                    if (newSpriteData.texture)
-                    {
-                        scene::SpriteData::Animation animation;
-                        animation.frames.reserve(spritesX * spritesY);
+                if (newSpriteData.texture)
+                {
+                    scene::SpriteData::Animation animation;
+                    animation.frames.reserve(spritesX * spritesY);
 
-                        Size2 spriteSize = Size2(newSpriteData.texture->getSize().width / spritesX,
-                                                 newSpriteData.texture->getSize().height / spritesY);
+                    Size2 spriteSize = Size2(newSpriteData.texture->getSize().width / spritesX,
+                                             newSpriteData.texture->getSize().height / spritesY);
 
-                        for (uint32_t x = 0; x < spritesX; ++x)
+                    for (uint32_t x = 0; x < spritesX; ++x)
+                    {
+                        for (uint32_t y = 0; y < spritesY; ++y)
                         {
-                            for (uint32_t y = 0; y < spritesY; ++y)
-                            {
-                                Rect rectangle(spriteSize.width * x,
-                                               spriteSize.height * y,
-                                               spriteSize.width,
-                                               spriteSize.height);
-
-                                scene::SpriteData::Frame frame = scene::SpriteData::Frame(filename, newSpriteData.texture->getSize(), rectangle, false, spriteSize, Vector2(), pivot);
-                                animation.frames.push_back(frame);
-                            }
-                        }
+                            Rect rectangle(spriteSize.width * x,
+                                           spriteSize.height * y,
+                                           spriteSize.width,
+                                           spriteSize.height);
 
-                        newSpriteData.animations[""] = std::move(animation);
+                            scene::SpriteData::Frame frame = scene::SpriteData::Frame(filename, newSpriteData.texture->getSize(), rectangle, false, spriteSize, Vector2(), pivot);
+                            animation.frames.push_back(frame);
+                        }
                     }
 
-                    i = spriteData.insert(std::make_pair(filename, newSpriteData)).first;
+                    newSpriteData.animations[""] = std::move(animation);
                 }
-                else
-                {
-                    loadAsset(Loader::SPRITE, filename, mipmaps);
 
-                    i = spriteData.find(filename);
+                Lock lock(assetMutex);
 
-                    if (i == spriteData.end())
-                    {
-                        scene::SpriteData newSpriteData;
-                        i = spriteData.insert(std::make_pair(filename, newSpriteData)).first;
-                    }
-                }
+                return spriteData.insert(id, filename) = std::make_shared<const scene::SpriteData>(newSpriteData);
+            }
+            else
+            {
+                loadAsset(Loader::SPRITE, filename, mipmaps);
+
+                Lock lock(assetMutex);
 
-                return i->second;
+                return spriteData.insert(id, filename);
             }
         }
 
+        std::shared_ptr<const scene::SpriteData> Cache::getSpriteData(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(spriteData, id);
+        }
+
         void Cache::setSpriteData(const std::string& filename, const scene::SpriteData& newSpriteData)
         {
-            spriteData[filename] = newSpriteData;
+            Lock lock(assetMutex);
+            spriteData.insert(AssetId(filename), filename) = std::make_shared<const scene::SpriteData>(newSpriteData);
         }
 
         void Cache::releaseSpriteData()
         {
+            Lock lock(assetMutex);
             spriteData.clear();
         }
 
-        const scene::ParticleSystemData& Cache::getParticleSystemData(const std::string& filename, bool mipmaps) const
+        std::shared_ptr<const scene::ParticleSystemData> Cache::getParticleSystemData(const std::string& filename, bool mipmaps) const
         {
-            auto i = particleSystemData.find(filename);
+            AssetId id(filename);
 
-            if (i == particleSystemData.end())
             {
-                loadAsset(Loader::PARTICLE_SYSTEM, filename, mipmaps);
+                Lock lock(assetMutex);
 
-                i = particleSystemData.find(filename);
-
-                if (i == particleSystemData.end())
-                {
-                    scene::ParticleSystemData newParticleSystemData;
-                    i = particleSystemData.insert(std::make_pair(filename, newParticleSystemData)).first;
-                }
+                if (const std::shared_ptr<const scene::ParticleSystemData>* data = particleSystemData.find(id)) return *data;
             }
 
-            return i->second;
+            loadAsset(Loader::PARTICLE_SYSTEM, filename, mipmaps);
+
+            Lock lock(assetMutex);
+
+            return particleSystemData.insert(id, filename);
+        }
+
+        std::shared_ptr<const scene::ParticleSystemData> Cache::getParticleSystemData(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(particleSystemData, id);
         }
 
         void Cache::setParticleSystemData(const std::string& filename, const scene::ParticleSystemData& newParticleSystemData)
         {
-            particleSystemData[filename] = newParticleSystemData;
+            Lock lock(assetMutex);
+            particleSystemData.insert(AssetId(filename), filename) = std::make_shared<const scene::ParticleSystemData>(newParticleSystemData);
         }
 
         void Cache::releaseParticleSystemData()
         {
+            Lock lock(assetMutex);
             particleSystemData.clear();
         }
 
-        const std::shared_ptr<Font>& Cache::getFont(const std::string& filename, bool mipmaps) const
+        std::shared_ptr<Font> Cache::getFont(const std::string& filename, bool mipmaps) const
         {
-            auto i = fonts.find(filename);
+            AssetId id(filename);
 
-            if (i == fonts.end())
             {
-                loadAsset(Loader::FONT, filename, mipmaps);
-
-                i = fonts.find(filename);
+                Lock lock(assetMutex);
 
-                if (i == fonts.end())
-                {
-                    std::shared_ptr<Font> result;
-                    i = fonts.insert(std::make_pair(filename, result)).first;
-                }
+                if (const std::shared_ptr<Font>* font = fonts.find(id)) return *font;
             }
 
-            return i->second;
+            loadAsset(Loader::FONT, filename, mipmaps);
+
+            Lock lock(assetMutex);
+
+            return fonts.insert(id, filename);
+        }
+
+        std::shared_ptr<Font> Cache::getFont(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(fonts, id);
         }
 
         void Cache::setFont(const std::string& filename, const std::shared_ptr<Font>& font)
         {
-            fonts[filename] = font;
+            Lock lock(assetMutex);
+            fonts.insert(AssetId(filename), filename) = font;
         }
 
         void Cache::releaseFonts()
         {
+            Lock lock(assetMutex);
             fonts.clear();
         }
 
-        const std::shared_ptr<audio::SoundData>& Cache::getSoundData(const std::string& filename) const
+        std::shared_ptr<audio::SoundData> Cache::getSoundData(const std::string& filename) const
         {
-            auto i = soundData.find(filename);
+            AssetId id(filename);
 
-            if (i == soundData.end())
             {
-                loadAsset(Loader::SOUND, filename);
+                Lock lock(assetMutex);
 
-                i = soundData.find(filename);
-
-                if (i == soundData.end())
-                {
-                    std::shared_ptr<audio::SoundData> result;
-                    i = soundData.insert(std::make_pair(filename, result)).first;
-                }
+                if (const std::shared_ptr<audio::SoundData>* data = soundData.find(id)) return *data;
             }
 
-            return i->second;
+            loadAsset(Loader::SOUND, filename);
+
+            Lock lock(assetMutex);
+
+            return soundData.insert(id, filename);
+        }
+
+        std::shared_ptr<audio::SoundData> Cache::getSoundData(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(soundData, id);
         }
 
         void Cache::setSoundData(const std::string& filename, const std::shared_ptr<audio::SoundData>& newSoundData)
         {
-            soundData[filename] = newSoundData;
+            Lock lock(assetMutex);
+            soundData.insert(AssetId(filename), filename) = newSoundData;
         }
 
         void Cache::releaseSoundData()
         {
+            Lock lock(assetMutex);
             soundData.clear();
+            pcmCache->clear();
         }
 
-        const std::shared_ptr<graphics::Material>& Cache::getMaterial(const std::string& filename, bool mipmaps) const
+        std::shared_ptr<graphics::Material> Cache::getMaterial(const std::string& filename, bool mipmaps) const
         {
-            auto i = materials.find(filename);
+            AssetId id(filename);
 
-            if (i == materials.end())
             {
-                loadAsset(Loader::MATERIAL, filename, mipmaps);
-
-                i = materials.find(filename);
+                Lock lock(assetMutex);
 
-                if (i == materials.end())
-                {
-                    std::shared_ptr<graphics::Material> result;
-                    i = materials.insert(std::make_pair(filename, result)).first;
-                }
+                if (const std::shared_ptr<graphics::Material>* material = materials.find(id)) return *material;
             }
 
-            return i->second;
+            loadAsset(Loader::MATERIAL, filename, mipmaps);
+
+            Lock lock(assetMutex);
+
+            return materials.insert(id, filename);
+        }
+
+        std::shared_ptr<graphics::Material> Cache::getMaterial(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(materials, id);
         }
 
         void Cache::setMaterial(const std::string& filename, const std::shared_ptr<graphics::Material>& material)
         {
-            materials[filename] = material;
+            Lock lock(assetMutex);
+            materials.insert(AssetId(filename), filename) = material;
         }
 
         void Cache::releaseMaterials()
         {
+            Lock lock(assetMutex);
             materials.clear();
         }
 
-        const scene::ModelData& Cache::getModelData(const std::string& filename, bool mipmaps) const
+        std::shared_ptr<const scene::ModelData> Cache::getModelData(const std::string& filename, bool mipmaps) const
         {
-            auto i = modelData.find(filename);
+            AssetId id(filename);
 
-            if (i == modelData.end())
             {
-                loadAsset(Loader::MODEL, filename, mipmaps);
-
-                i = modelData.find(filename);
+                Lock lock(assetMutex);
 
-                if (i == modelData.end())
-                {
-                    scene::ModelData newModelData;
-                    i = modelData.insert(std::make_pair(filename, newModelData)).first;
-                }
+                if (const std::shared_ptr<const scene::ModelData>* data = modelData.find(id)) return *data;
             }
 
-            return i->second;
+            loadAsset(Loader::MODEL, filename, mipmaps);
+
+            Lock lock(assetMutex);
+
+            return modelData.insert(id, filename);
+        }
+
+        std::shared_ptr<const scene::ModelData> Cache::getModelData(AssetId id) const
+        {
+            Lock lock(assetMutex);
+            return findAsset(modelData, id);
         }
 
         void Cache::setModelData(const std::string& filename, const scene::ModelData& newModelData)
         {
-            modelData[filename] = newModelData;
+            Lock lock(assetMutex);
+            modelData.insert(AssetId(filename), filename) = std::make_shared<const scene::ModelData>(newModelData);
         }
 
         void Cache::releaseModelData()
         {
+            Lock lock(assetMutex);
             particleSystemData.clear();
         }
     } // namespace assets
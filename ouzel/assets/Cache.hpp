@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
-#include <map>
+#include "assets/AssetId.hpp"
+#include "assets/AssetMap.hpp"
+#include "assets/LoadBatch.hpp"
 #include "assets/LoaderBMF.hpp"
 #include "assets/LoaderCollada.hpp"
 #include "assets/LoaderImage.hpp"
@@ -16,6 +19,7 @@
 #include "assets/LoaderTTF.hpp"
 #include "assets/LoaderVorbis.hpp"
 #include "assets/LoaderWave.hpp"
+#include "audio/PCMCache.hpp"
 #include "audio/SoundData.hpp"
 #include "graphics/BlendState.hpp"
 #include "graphics/Material.hpp"
@@ -25,6 +29,8 @@
 #include "scene/ModelData.hpp"
 #include "scene/SpriteData.hpp"
 #include "scene/ParticleSystemData.hpp"
+#include "thread/JobSystem.hpp"
+#include "thread/Mutex.hpp"
 
 namespace ouzel
 {
@@ -32,6 +38,8 @@ namespace ouzel
     {
         class Loader;
 
+        // The assets can be loaded and set from any thread, but the loaders must not be added or removed and the assets
+        // must not be released while a batch is being loaded.
         class Cache final
         {
         public:
@@ -51,46 +59,67 @@ namespace ouzel
             bool loadAsset(uint32_t loaderType, const std::string& filename, bool mipmaps = true) const;
             bool loadAssets(const std::vector<std::string>& filenames, bool mipmaps = true) const;
 
+            // loads the assets on the worker threads, the assets of the batch must not be used before its callback
+            std::shared_ptr<LoadBatch> loadAssetsAsync(const std::vector<std::string>& filenames,
+                                                       const std::function<void(const LoadBatch&)>& callback = nullptr,
+                                                       bool mipmaps = true);
+            // cancels all batches and waits for the assets that are being loaded
+            void cancelAsyncLoads();
+
             void clear();
 
-            const std::shared_ptr<graphics::Texture>& getTexture(const std::string& filename, bool mipmaps = true) const;
+            // the getters that take an id don't load the asset, they return an empty one if it is not loaded
+            // the returned assets are shared, so they stay valid when the cache entry is replaced or released
+            std::shared_ptr<graphics::Texture> getTexture(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<graphics::Texture> getTexture(AssetId id) const;
             void setTexture(const std::string& filename, const std::shared_ptr<graphics::Texture>& texture);
             void releaseTextures();
 
-            const std::shared_ptr<graphics::Shader>& getShader(const std::string& shaderName) const;
+            std::shared_ptr<graphics::Shader> getShader(const std::string& shaderName) const;
+            std::shared_ptr<graphics::Shader> getShader(AssetId id) const;
             void setShader(const std::string& shaderName, const std::shared_ptr<graphics::Shader>& shader);
             void releaseShaders();
 
-            const std::shared_ptr<graphics::BlendState>& getBlendState(const std::string& blendStateName) const;
+            std::shared_ptr<graphics::BlendState> getBlendState(const std::string& blendStateName) const;
+            std::shared_ptr<graphics::BlendState> getBlendState(AssetId id) const;
             void setBlendState(const std::string& blendStateName, const std::shared_ptr<graphics::BlendState>& blendState);
             void releaseBlendStates();
 
             bool preloadSpriteData(const std::string& filename, bool mipmaps = true,
                                          uint32_t spritesX = 1, uint32_t spritesY = 1,
                                          const Vector2& pivot = Vector2(0.5f, 0.5f));
-            const scene::SpriteData& getSpriteData(const std::string& filename, bool mipmaps = true,
-                                                   uint32_t spritesX = 1, uint32_t spritesY = 1,
-                                                   const Vector2& pivot = Vector2(0.5f, 0.5f)) const;
+            std::shared_ptr<const scene::SpriteData> getSpriteData(const std::string& filename, bool mipmaps = true,
+                                            uint32_t spritesX = 1, uint32_t spritesY = 1,
+                                            const Vector2& pivot = Vector2(0.5f, 0.5f)) const;
+            std::shared_ptr<const scene::SpriteData> getSpriteData(AssetId id) const;
             void setSpriteData(const std::string& filename, const scene::SpriteData& newSpriteData);
             void releaseSpriteData();
 
-            const scene::ParticleSystemData& getParticleSystemData(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<const scene::ParticleSystemData> getParticleSystemData(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<const scene::ParticleSystemData> getParticleSystemData(AssetId id) const;
             void setParticleSystemData(const std::string& filename, const scene::ParticleSystemData& newParticleSystemData);
             void releaseParticleSystemData();
 
-            const std::shared_ptr<Font>& getFont(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<Font> getFont(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<Font> getFont(AssetId id) const;
             void setFont(const std::string& filename, const std::shared_ptr<Font>& font);
             void releaseFonts();
 
-            const std::shared_ptr<audio::SoundData>& getSoundData(const std::string& filename) const;
+            std::shared_ptr<audio::SoundData> getSoundData(const std::string& filename) const;
+            std::shared_ptr<audio::SoundData> getSoundData(AssetId id) const;
             void setSoundData(const std::string& filename, const std::shared_ptr<audio::SoundData>& newSoundData);
             void releaseSoundData();
 
-            const std::shared_ptr<graphics::Material>& getMaterial(const std::string& filename, bool mipmaps = true) const;
+            // pool of the decoded short sounds, its decode and stream thresholds set how sounds are loaded
+            inline const std::shared_ptr<audio::PCMCache>& getPCMCache() const { return pcmCache; }
+
+            std::shared_ptr<graphics::Material> getMaterial(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<graphics::Material> getMaterial(AssetId id) const;
             void setMaterial(const std::string& filename, const std::shared_ptr<graphics::Material>& material);
             void releaseMaterials();
 
-            const scene::ModelData& getModelData(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<const scene::ModelData> getModelData(const std::string& filename, bool mipmaps = true) const;
+            std::shared_ptr<const scene::ModelData> getModelData(AssetId id) const;
             void setModelData(const std::string& filename, const scene::ModelData& newModelData);
             void releaseModelData();
 
@@ -106,15 +135,22 @@ namespace ouzel
             LoaderVorbis loaderVorbis;
             LoaderWave loaderWave;
             std::vector<Loader*> loaders;
-            mutable std::map<std::string, std::shared_ptr<graphics::Texture>> textures;
-            mutable std::map<std::string, std::shared_ptr<graphics::Shader>> shaders;
-            mutable std::map<std::string, scene::ParticleSystemData> particleSystemData;
-            mutable std::map<std::string, std::shared_ptr<graphics::BlendState>> blendStates;
-            mutable std::map<std::string, scene::SpriteData> spriteData;
-            mutable std::map<std::string, std::shared_ptr<Font>> fonts;
-            mutable std::map<std::string, std::shared_ptr<audio::SoundData>> soundData;
-            mutable std::map<std::string, std::shared_ptr<graphics::Material>> materials;
-            mutable std::map<std::string, scene::ModelData> modelData;
+
+            mutable Mutex assetMutex;
+            mutable AssetMap<std::shared_ptr<graphics::Texture>> textures;
+            mutable AssetMap<std::shared_ptr<graphics::Shader>> shaders;
+            mutable AssetMap<std::shared_ptr<const scene::ParticleSystemData>> particleSystemData;
+            mutable AssetMap<std::shared_ptr<graphics::BlendState>> blendStates;
+            mutable AssetMap<std::shared_ptr<const scene::SpriteData>> spriteData;
+            mutable AssetMap<std::shared_ptr<Font>> fonts;
+            mutable AssetMap<std::shared_ptr<audio::SoundData>> soundData;
+            std::shared_ptr<audio::PCMCache> pcmCache;
+            mutable AssetMap<std::shared_ptr<graphics::Material>> materials;
+            mutable AssetMap<std::shared_ptr<const scene::ModelData>> modelData;
+
+            Mutex batchMutex;
+            std::vector<std::weak_ptr<LoadBatch>> batches;
+            JobSystem::Counter loadCounter;
         };
     } // namespace assets
 } // namespace ouzel
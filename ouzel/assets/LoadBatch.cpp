@@ -0,0 +1,37 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "LoadBatch.hpp"
+
+namespace ouzel
+{
+    namespace assets
+    {
+        LoadBatch::LoadBatch(uint32_t initTotal, const std::function<void(const LoadBatch&)>& initCallback):
+            total(initTotal), loaded(0), failed(0), finished(0), cancelled(false), done(false), callback(initCallback)
+        {
+        }
+
+        float LoadBatch::getProgress() const
+        {
+            if (total == 0) return 1.0f;
+
+            return static_cast<float>(finished) / static_cast<float>(total);
+        }
+
+        bool LoadBatch::finishAsset(bool success)
+        {
+            if (success) ++loaded;
+            else ++failed;
+
+            return ++finished == total;
+        }
+
+        void LoadBatch::complete()
+        {
+            done = true;
+
+            if (callback) callback(*this);
+        }
+    } // namespace assets
+} // namespace ouzel
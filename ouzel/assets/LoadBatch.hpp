@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace ouzel
+{
+    namespace assets
+    {
+        class Cache;
+
+        // Progress of assets loaded by Cache::loadAssetsAsync. The counters can be read from any thread,
+        // the callback is called on the update thread after the last asset is done, also if the batch was cancelled.
+        class LoadBatch final
+        {
+            friend Cache;
+        public:
+            LoadBatch(uint32_t initTotal, const std::function<void(const LoadBatch&)>& initCallback);
+
+            LoadBatch(const LoadBatch&) = delete;
+            LoadBatch& operator=(const LoadBatch&) = delete;
+
+            LoadBatch(LoadBatch&&) = delete;
+            LoadBatch& operator=(LoadBatch&&) = delete;
+
+            inline uint32_t getTotal() const { return total; }
+            inline uint32_t getLoaded() const { return loaded; }
+            // assets that failed to load or were skipped because of the cancellation
+            inline uint32_t getFailed() const { return failed; }
+            float getProgress() const;
+
+            // true when the callback is called
+            inline bool isDone() const { return done; }
+
+            // the assets that are not started yet are skipped, the ones being loaded are finished
+            inline void cancel() { cancelled = true; }
+            inline bool isCancelled() const { return cancelled; }
+
+        private:
+            // returns true for the last asset
+            bool finishAsset(bool success);
+            void complete();
+
+            uint32_t total;
+            std::atomic<uint32_t> loaded;
+            std::atomic<uint32_t> failed;
+            std::atomic<uint32_t> finished;
+            std::atomic<bool> cancelled;
+            std::atomic<bool> done;
+            std::function<void(const LoadBatch&)> callback;
+        };
+    } // namespace assets
+} // namespace ouzel
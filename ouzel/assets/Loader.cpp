@@ -26,5 +26,10 @@ namespace ouzel
                 cache->removeLoader(this);
             }
         }
+
+        bool Loader::loadAsset(const std::string& filename, const DataView& data, bool mipmaps)
+        {
+            return loadAsset(filename, std::vector<uint8_t>(data.begin(), data.end()), mipmaps);
+        }
     } // namespace assets
 } // namespace ouzel
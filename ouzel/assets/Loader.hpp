@@ -5,6 +5,7 @@
 
 #include <string>
 #include <vector>
+#include "files/DataView.hpp"
 
 namespace ouzel
 {
@@ -41,6 +42,8 @@ namespace ouzel
             inline uint32_t getType() const { return type; }
 
             virtual bool loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps = true) = 0;
+            // the data is valid only during the call, by default it is copied to a vector
+            virtual bool loadAsset(const std::string& filename, const DataView& data, bool mipmaps = true);
 
         protected:
             uint32_t type = Type::NONE;
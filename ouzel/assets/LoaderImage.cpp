@@ -22,6 +22,11 @@ namespace ouzel
         }
 
         bool LoaderImage::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        {
+            return loadAsset(filename, DataView(data), mipmaps);
+        }
+
+        bool LoaderImage::loadAsset(const std::string& filename, const DataView& data, bool mipmaps)
         {
             graphics::ImageDataSTB image;
             if (!image.init(data))
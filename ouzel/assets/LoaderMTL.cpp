@@ -174,8 +174,8 @@ namespace ouzel
                         if (materialCount)
                         {
                             std::shared_ptr<graphics::Material> material = std::make_shared<graphics::Material>();
-                            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
-                            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
+                            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
+                            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
                             material->textures[0] = diffuseTexture;
                             material->textures[1] = ambientTexture;
                             material->diffuseColor = diffuseColor;
@@ -296,8 +296,8 @@ namespace ouzel
             if (materialCount)
             {
                 std::shared_ptr<graphics::Material> material = std::make_shared<graphics::Material>();
-                material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
-                material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
+                material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
+                material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
                 material->textures[0] = diffuseTexture;
                 material->textures[1] = ambientTexture;
                 material->diffuseColor = diffuseColor;
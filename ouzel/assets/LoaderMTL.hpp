@@ -15,6 +15,7 @@ namespace ouzel
             static const uint32_t TYPE = Loader::MATERIAL;
 
             LoaderMTL();
+            using Loader::loadAsset;
             virtual bool loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps = true) override;
         };
     } // namespace assets
@@ -15,6 +15,11 @@ namespace ouzel
         }
 
         bool LoaderTTF::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        {
+            return loadAsset(filename, DataView(data), mipmaps);
+        }
+
+        bool LoaderTTF::loadAsset(const std::string& filename, const DataView& data, bool mipmaps)
         {
             std::shared_ptr<TTFont> font = std::make_shared<TTFont>();
             if (!font->init(data, mipmaps))
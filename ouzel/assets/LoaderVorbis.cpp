@@ -4,6 +4,7 @@
 #include "LoaderVorbis.hpp"
 #include "Cache.hpp"
 #include "audio/SoundDataVorbis.hpp"
+#include "audio/SoundDataVorbisStreamed.hpp"
 
 namespace ouzel
 {
@@ -14,12 +15,32 @@ namespace ouzel
         {
         }
 
-        bool LoaderVorbis::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderVorbis::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
         {
-            std::shared_ptr<audio::SoundData> soundData = std::make_shared<audio::SoundDataVorbis>();
-            if (!soundData->init(data))
+            return loadAsset(filename, DataView(data), mipmaps);
+        }
+
+        bool LoaderVorbis::loadAsset(const std::string& filename, const DataView& data, bool)
+        {
+            const std::shared_ptr<audio::PCMCache>& pcmCache = cache->getPCMCache();
+            std::shared_ptr<audio::SoundData> soundData;
+
+            // long sounds like music are decoded from the file while playing, so only the file name is kept
+            if (pcmCache->getStreamThreshold() && data.size() > pcmCache->getStreamThreshold())
+            {
+                soundData = std::make_shared<audio::SoundDataVorbisStreamed>();
+                if (!soundData->init(filename))
+                {
+                    return false;
+                }
+            }
+            else
             {
-                return false;
+                soundData = std::make_shared<audio::SoundDataVorbis>(pcmCache);
+                if (!soundData->init(data))
+                {
+                    return false;
+                }
             }
 
             cache->setSoundData(filename, soundData);
@@ -16,6 +16,7 @@ namespace ouzel
 
             LoaderVorbis();
             virtual bool loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps = true) override;
+            virtual bool loadAsset(const std::string& filename, const DataView& data, bool mipmaps = true) override;
         };
     } // namespace assets
 } // namespace ouzel
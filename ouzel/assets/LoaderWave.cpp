@@ -14,7 +14,12 @@ namespace ouzel
         {
         }
 
-        bool LoaderWave::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool)
+        bool LoaderWave::loadAsset(const std::string& filename, const std::vector<uint8_t>& data, bool mipmaps)
+        {
+            return loadAsset(filename, DataView(data), mipmaps);
+        }
+
+        bool LoaderWave::loadAsset(const std::string& filename, const DataView& data, bool)
         {
             std::shared_ptr<audio::SoundData> soundData = std::make_shared<audio::SoundDataWave>();
             if (!soundData->init(data))
@@ -10,10 +10,10 @@
 #include "coreaudio/AudioDeviceCA.hpp"
 #include "dsound/AudioDeviceDS.hpp"
 #include "empty/AudioDeviceEmpty.hpp"
+#include "offline/AudioDeviceOffline.hpp"
 #include "openal/AudioDeviceAL.hpp"
 #include "opensl/AudioDeviceSL.hpp"
 #include "xaudio2/AudioDeviceXA2.hpp"
-#include "math/MathUtils.hpp"
 #include "utils/Log.hpp"
 
 namespace ouzel
@@ -27,6 +27,7 @@ namespace ouzel
             if (availableDrivers.empty())
             {
                 availableDrivers.insert(Audio::Driver::EMPTY);
+                availableDrivers.insert(Audio::Driver::OFFLINE);
 
 #if OUZEL_COMPILE_OPENAL
                 availableDrivers.insert(Audio::Driver::OPENAL);
@@ -94,6 +95,10 @@ namespace ouzel
                     device.reset(new AudioDeviceALSA());
                     break;
 #endif
+                case Driver::OFFLINE:
+                    Log(Log::Level::INFO) << "Using offline audio driver";
+                    device.reset(new AudioDeviceOffline());
+                    break;
                 case Driver::EMPTY:
                 default:
                     Log(Log::Level::INFO) << "Not using audio driver";
@@ -110,29 +115,77 @@ namespace ouzel
             }
         }
 
-        bool Audio::init(bool debugAudio)
+        bool Audio::init(bool debugAudio,
+                         uint32_t bufferSize,
+                         uint32_t sampleRate,
+                         uint16_t channels,
+                         bool adaptiveLatency)
         {
+            if (bufferSize)
+            {
+                if (bufferSize < 32 || bufferSize > 16384)
+                {
+                    Log(Log::Level::WARN) << "Invalid audio buffer size " << bufferSize << ", using " << device->bufferSize;
+                }
+                else
+                {
+                    device->bufferSize = bufferSize;
+                }
+            }
+
+            if (sampleRate)
+            {
+                if (sampleRate < 8000 || sampleRate > 192000)
+                {
+                    Log(Log::Level::WARN) << "Invalid audio sample rate " << sampleRate << ", using " << device->sampleRate;
+                }
+                else
+                {
+                    device->sampleRate = sampleRate;
+                }
+            }
+
+            if (channels)
+            {
+                if (channels > MAX_CHANNELS)
+                {
+                    Log(Log::Level::WARN) << "Invalid audio channel count " << channels << ", using " << device->channels;
+                }
+                else
+                {
+                    device->channels = channels;
+                }
+            }
+
+            if (adaptiveLatency && device->driver != Driver::ALSA)
+            {
+                Log(Log::Level::WARN) << "Adaptive audio latency is not supported by the audio driver";
+            }
+
+            device->adaptiveLatency = adaptiveLatency;
+
             device->init(debugAudio);
             return true;
         }
 
         bool Audio::update()
         {
-            std::vector<AudioDevice::RenderCommand> renderCommands;
+            RenderGraph* renderGraph = device->acquireRenderGraph();
 
             for (Listener* listener : listeners)
             {
-                renderCommands.push_back(listener->getRenderCommand());
+                listener->addRenderCommands(*renderGraph);
             }
 
-            device->setRenderCommands(renderCommands);
+            renderGraph->prepare(AudioDevice::MAX_RENDER_FRAMES, device->getChannels());
+            device->setRenderGraph(renderGraph);
 
             return true;
         }
 
-        void Audio::executeOnAudioThread(const std::function<void(void)>& func)
+        void Audio::executeOnAudioThread(SmallFunction func)
         {
-            device->executeOnAudioThread(func);
+            device->executeOnAudioThread(std::move(func));
         }
 
         void Audio::addListener(Listener* listener)
@@ -159,50 +212,5 @@ namespace ouzel
                 }
             }
         }
-
-        void Audio::resample(const std::vector<float>& src, uint32_t srcFrames,
-                             std::vector<float>& dst, uint32_t dstFrames,
-                             uint32_t channels)
-        {
-            if (dstFrames > 0) // do resampling only if destination is not empty
-            {
-                if (srcFrames == 0) // source is empty
-                {
-                    dst.resize(dstFrames * channels);
-
-                    std::fill(dst.begin(), dst.end(), 0.0f);
-                }
-                else
-                {
-                    float srcIncrement = static_cast<float>(srcFrames - 1) / static_cast<float>(dstFrames - 1);
-                    float srcPosition = 0.0f;
-
-                    dst.resize(dstFrames * channels);
-
-                    for (uint32_t frame = 0; frame < dstFrames - 1; ++frame)
-                    {
-                        uint32_t srcCurrentFrame = static_cast<uint32_t>(srcPosition);
-                        float frac = srcPosition - srcCurrentFrame;
-
-                        srcPosition += srcIncrement;
-                        uint32_t srcNextFrame = srcCurrentFrame + 1;
-
-                        for (uint32_t channel = 0; channel < channels; ++channel)
-                        {
-                            uint32_t srcCurrentPosition = srcCurrentFrame * channels + channel;
-                            uint32_t srcNextPosition = srcNextFrame * channels + channel;
-
-                            dst[frame * channels + channel] = ouzel::lerp(src[srcCurrentPosition], src[srcNextPosition], frac);
-                        }
-                    }
-
-                    // fill the last frame of the destination with the last frame of the source
-                    for (uint32_t channel = 0; channel < channels; ++channel)
-                    {
-                        dst[(dstFrames - 1) * channels + channel] = src[(srcFrames - 1) * channels + channel];
-                    }
-                }
-            }
-        }
     } // namespace audio
 } // namespace ouzel
@@ -10,6 +10,7 @@
 #include <vector>
 #include "math/Quaternion.hpp"
 #include "math/Vector3.hpp"
+#include "thread/SmallFunction.hpp"
 
 namespace ouzel
 {
@@ -28,6 +29,7 @@ namespace ouzel
             {
                 DEFAULT,
                 EMPTY,
+                OFFLINE,
                 OPENAL,
                 DIRECTSOUND,
                 XAUDIO2,
@@ -48,6 +50,8 @@ namespace ouzel
                 SIDE_RIGHT = 7
             };
 
+            static const uint16_t MAX_CHANNELS = 8;
+
             enum ChannelConfiguration
             {
                 MONO,
@@ -79,18 +83,19 @@ namespace ouzel
 
             bool update();
 
-            void executeOnAudioThread(const std::function<void(void)>& func);
+            void executeOnAudioThread(SmallFunction func);
 
             void addListener(Listener* listener);
             void removeListener(Listener* listener);
 
-            static void resample(const std::vector<float>& src, uint32_t srcFrames,
-                                 std::vector<float>& dst, uint32_t dstFrames,
-                                 uint32_t channels);
-
         protected:
             explicit Audio(Driver driver);
-            bool init(bool debugAudio);
+            // buffer size is in frames, zero values keep the defaults of the driver
+            bool init(bool debugAudio,
+                      uint32_t bufferSize = 0,
+                      uint32_t sampleRate = 0,
+                      uint16_t channels = 0,
+                      bool adaptiveLatency = false);
 
             std::unique_ptr<AudioDevice> device;
 
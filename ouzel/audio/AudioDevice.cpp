@@ -2,26 +2,48 @@
 // This file is part of the Ouzel engine.
 
 #include <algorithm>
+#include <chrono>
 #include "AudioDevice.hpp"
-#include "math/MathUtils.hpp"
-#include "thread/Lock.hpp"
+#include "Kernels.hpp"
+#include "core/Engine.hpp"
 
 namespace ouzel
 {
     namespace audio
     {
+        const uint32_t AudioDevice::MAX_RENDER_FRAMES;
+
+        // levels with fewer nodes are rendered on the audio thread
+        static const uint32_t MIN_PARALLEL_NODES = 16;
+        static const uint32_t NODES_PER_BATCH = 4;
+        static const uint32_t MAX_RENDER_WORKERS = 3;
+
         AudioDevice::AudioDevice(Audio::Driver aDriver):
-            driver(aDriver)
+            driver(aDriver),
+            executeQueue(1024),
+            renderFailed(false),
+            pendingRenderGraph(nullptr),
+            retiredRenderGraph(nullptr)
         {
-            buffers.resize(1000);
+            mixBuffer.resize(MAX_RENDER_FRAMES * Audio::MAX_CHANNELS);
         }
 
         AudioDevice::~AudioDevice()
         {
+            delete renderGraph;
+            delete pendingRenderGraph.load();
+            delete retiredRenderGraph.load();
         }
 
         bool AudioDevice::init(bool)
         {
+            // the render workers are separate from the job system, so that the audio thread never waits for or runs
+            // other jobs, they are used only if the job system has workers (the engine is multithreaded)
+            JobSystem* jobSystem = engine->getJobSystem();
+            uint32_t renderWorkerCount = jobSystem ? std::min(jobSystem->getWorkerCount(), MAX_RENDER_WORKERS) : 0;
+
+            if (renderWorkerCount > 0) renderWorkers.reset(new RenderWorkers(renderWorkerCount));
+
             return true;
         }
 
@@ -32,180 +54,214 @@ namespace ouzel
             return true;
         }
 
-        void AudioDevice::setRenderCommands(const std::vector<RenderCommand>& newRenderCommands)
+        RenderGraph* AudioDevice::acquireRenderGraph()
         {
-            Lock renderQueueLock(renderQueueMutex);
-
-            renderQueue = newRenderCommands;
-        }
+            if (RenderGraph* retired = retiredRenderGraph.exchange(nullptr, std::memory_order_acquire))
+            {
+                freeRenderGraphs.push_back(std::unique_ptr<RenderGraph>(retired));
+            }
 
-        bool AudioDevice::processRenderCommands(uint32_t frames, std::vector<float>& result)
-        {
-            std::vector<RenderCommand> renderCommands;
+            std::unique_ptr<RenderGraph> result;
 
+            if (freeRenderGraphs.empty())
             {
-                Lock renderQueueLock(renderQueueMutex);
-
-                renderCommands = renderQueue;
+                result.reset(new RenderGraph());
+            }
+            else
+            {
+                result = std::move(freeRenderGraphs.back());
+                freeRenderGraphs.pop_back();
             }
 
-            uint32_t buffer = currentBuffer++;
-            if (currentBuffer > buffers.size()) return true; // out of buffers
+            result->clear();
 
-            buffers[buffer].resize(frames * channels);
-            std::fill(buffers[buffer].begin(), buffers[buffer].end(), 0.0f);
+            return result.release();
+        }
 
-            for (const RenderCommand& renderCommand : renderCommands)
+        void AudioDevice::setRenderGraph(RenderGraph* newRenderGraph)
+        {
+            // the previous graph was not picked up by the audio thread, so it can be reused
+            if (RenderGraph* previous = pendingRenderGraph.exchange(newRenderGraph, std::memory_order_acq_rel))
             {
-                if (!processRenderCommand(renderCommand,
-                                          frames,
-                                          Vector3(), // listener position
-                                          Quaternion(), // listener rotation
-                                          1.0f, // pitch
-                                          1.0f, // gain
-                                          1.0f, // rolloff factor
-                                          buffers[buffer])) return false;
-
-                if (buffers[buffer].size() > buffers[buffer].size()) result.resize(buffers[buffer].size(), 0.0f);
-
-                for (uint32_t i = 0; i < buffers[buffer].size() && i < result.size(); ++i)
-                {
-                    // mix the sound into the buffer
-                    result[i] += buffers[buffer][i];
-                }
+                freeRenderGraphs.push_back(std::unique_ptr<RenderGraph>(previous));
             }
-
-            return true;
         }
 
-        bool AudioDevice::processRenderCommand(const RenderCommand& renderCommand,
-                                               uint32_t frames,
-                                               Vector3 listenerPosition,
-                                               Quaternion listenerRotation,
-                                               float pitch,
-                                               float gain,
-                                               float rolloffFactor,
-                                               std::vector<float>& result)
+        bool AudioDevice::processRenderGraph(uint32_t frames, float* result)
         {
-            uint32_t buffer = currentBuffer++;
-            if (currentBuffer > buffers.size()) return true; // out of buffers
+            std::fill(result, result + frames * channels, 0.0f);
+
+            if (!renderGraph) return true;
 
-            buffers[buffer].resize(frames * channels);
-            std::fill(buffers[buffer].begin(), buffers[buffer].end(), 0.0f);
+            const std::vector<RenderGraph::Node>& nodes = renderGraph->getNodes();
 
-            if (renderCommand.attributeCallback)
+            // nodes are stored in depth-first order, so the parent's attributes are always ready
+            for (uint32_t index = 0; index < nodes.size(); ++index)
             {
-                renderCommand.attributeCallback(listenerPosition,
-                                                listenerRotation,
-                                                pitch,
-                                                gain,
-                                                rolloffFactor);
+                const RenderGraph::Node& node = nodes[index];
+                RenderGraph::Attributes& attributes = renderGraph->getAttributes(index);
+
+                attributes = (node.parent == RenderGraph::NO_PARENT) ?
+                    RenderGraph::Attributes() : renderGraph->getAttributes(node.parent);
+
+                if (node.attributeCallback)
+                {
+                    node.attributeCallback(attributes.listenerPosition,
+                                           attributes.listenerRotation,
+                                           attributes.pitch,
+                                           attributes.gain,
+                                           attributes.rolloffFactor);
+                }
+
+                attributes.virtualized = false;
             }
 
-            for (const RenderCommand& command : renderCommand.renderCommands)
+            voiceManager.update(*renderGraph);
+
+            renderFailed = false;
+
+            // children are rendered before their parents, every node reads only its children's buffers
+            for (uint32_t depth = renderGraph->getLevelCount(); depth > 0; --depth)
             {
-                processRenderCommand(command,
-                                     frames,
-                                     listenerPosition,
-                                     listenerRotation,
-                                     pitch,
-                                     gain,
-                                     rolloffFactor,
-                                     buffers[buffer]);
-
-                if (buffers[buffer].size() > result.size()) result.resize(buffers[buffer].size());
-
-                for (uint32_t i = 0; i < buffers[buffer].size() && i < result.size(); ++i)
+                const uint32_t* levelNodes = renderGraph->getLevelNodes(depth - 1);
+                uint32_t levelSize = renderGraph->getLevelSize(depth - 1);
+
+                if (renderWorkers && levelSize >= MIN_PARALLEL_NODES)
+                {
+                    renderLevelNodes = levelNodes;
+                    renderFrames = frames;
+                    renderWorkers->run(levelSize, NODES_PER_BATCH, &AudioDevice::processLevelNodes, this);
+                }
+                else
                 {
-                    // mix the sound into the buffer
-                    result[i] += buffers[buffer][i];
+                    processNodes(levelNodes, 0, levelSize, frames);
                 }
             }
 
-            if (renderCommand.renderCallback)
+            if (renderFailed) return false;
+
+            for (uint32_t index = 0; index < nodes.size(); index = nodes[index].end)
             {
-                if (!renderCommand.renderCallback(frames,
-                                                  channels,
-                                                  sampleRate,
-                                                  listenerPosition,
-                                                  listenerRotation,
-                                                  pitch,
-                                                  gain,
-                                                  rolloffFactor,
-                                                  result)) return false;
+                mix(result, renderGraph->getBuffer(index), frames * channels);
             }
 
             return true;
         }
 
-        bool AudioDevice::getData(uint32_t frames, std::vector<uint8_t>& result)
+        void AudioDevice::processLevelNodes(void* context, uint32_t begin, uint32_t end)
         {
-            currentBuffer = 0;
-            uint32_t buffer = currentBuffer++;
-            if (currentBuffer > buffers.size()) return true; // out of buffers
-
-            buffers[buffer].resize(frames * channels);
-            std::fill(buffers[buffer].begin(), buffers[buffer].end(), 0.0f);
+            AudioDevice* audioDevice = static_cast<AudioDevice*>(context);
+            audioDevice->processNodes(audioDevice->renderLevelNodes, begin, end, audioDevice->renderFrames);
+        }
 
-            if (!processRenderCommands(frames, buffers[buffer])) return false;
+        void AudioDevice::processNodes(const uint32_t* levelNodes, uint32_t begin, uint32_t end, uint32_t frames)
+        {
+            const std::vector<RenderGraph::Node>& nodes = renderGraph->getNodes();
 
-            for (float& f : buffers[buffer])
+            for (uint32_t i = begin; i < end; ++i)
             {
-                f = clamp(f, -1.0f, 1.0f);
-            }
+                uint32_t index = levelNodes[i];
+                const RenderGraph::Node& node = nodes[index];
+                float* result = renderGraph->getBuffer(index);
 
-            switch (format)
-            {
-                case Audio::Format::SINT16:
+                std::fill(result, result + frames * channels, 0.0f);
+
+                const RenderGraph::Attributes& attributes = renderGraph->getAttributes(index);
+
+                if (attributes.virtualized)
                 {
-                    result.resize(frames * channels * sizeof(int16_t));
-                    int16_t* resultPtr = reinterpret_cast<int16_t*>(result.data());
+                    const RenderGraph::Voice& voice = renderGraph->getVoice(node.voice);
+                    if (voice.skipCallback) voice.skipCallback(frames, channels, sampleRate, attributes.pitch, result);
+                    continue;
+                }
 
-                    for (uint32_t i = 0; i < buffers[buffer].size(); ++i)
-                    {
-                        *resultPtr = static_cast<int16_t>(buffers[buffer][i] * 32767.0f);
-                        ++resultPtr;
-                    }
-                    break;
+                // children are always mixed in the same order, so the result does not depend on the scheduling
+                for (uint32_t child = index + 1; child < node.end; child = nodes[child].end)
+                {
+                    mix(result, renderGraph->getBuffer(child), frames * channels);
                 }
-                case Audio::Format::FLOAT32:
+
+                if (node.renderCallback)
                 {
-                    result.reserve(frames * channels * sizeof(float));
-                    result.assign(reinterpret_cast<uint8_t*>(buffers[buffer].data()),
-                                  reinterpret_cast<uint8_t*>(buffers[buffer].data()) + buffers[buffer].size() * sizeof(float));
-                    break;
+                    if (!node.renderCallback(frames,
+                                             channels,
+                                             sampleRate,
+                                             attributes.listenerPosition,
+                                             attributes.listenerRotation,
+                                             attributes.pitch,
+                                             attributes.gain,
+                                             attributes.rolloffFactor,
+                                             result))
+                        renderFailed = true;
                 }
             }
-
-            return true;
         }
 
-        void AudioDevice::executeOnAudioThread(const std::function<void(void)>& func)
+        bool AudioDevice::getData(uint32_t frames, std::vector<uint8_t>& result)
         {
-            Lock lock(executeMutex);
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-            executeQueue.push(func);
-        }
+            // switch to the latest graph once the game thread has reclaimed the previous one
+            if (!retiredRenderGraph.load(std::memory_order_acquire))
+            {
+                if (RenderGraph* newRenderGraph = pendingRenderGraph.exchange(nullptr, std::memory_order_acq_rel))
+                {
+                    retiredRenderGraph.store(renderGraph, std::memory_order_release);
+                    renderGraph = newRenderGraph;
+                }
+            }
 
-        void AudioDevice::executeAll()
-        {
-            std::function<void(void)> func;
+            uint32_t sampleSize = (format == Audio::Format::SINT16) ? sizeof(int16_t) : sizeof(float);
+            result.resize(frames * channels * sampleSize);
 
-            for (;;)
+            for (uint32_t offset = 0; offset < frames;)
             {
-                {
-                    Lock lock(executeMutex);
-                    if (executeQueue.empty()) break;
+                uint32_t chunkFrames = std::min(frames - offset, MAX_RENDER_FRAMES);
+                if (renderGraph) chunkFrames = std::min(chunkFrames, renderGraph->getMaxFrames());
 
-                    func = std::move(executeQueue.front());
-                    executeQueue.pop();
-                }
+                uint32_t samples = chunkFrames * channels;
 
-                if (func)
+                if (!processRenderGraph(chunkFrames, mixBuffer.data())) return false;
+
+                profiler.addVoices(voiceManager.getRealVoiceCount(), voiceManager.getVirtualVoiceCount());
+
+                clampSamples(mixBuffer.data(), samples);
+
+                switch (format)
                 {
-                    func();
+                    case Audio::Format::SINT16:
+                    {
+                        convertToS16(mixBuffer.data(), reinterpret_cast<int16_t*>(result.data()) + offset * channels, samples);
+                        break;
+                    }
+                    case Audio::Format::FLOAT32:
+                    {
+                        std::copy(mixBuffer.begin(), mixBuffer.begin() + samples,
+                                  reinterpret_cast<float*>(result.data()) + offset * channels);
+                        break;
+                    }
                 }
+
+                offset += chunkFrames;
             }
+
+            std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+            profiler.addCallback(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count()),
+                                 frames, sampleRate);
+
+            return true;
+        }
+
+        void AudioDevice::executeOnAudioThread(SmallFunction func)
+        {
+            executeQueue.push(std::move(func));
+        }
+
+        void AudioDevice::executeAll()
+        {
+            executeQueue.drain([](SmallFunction& func) {
+                if (func) func();
+            });
         }
     } // namespace audio
 } // namespace ouzel
@@ -3,18 +3,20 @@
 
 #pragma once
 
-#include <queue>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include "audio/Audio.hpp"
-#include "thread/Mutex.hpp"
+#include "audio/AudioProfiler.hpp"
+#include "audio/RenderGraph.hpp"
+#include "audio/RenderWorkers.hpp"
+#include "audio/VoiceManager.hpp"
+#include "thread/MPSCQueue.hpp"
 
 namespace ouzel
 {
     namespace audio
     {
-        class ListenerResource;
-        class MixerResource;
-
         class AudioDevice
         {
             friend Audio;
@@ -32,29 +34,20 @@ namespace ouzel
             inline uint16_t getAPIMajorVersion() const { return apiMajorVersion; }
             inline uint16_t getAPIMinorVersion() const { return apiMinorVersion; }
 
-            void executeOnAudioThread(const std::function<void(void)>& func);
-
-            struct RenderCommand
-            {
-                std::function<void(Vector3& listenerPosition,
-                                   Quaternion& listenerRotation,
-                                   float& pitch,
-                                   float& gain,
-                                   float& rolloffFactor)> attributeCallback;
-
-                std::function<bool(uint32_t frames,
-                                   uint16_t channels,
-                                   uint32_t sampleRate,
-                                   const Vector3& listenerPosition,
-                                   const Quaternion& listenerRotation,
-                                   float pitch,
-                                   float gain,
-                                   float rolloffFactor,
-                                   std::vector<float>& result)> renderCallback;
-                std::vector<RenderCommand> renderCommands;
-            };
-
-            void setRenderCommands(const std::vector<RenderCommand>& newRenderCommands);
+            void executeOnAudioThread(SmallFunction func);
+
+            inline uint16_t getChannels() const { return channels; }
+            inline uint32_t getSampleRate() const { return sampleRate; }
+            inline uint32_t getBufferSize() const { return bufferSize; }
+
+            inline VoiceManager& getVoiceManager() { return voiceManager; }
+            inline AudioProfiler& getProfiler() { return profiler; }
+
+            // called from the game thread, the graph is owned by the device until it is returned by acquireRenderGraph
+            RenderGraph* acquireRenderGraph();
+            void setRenderGraph(RenderGraph* newRenderGraph);
+
+            static const uint32_t MAX_RENDER_FRAMES = 2048;
 
         protected:
             AudioDevice(Audio::Driver aDriver);
@@ -62,16 +55,9 @@ namespace ouzel
 
             void executeAll();
             bool getData(uint32_t frames, std::vector<uint8_t>& result);
-            bool processRenderCommands(uint32_t frames,
-                                       std::vector<float>& result);
-            bool processRenderCommand(const RenderCommand& renderCommand,
-                                      uint32_t frames,
-                                      Vector3 listenerPosition,
-                                      Quaternion listenerRotation,
-                                      float pitch,
-                                      float gain,
-                                      float rolloffFactor,
-                                      std::vector<float>& result);
+            bool processRenderGraph(uint32_t frames, float* result);
+            static void processLevelNodes(void* context, uint32_t begin, uint32_t end);
+            void processNodes(const uint32_t* levelNodes, uint32_t begin, uint32_t end, uint32_t frames);
 
             Audio::Driver driver;
 
@@ -79,18 +65,28 @@ namespace ouzel
             uint16_t apiMinorVersion = 0;
 
             Audio::Format format = Audio::Format::SINT16;
-            const uint32_t bufferSize = 2 * 4096;
-            const uint32_t sampleRate = 44100;
-            const uint16_t channels = 2;
-
-            std::vector<std::vector<float>> buffers;
-            uint32_t currentBuffer = 0;
-
-            std::queue<std::function<void(void)>> executeQueue;
-            Mutex executeMutex;
-
-            std::vector<RenderCommand> renderQueue;
-            Mutex renderQueueMutex;
+            // set by Audio before init, the driver can change them to values that the device supports
+            uint32_t bufferSize = 2048; // in frames
+            uint32_t sampleRate = 44100;
+            uint16_t channels = 2;
+            bool adaptiveLatency = false;
+
+            MPSCQueue<SmallFunction> executeQueue;
+
+            std::vector<float> mixBuffer;
+            std::atomic<bool> renderFailed;
+            VoiceManager voiceManager;
+            AudioProfiler profiler;
+
+            RenderGraph* renderGraph = nullptr; // used by the audio thread
+            std::atomic<RenderGraph*> pendingRenderGraph; // set by the game thread
+            std::atomic<RenderGraph*> retiredRenderGraph; // no longer used by the audio thread
+            std::vector<std::unique_ptr<RenderGraph>> freeRenderGraphs;
+
+            // the level that the render workers are rendering
+            const uint32_t* renderLevelNodes = nullptr;
+            uint32_t renderFrames = 0;
+            std::unique_ptr<RenderWorkers> renderWorkers;
         };
     } // namespace audio
 } // namespace ouzel
@@ -0,0 +1,141 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "AudioProfiler.hpp"
+#include "utils/Log.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        const uint32_t AudioProfiler::HISTOGRAM_SIZE;
+
+        AudioProfiler::AudioProfiler()
+        {
+            reset();
+        }
+
+        void AudioProfiler::addCallback(uint64_t renderTime, uint32_t frames, uint32_t sampleRate)
+        {
+            if (frames == 0 || sampleRate == 0) return;
+
+            uint64_t periodTime = static_cast<uint64_t>(frames) * 1000000 / sampleRate;
+            float utilization = static_cast<float>(renderTime) * static_cast<float>(sampleRate) /
+                (static_cast<float>(frames) * 1000000.0f);
+
+            // only the audio thread writes the values, so they don't have to be updated atomically
+            callbackCount.store(callbackCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            renderedFrames.store(renderedFrames.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+
+            lastRenderTime.store(renderTime, std::memory_order_relaxed);
+            if (renderTime > maxRenderTime.load(std::memory_order_relaxed)) maxRenderTime.store(renderTime, std::memory_order_relaxed);
+            totalRenderTime.store(totalRenderTime.load(std::memory_order_relaxed) + renderTime, std::memory_order_relaxed);
+            totalPeriodTime.store(totalPeriodTime.load(std::memory_order_relaxed) + periodTime, std::memory_order_relaxed);
+
+            uint32_t bucket = 0;
+            while (bucket < HISTOGRAM_SIZE - 1 && renderTime >= getBucketLimit(bucket)) ++bucket;
+            histogram[bucket].store(histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            lastUtilization.store(utilization, std::memory_order_relaxed);
+            if (utilization > maxUtilization.load(std::memory_order_relaxed)) maxUtilization.store(utilization, std::memory_order_relaxed);
+            if (utilization > 1.0f) deadlineMisses.store(deadlineMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void AudioProfiler::addVoices(uint32_t realVoices, uint32_t virtualVoices)
+        {
+            if (realVoices > peakRealVoices.load(std::memory_order_relaxed)) peakRealVoices.store(realVoices, std::memory_order_relaxed);
+            if (virtualVoices > peakVirtualVoices.load(std::memory_order_relaxed)) peakVirtualVoices.store(virtualVoices, std::memory_order_relaxed);
+        }
+
+        void AudioProfiler::addUnderrun()
+        {
+            underrunCount.store(underrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            addXrun();
+        }
+
+        void AudioProfiler::addXrun()
+        {
+            xrunCount.store(xrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        AudioProfiler::Stats AudioProfiler::getStats() const
+        {
+            Stats stats;
+
+            stats.callbackCount = callbackCount;
+            stats.renderedFrames = renderedFrames;
+
+            stats.lastRenderTime = lastRenderTime;
+            stats.maxRenderTime = maxRenderTime;
+            stats.totalRenderTime = totalRenderTime;
+            for (uint32_t bucket = 0; bucket < HISTOGRAM_SIZE; ++bucket) stats.histogram[bucket] = histogram[bucket];
+
+            uint64_t periodTime = totalPeriodTime;
+            stats.lastUtilization = lastUtilization;
+            stats.maxUtilization = maxUtilization;
+            stats.averageUtilization = periodTime ? static_cast<float>(stats.totalRenderTime) / static_cast<float>(periodTime) : 0.0f;
+            stats.deadlineMisses = deadlineMisses;
+
+            stats.underrunCount = underrunCount;
+            stats.xrunCount = xrunCount;
+
+            stats.peakRealVoices = peakRealVoices;
+            stats.peakVirtualVoices = peakVirtualVoices;
+
+            return stats;
+        }
+
+        void AudioProfiler::reset()
+        {
+            callbackCount = 0;
+            renderedFrames = 0;
+
+            lastRenderTime = 0;
+            maxRenderTime = 0;
+            totalRenderTime = 0;
+            totalPeriodTime = 0;
+            for (std::atomic<uint64_t>& bucket : histogram) bucket = 0;
+
+            lastUtilization = 0.0f;
+            maxUtilization = 0.0f;
+            deadlineMisses = 0;
+
+            underrunCount = 0;
+            xrunCount = 0;
+
+            peakRealVoices = 0;
+            peakVirtualVoices = 0;
+        }
+
+        void AudioProfiler::log() const
+        {
+            Stats stats = getStats();
+
+            Log(Log::Level::INFO) << "Audio callbacks: " << stats.callbackCount <<
+                ", frames: " << stats.renderedFrames <<
+                ", render time (us) last: " << stats.lastRenderTime <<
+                ", max: " << stats.maxRenderTime <<
+                ", average: " << (stats.callbackCount ? stats.totalRenderTime / stats.callbackCount : 0);
+
+            Log(Log::Level::INFO) << "Audio utilization last: " << stats.lastUtilization <<
+                ", max: " << stats.maxUtilization <<
+                ", average: " << stats.averageUtilization <<
+                ", deadline misses: " << stats.deadlineMisses <<
+                ", underruns: " << stats.underrunCount <<
+                ", xruns: " << stats.xrunCount <<
+                ", peak voices real: " << stats.peakRealVoices <<
+                ", virtual: " << stats.peakVirtualVoices;
+
+            Log log(Log::Level::INFO);
+            log << "Audio render time histogram (us):";
+
+            for (uint32_t bucket = 0; bucket < HISTOGRAM_SIZE; ++bucket)
+            {
+                if (bucket < HISTOGRAM_SIZE - 1)
+                    log << " <" << getBucketLimit(bucket) << ": " << stats.histogram[bucket];
+                else
+                    log << " >=" << getBucketLimit(bucket - 1) << ": " << stats.histogram[bucket];
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,86 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Statistics of the audio callbacks. The audio thread records them without locking and the game thread can
+        // read or reset them at any time, so a snapshot taken while a callback is recorded can be slightly inconsistent.
+        class AudioProfiler final
+        {
+        public:
+            // bucket i counts the callbacks that took less than 32 << i microseconds, the last bucket counts the rest
+            static const uint32_t HISTOGRAM_SIZE = 12;
+
+            struct Stats
+            {
+                uint64_t callbackCount = 0;
+                uint64_t renderedFrames = 0;
+
+                // in microseconds
+                uint64_t lastRenderTime = 0;
+                uint64_t maxRenderTime = 0;
+                uint64_t totalRenderTime = 0;
+                uint64_t histogram[HISTOGRAM_SIZE] = {};
+
+                // render time divided by the duration of the rendered frames
+                float lastUtilization = 0.0f;
+                float maxUtilization = 0.0f;
+                float averageUtilization = 0.0f;
+                uint64_t deadlineMisses = 0; // callbacks with utilization above 1
+
+                uint64_t underrunCount = 0; // the device ran out of data
+                uint64_t xrunCount = 0; // all the discontinuities the device recovered from, including underruns
+
+                uint32_t peakRealVoices = 0;
+                uint32_t peakVirtualVoices = 0;
+            };
+
+            AudioProfiler();
+
+            AudioProfiler(const AudioProfiler&) = delete;
+            AudioProfiler& operator=(const AudioProfiler&) = delete;
+
+            AudioProfiler(AudioProfiler&&) = delete;
+            AudioProfiler& operator=(AudioProfiler&&) = delete;
+
+            static inline uint64_t getBucketLimit(uint32_t bucket) { return 32ULL << bucket; }
+
+            // called on the audio thread
+            void addCallback(uint64_t renderTime, uint32_t frames, uint32_t sampleRate);
+            void addVoices(uint32_t realVoices, uint32_t virtualVoices);
+            void addUnderrun();
+            void addXrun();
+
+            Stats getStats() const;
+            void reset();
+            void log() const;
+
+        private:
+            std::atomic<uint64_t> callbackCount;
+            std::atomic<uint64_t> renderedFrames;
+
+            std::atomic<uint64_t> lastRenderTime;
+            std::atomic<uint64_t> maxRenderTime;
+            std::atomic<uint64_t> totalRenderTime;
+            std::atomic<uint64_t> totalPeriodTime;
+            std::atomic<uint64_t> histogram[HISTOGRAM_SIZE];
+
+            std::atomic<float> lastUtilization;
+            std::atomic<float> maxUtilization;
+            std::atomic<uint64_t> deadlineMisses;
+
+            std::atomic<uint64_t> underrunCount;
+            std::atomic<uint64_t> xrunCount;
+
+            std::atomic<uint32_t> peakRealVoices;
+            std::atomic<uint32_t> peakVirtualVoices;
+        };
+    } // namespace audio
+} // namespace ouzel
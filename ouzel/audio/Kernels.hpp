@@ -0,0 +1,175 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include "core/Setup.h"
+#include "math/SIMD.hpp"
+#if OUZEL_SUPPORTS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // destination[i] += source[i]
+        template<class T>
+        inline uint32_t mixKernel(float* destination, const float* source, uint32_t begin, uint32_t end)
+        {
+            uint32_t i = begin;
+
+            for (; i + T::SIZE <= end; i += T::SIZE)
+            {
+                T::store(destination + i, T::add(T::load(destination + i), T::load(source + i)));
+            }
+
+            return i;
+        }
+
+        inline void mix(float* destination, const float* source, uint32_t count)
+        {
+            uint32_t i = mixKernel<SIMDVector>(destination, source, 0, count);
+            mixKernel<SIMDScalar>(destination, source, i, count);
+        }
+
+        // limits the samples to [-1, 1]
+        template<class T>
+        inline uint32_t clampKernel(float* samples, uint32_t begin, uint32_t end)
+        {
+            const typename T::Vector minimum = T::set(-1.0f);
+            const typename T::Vector maximum = T::set(1.0f);
+
+            uint32_t i = begin;
+
+            for (; i + T::SIZE <= end; i += T::SIZE)
+            {
+                T::store(samples + i, T::min(T::max(T::load(samples + i), minimum), maximum));
+            }
+
+            return i;
+        }
+
+        inline void clampSamples(float* samples, uint32_t count)
+        {
+            uint32_t i = clampKernel<SIMDVector>(samples, 0, count);
+            clampKernel<SIMDScalar>(samples, i, count);
+        }
+
+        // Multiplies interleaved samples by per channel gains that change linearly from startGains to endGains
+        // over the frames. Four frames are processed per iteration, so the gain pattern is a multiple of the vector size.
+        template<class T>
+        inline uint32_t gainRampKernel(float* samples, uint32_t frames, uint16_t channels,
+                                       const float* startGains, const float* endGains, uint32_t begin)
+        {
+            const uint32_t MAX_PATTERN_SIZE = 4 * 8;
+            uint32_t patternSize = 4 * channels;
+            if (patternSize > MAX_PATTERN_SIZE || frames == 0) return begin;
+
+            float gains[MAX_PATTERN_SIZE];
+            float steps[MAX_PATTERN_SIZE];
+
+            float frameStep = 1.0f / static_cast<float>(frames);
+
+            for (uint32_t k = 0; k < patternSize; ++k)
+            {
+                uint32_t channel = k % channels;
+                float step = (endGains[channel] - startGains[channel]) * frameStep;
+                gains[k] = startGains[channel] + step * static_cast<float>(begin / channels + k / channels);
+                steps[k] = step * 4.0f;
+            }
+
+            uint32_t end = frames * channels;
+            uint32_t i = begin;
+
+            for (; i + patternSize <= end; i += patternSize)
+            {
+                for (uint32_t k = 0; k < patternSize; k += T::SIZE)
+                {
+                    typename T::Vector gain = T::load(gains + k);
+                    T::store(samples + i + k, T::mul(T::load(samples + i + k), gain));
+                    T::store(gains + k, T::add(gain, T::load(steps + k)));
+                }
+            }
+
+            return i;
+        }
+
+        inline void applyGainRamp(float* samples, uint32_t frames, uint16_t channels,
+                                  const float* startGains, const float* endGains)
+        {
+            uint32_t i = gainRampKernel<SIMDVector>(samples, frames, channels, startGains, endGains, 0);
+
+            // remaining frames
+            for (uint32_t frame = i / channels; frame < frames; ++frame)
+            {
+                float t = static_cast<float>(frame) / static_cast<float>(frames);
+
+                for (uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    samples[frame * channels + channel] *= startGains[channel] + (endGains[channel] - startGains[channel]) * t;
+                }
+            }
+        }
+
+        // the samples have to be clamped to [-1, 1]
+        inline void convertToS16(const float* source, int16_t* destination, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if OUZEL_SUPPORTS_SSE2
+            const __m128 scale = _mm_set1_ps(32767.0f);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i), scale));
+                __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 4), scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packs_epi32(a, b));
+            }
+#elif OUZEL_SUPPORTS_NEON64
+            const float32x4_t scale = vdupq_n_f32(32767.0f);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                int32x4_t a = vcvtq_s32_f32(vmulq_f32(vld1q_f32(source + i), scale));
+                int32x4_t b = vcvtq_s32_f32(vmulq_f32(vld1q_f32(source + i + 4), scale));
+                vst1q_s16(destination + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                destination[i] = static_cast<int16_t>(source[i] * 32767.0f);
+            }
+        }
+
+        // duplicates every sample of a mono signal to two channels
+        inline void convertMonoToStereo(const float* source, float* destination, uint32_t frames)
+        {
+            uint32_t frame = 0;
+
+#if OUZEL_SUPPORTS_SSE
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                __m128 v = _mm_loadu_ps(source + frame);
+                _mm_storeu_ps(destination + frame * 2, _mm_unpacklo_ps(v, v));
+                _mm_storeu_ps(destination + frame * 2 + 4, _mm_unpackhi_ps(v, v));
+            }
+#elif OUZEL_SUPPORTS_NEON64
+            for (; frame + 4 <= frames; frame += 4)
+            {
+                float32x4_t v = vld1q_f32(source + frame);
+                vst1q_f32(destination + frame * 2, vzip1q_f32(v, v));
+                vst1q_f32(destination + frame * 2 + 4, vzip2q_f32(v, v));
+            }
+#endif
+
+            for (; frame < frames; ++frame)
+            {
+                destination[frame * 2] = source[frame];
+                destination[frame * 2 + 1] = source[frame];
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
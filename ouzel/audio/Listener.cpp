@@ -27,15 +27,8 @@ namespace ouzel
             transformDirty = true;
         }
 
-        AudioDevice::RenderCommand Listener::getRenderCommand()
+        void Listener::addRenderCommands(RenderGraph& renderGraph)
         {
-            AudioDevice::RenderCommand renderCommand;
-
-            for (SoundInput* input : inputs)
-            {
-                input->addRenderCommands(renderCommand.renderCommands);
-            }
-
             if (transformDirty && actor)
             {
                 position = actor->getWorldPosition();
@@ -45,16 +38,21 @@ namespace ouzel
                 transformDirty = false;
             }
 
-            renderCommand.attributeCallback = std::bind(&Listener::setAttributes,
-                                                        std::placeholders::_1,
-                                                        std::placeholders::_2,
-                                                        std::placeholders::_3,
-                                                        std::placeholders::_4,
-                                                        std::placeholders::_5,
-                                                        position,
-                                                        rotation);
+            uint32_t node = renderGraph.beginNode(std::bind(&Listener::setAttributes,
+                                                            std::placeholders::_1,
+                                                            std::placeholders::_2,
+                                                            std::placeholders::_3,
+                                                            std::placeholders::_4,
+                                                            std::placeholders::_5,
+                                                            position,
+                                                            rotation));
+
+            for (SoundInput* input : inputs)
+            {
+                input->addRenderCommands(renderGraph);
+            }
 
-            return renderCommand;
+            renderGraph.endNode(node);
         }
 
         void Listener::setAttributes(Vector3& listenerPosition,
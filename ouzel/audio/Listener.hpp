@@ -4,7 +4,7 @@
 #pragma once
 
 #include <cfloat>
-#include "audio/AudioDevice.hpp"
+#include "audio/RenderGraph.hpp"
 #include "audio/SoundOutput.hpp"
 #include "scene/Component.hpp"
 #include "core/UpdateCallback.hpp"
@@ -24,7 +24,7 @@ namespace ouzel
             Listener();
             virtual ~Listener();
 
-            AudioDevice::RenderCommand getRenderCommand();
+            void addRenderCommands(RenderGraph& renderGraph);
 
         protected:
             virtual void updateTransform() override;
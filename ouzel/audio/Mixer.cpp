@@ -18,26 +18,24 @@ namespace ouzel
         {
         }
 
-        void Mixer::addRenderCommands(std::vector<AudioDevice::RenderCommand>& renderCommands)
+        void Mixer::addRenderCommands(RenderGraph& renderGraph)
         {
-            AudioDevice::RenderCommand renderCommand;
+            uint32_t node = renderGraph.beginNode(std::bind(&Mixer::setAttributes,
+                                                            std::placeholders::_1,
+                                                            std::placeholders::_2,
+                                                            std::placeholders::_3,
+                                                            std::placeholders::_4,
+                                                            std::placeholders::_5,
+                                                            pitch,
+                                                            gain,
+                                                            rolloffScale));
 
             for (SoundInput* input : inputs)
             {
-                input->addRenderCommands(renderCommand.renderCommands);
+                input->addRenderCommands(renderGraph);
             }
 
-            renderCommand.attributeCallback = std::bind(&Mixer::setAttributes,
-                                                        std::placeholders::_1,
-                                                        std::placeholders::_2,
-                                                        std::placeholders::_3,
-                                                        std::placeholders::_4,
-                                                        std::placeholders::_5,
-                                                        pitch,
-                                                        gain,
-                                                        rolloffScale);
-
-            renderCommands.push_back(renderCommand);
+            renderGraph.endNode(node);
         }
 
         void Mixer::setAttributes(Vector3&,
@@ -31,7 +31,7 @@ namespace ouzel
             inline float getRolloffScale() const { return rolloffScale; }
             inline void setRolloffScale(float newRolloffScale) { rolloffScale = newRolloffScale; }
 
-            virtual void addRenderCommands(std::vector<AudioDevice::RenderCommand>& renderCommands) override;
+            virtual void addRenderCommands(RenderGraph& renderGraph) override;
 
         protected:
             static void setAttributes(Vector3& listenerPosition,
@@ -0,0 +1,80 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "PCMCache.hpp"
+#include "thread/Lock.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        PCMCache::PCMCache()
+        {
+        }
+
+        size_t PCMCache::getBudget() const
+        {
+            Lock lock(bufferMutex);
+            return budget;
+        }
+
+        void PCMCache::setBudget(size_t newBudget)
+        {
+            Lock lock(bufferMutex);
+            budget = newBudget;
+            evict();
+        }
+
+        size_t PCMCache::getSize() const
+        {
+            Lock lock(bufferMutex);
+            return size;
+        }
+
+        void PCMCache::insert(const std::shared_ptr<const Buffer>& buffer)
+        {
+            Lock lock(bufferMutex);
+
+            if (bufferIterators.find(buffer.get()) != bufferIterators.end()) return;
+
+            buffers.push_front(buffer);
+            bufferIterators[buffer.get()] = buffers.begin();
+            size += buffer->getSize();
+
+            evict();
+        }
+
+        bool PCMCache::touch(const std::shared_ptr<const Buffer>& buffer)
+        {
+            Lock lock(bufferMutex);
+
+            auto i = bufferIterators.find(buffer.get());
+            if (i == bufferIterators.end()) return false;
+
+            buffers.splice(buffers.begin(), buffers, i->second);
+
+            return true;
+        }
+
+        void PCMCache::clear()
+        {
+            Lock lock(bufferMutex);
+
+            buffers.clear();
+            bufferIterators.clear();
+            size = 0;
+        }
+
+        void PCMCache::evict()
+        {
+            // the most recently used buffer is kept even if it alone exceeds the budget
+            while (size > budget && buffers.size() > 1)
+            {
+                const std::shared_ptr<const Buffer>& buffer = buffers.back();
+                size -= buffer->getSize();
+                bufferIterators.erase(buffer.get());
+                buffers.pop_back();
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
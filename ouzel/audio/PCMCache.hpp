@@ -0,0 +1,84 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "audio/Audio.hpp"
+#include "thread/Mutex.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Shared pool of decoded sounds with a memory budget. When the budget is exceeded, the least recently played
+        // buffers are dropped from the pool. Streams keep their buffer alive, so a buffer is freed only after the
+        // last stream that plays it is gone.
+        class PCMCache final
+        {
+        public:
+            struct Buffer
+            {
+                Audio::Format format = Audio::Format::FLOAT32;
+                uint16_t channels = 0;
+                uint32_t frames = 0;
+                std::vector<float> floatSamples;
+                std::vector<int16_t> intSamples;
+
+                inline size_t getSize() const
+                {
+                    return floatSamples.size() * sizeof(float) + intSamples.size() * sizeof(int16_t);
+                }
+            };
+
+            PCMCache();
+
+            PCMCache(const PCMCache&) = delete;
+            PCMCache& operator=(const PCMCache&) = delete;
+
+            PCMCache(PCMCache&&) = delete;
+            PCMCache& operator=(PCMCache&&) = delete;
+
+            // sounds whose decoded size is not greater than the threshold are decoded when loaded, 0 disables decoding
+            inline size_t getDecodeThreshold() const { return decodeThreshold; }
+            inline void setDecodeThreshold(size_t newDecodeThreshold) { decodeThreshold = newDecodeThreshold; }
+
+            // Vorbis files that are larger than the threshold are decoded from the file while playing instead of being
+            // kept in memory, 0 disables streaming
+            inline size_t getStreamThreshold() const { return streamThreshold; }
+            inline void setStreamThreshold(size_t newStreamThreshold) { streamThreshold = newStreamThreshold; }
+
+            inline Audio::Format getFormat() const { return format; }
+            inline void setFormat(Audio::Format newFormat) { format = newFormat; }
+
+            size_t getBudget() const;
+            void setBudget(size_t newBudget);
+
+            // size of the buffers owned by the pool
+            size_t getSize() const;
+
+            void insert(const std::shared_ptr<const Buffer>& buffer);
+            // marks the buffer as recently used, returns false if the buffer was evicted
+            bool touch(const std::shared_ptr<const Buffer>& buffer);
+
+            void clear();
+
+        private:
+            void evict();
+
+            size_t decodeThreshold = 256 * 1024;
+            size_t streamThreshold = 1024 * 1024;
+            Audio::Format format = Audio::Format::FLOAT32;
+
+            mutable Mutex bufferMutex;
+            size_t budget = 16 * 1024 * 1024;
+            size_t size = 0;
+            std::list<std::shared_ptr<const Buffer>> buffers; // the most recently used first
+            std::unordered_map<const Buffer*, std::list<std::shared_ptr<const Buffer>>::iterator> bufferIterators;
+        };
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,86 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "RenderGraph.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static const uint32_t CACHE_LINE_FLOATS = 64 / sizeof(float);
+
+        const uint32_t RenderGraph::NO_PARENT;
+        const uint32_t RenderGraph::NO_VOICE;
+
+        void RenderGraph::clear()
+        {
+            nodes.clear();
+            voices.clear();
+            openNodes.clear();
+            levels = 0;
+        }
+
+        uint32_t RenderGraph::beginNode(const AttributeCallback& attributeCallback,
+                                        const RenderCallback& renderCallback)
+        {
+            uint32_t index = static_cast<uint32_t>(nodes.size());
+
+            nodes.push_back(Node());
+            Node& node = nodes.back();
+            node.attributeCallback = attributeCallback;
+            node.renderCallback = renderCallback;
+            node.end = index + 1;
+            node.depth = static_cast<uint32_t>(openNodes.size());
+            node.parent = openNodes.empty() ? NO_PARENT : openNodes.back();
+            node.voice = NO_VOICE;
+
+            openNodes.push_back(index);
+
+            if (openNodes.size() > levels) levels = static_cast<uint32_t>(openNodes.size());
+
+            return index;
+        }
+
+        void RenderGraph::endNode(uint32_t node)
+        {
+            nodes[node].end = static_cast<uint32_t>(nodes.size());
+            openNodes.pop_back();
+        }
+
+        void RenderGraph::setVoice(uint32_t node, const Voice& voice)
+        {
+            nodes[node].voice = static_cast<uint32_t>(voices.size());
+            voices.push_back(voice);
+        }
+
+        void RenderGraph::prepare(uint32_t newMaxFrames, uint16_t newChannels)
+        {
+            maxFrames = newMaxFrames;
+
+            // every buffer starts on a cache line
+            bufferStride = (maxFrames * newChannels + CACHE_LINE_FLOATS - 1) & ~(CACHE_LINE_FLOATS - 1);
+
+            size_t size = nodes.size() * bufferStride + CACHE_LINE_FLOATS;
+            if (buffers.size() < size) buffers.resize(size);
+
+            uintptr_t address = reinterpret_cast<uintptr_t>(buffers.data());
+            uintptr_t alignedAddress = (address + 63) & ~static_cast<uintptr_t>(63);
+            alignedBuffers = reinterpret_cast<float*>(alignedAddress);
+
+            attributes.resize(nodes.size());
+
+            // counting sort of the nodes by depth, the nodes of every level stay in graph order
+            levelOffsets.assign(levels + 1, 0);
+            for (const Node& node : nodes) ++levelOffsets[node.depth + 1];
+            for (uint32_t depth = 0; depth < levels; ++depth) levelOffsets[depth + 1] += levelOffsets[depth];
+
+            levelNodes.resize(nodes.size());
+            std::vector<uint32_t> positions(levelOffsets.begin(), levelOffsets.end() - 1);
+
+            for (uint32_t index = 0; index < nodes.size(); ++index)
+            {
+                levelNodes[positions[nodes[index].depth]++] = index;
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,128 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "math/Quaternion.hpp"
+#include "math/Vector3.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Flattened tree of render commands. It is built on the game thread and is not modified while the
+        // audio thread renders it. Every node has its own buffer, so the nodes of the same depth can be rendered
+        // in parallel, the buffers are allocated up front so rendering does not allocate.
+        class RenderGraph final
+        {
+        public:
+            typedef std::function<void(Vector3& listenerPosition,
+                                        Quaternion& listenerRotation,
+                                        float& pitch,
+                                        float& gain,
+                                        float& rolloffFactor)> AttributeCallback;
+
+            typedef std::function<bool(uint32_t frames,
+                                       uint16_t channels,
+                                       uint32_t sampleRate,
+                                       const Vector3& listenerPosition,
+                                       const Quaternion& listenerRotation,
+                                       float pitch,
+                                       float gain,
+                                       float rolloffFactor,
+                                       float* result)> RenderCallback;
+
+            // advances a virtual voice without rendering it, a voice that was audible in the previous block renders
+            // a fade-out to the zeroed result instead
+            typedef std::function<void(uint32_t frames,
+                                       uint16_t channels,
+                                       uint32_t sampleRate,
+                                       float pitch,
+                                       float* result)> SkipCallback;
+
+            static const uint32_t NO_PARENT = 0xFFFFFFFF;
+            static const uint32_t NO_VOICE = 0xFFFFFFFF;
+
+            struct Node
+            {
+                AttributeCallback attributeCallback;
+                RenderCallback renderCallback;
+                uint32_t end; // index of the node after the last descendant
+                uint32_t depth;
+                uint32_t parent;
+                uint32_t voice;
+            };
+
+            struct Voice
+            {
+                Vector3 position;
+                float minDistance;
+                float maxDistance;
+                bool spatialized;
+                int32_t priority;
+                SkipCallback skipCallback;
+            };
+
+            struct Attributes
+            {
+                Vector3 listenerPosition;
+                Quaternion listenerRotation;
+                float pitch = 1.0f;
+                float gain = 1.0f;
+                float rolloffFactor = 1.0f;
+                bool virtualized = false;
+            };
+
+            RenderGraph() {}
+
+            RenderGraph(const RenderGraph&) = delete;
+            RenderGraph& operator=(const RenderGraph&) = delete;
+
+            RenderGraph(RenderGraph&&) = delete;
+            RenderGraph& operator=(RenderGraph&&) = delete;
+
+            void clear();
+
+            // nodes added between beginNode and endNode become children of the node
+            uint32_t beginNode(const AttributeCallback& attributeCallback,
+                               const RenderCallback& renderCallback = nullptr);
+            void endNode(uint32_t node);
+
+            // marks the node as a voice that can be virtualized
+            void setVoice(uint32_t node, const Voice& voice);
+            inline const Voice& getVoice(uint32_t voice) const { return voices[voice]; }
+
+            // allocates a buffer for every node and groups the nodes by depth
+            void prepare(uint32_t newMaxFrames, uint16_t newChannels);
+
+            inline const std::vector<Node>& getNodes() const { return nodes; }
+            inline uint32_t getMaxFrames() const { return maxFrames; }
+
+            inline uint32_t getLevelCount() const { return levels; }
+            inline const uint32_t* getLevelNodes(uint32_t depth) const { return levelNodes.data() + levelOffsets[depth]; }
+            inline uint32_t getLevelSize(uint32_t depth) const { return levelOffsets[depth + 1] - levelOffsets[depth]; }
+
+            // used only by the audio thread
+            inline float* getBuffer(uint32_t node) { return alignedBuffers + node * bufferStride; }
+            inline Attributes& getAttributes(uint32_t node) { return attributes[node]; }
+
+        private:
+            std::vector<Node> nodes;
+            std::vector<Voice> voices;
+            std::vector<uint32_t> openNodes;
+            uint32_t levels = 0;
+
+            std::vector<uint32_t> levelNodes;
+            std::vector<uint32_t> levelOffsets;
+
+            uint32_t maxFrames = 0;
+            uint32_t bufferStride = 0;
+            std::vector<float> buffers;
+            float* alignedBuffers = nullptr;
+            std::vector<Attributes> attributes;
+        };
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,122 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include "RenderWorkers.hpp"
+#include "thread/Lock.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // the levels of one callback follow each other closely, so the workers keep polling for a while before they sleep
+        static const std::chrono::microseconds SPIN_TIME(500);
+        // a wake up can be missed when the mutex is busy, the workers then wake up on their own
+        static const std::chrono::milliseconds SLEEP_TIME(5);
+
+        RenderWorkers::RenderWorkers(uint32_t workerCount):
+            state(0), nextIndex(0), finishedCount(0),
+            busyWorkers(0), sleepingWorkers(0), running(true)
+        {
+            for (uint32_t i = 0; i < workerCount; ++i)
+            {
+                workers.push_back(Thread(std::bind(&RenderWorkers::main, this), "Audio render"));
+            }
+        }
+
+        RenderWorkers::~RenderWorkers()
+        {
+            running = false;
+
+            {
+                Lock lock(wakeMutex);
+                wakeCondition.broadcast();
+            }
+
+            // joins the worker threads
+            workers.clear();
+        }
+
+        void RenderWorkers::run(uint32_t count, uint32_t batchSize, Function function, void* context)
+        {
+            taskFunction = function;
+            taskContext = context;
+            taskCount = count;
+            taskBatchSize = std::max(batchSize, 1U);
+            nextIndex.store(0, std::memory_order_relaxed);
+            finishedCount.store(0, std::memory_order_relaxed);
+
+            ++state; // open
+
+            // the audio thread must not wait for the mutex, so the sleeping workers are woken only if it is free
+            if (sleepingWorkers > 0 && wakeMutex.tryLock())
+            {
+                wakeCondition.broadcast();
+                wakeMutex.unlock();
+            }
+
+            process();
+
+            // the ranges that the workers have claimed are still being rendered
+            while (finishedCount.load(std::memory_order_acquire) < count) std::this_thread::yield();
+
+            ++state; // closed
+
+            // a worker that has not noticed that the task is closed could still read it
+            while (busyWorkers > 0) std::this_thread::yield();
+        }
+
+        void RenderWorkers::main()
+        {
+            uint32_t lastState = 0;
+            std::chrono::steady_clock::time_point lastTaskTime = std::chrono::steady_clock::now();
+
+            while (running)
+            {
+                uint32_t currentState = state;
+
+                if (currentState != lastState)
+                {
+                    if (currentState & 1)
+                    {
+                        ++busyWorkers;
+                        // the task is read only if it was not closed before the worker became busy
+                        if (state == currentState) process();
+                        --busyWorkers;
+
+                        lastTaskTime = std::chrono::steady_clock::now();
+                    }
+
+                    lastState = currentState;
+                }
+                else if (std::chrono::steady_clock::now() - lastTaskTime < SPIN_TIME)
+                {
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    Lock lock(wakeMutex);
+                    ++sleepingWorkers;
+                    if (running && state == lastState) wakeCondition.wait(wakeMutex, SLEEP_TIME);
+                    --sleepingWorkers;
+                }
+            }
+        }
+
+        void RenderWorkers::process()
+        {
+            for (;;)
+            {
+                uint32_t begin = nextIndex.fetch_add(taskBatchSize, std::memory_order_relaxed);
+                if (begin >= taskCount) break;
+
+                uint32_t end = std::min(begin + taskBatchSize, taskCount);
+                taskFunction(taskContext, begin, end);
+                finishedCount.fetch_add(end - begin, std::memory_order_release);
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
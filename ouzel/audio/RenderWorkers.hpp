@@ -0,0 +1,62 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "thread/Condition.hpp"
+#include "thread/Mutex.hpp"
+#include "thread/Thread.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Threads that help the audio thread to render a level of the render graph. They run nothing but the ranges
+        // given to run(), so unlike with the job system the audio thread never ends up executing unrelated jobs.
+        // run() does not allocate memory and does not wait for a lock: the ranges are claimed with an atomic index
+        // and the calling thread renders all the ranges that the workers have not taken.
+        class RenderWorkers final
+        {
+        public:
+            typedef void (*Function)(void* context, uint32_t begin, uint32_t end);
+
+            explicit RenderWorkers(uint32_t workerCount);
+            ~RenderWorkers();
+
+            RenderWorkers(const RenderWorkers&) = delete;
+            RenderWorkers& operator=(const RenderWorkers&) = delete;
+
+            RenderWorkers(RenderWorkers&&) = delete;
+            RenderWorkers& operator=(RenderWorkers&&) = delete;
+
+            inline uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+            // calls function for [begin, end) ranges of batchSize covering [0, count) and returns when all of them are done
+            void run(uint32_t count, uint32_t batchSize, Function function, void* context);
+
+        private:
+            void main();
+            void process();
+
+            // the task is written only while it is closed and no worker is busy
+            Function taskFunction = nullptr;
+            void* taskContext = nullptr;
+            uint32_t taskCount = 0;
+            uint32_t taskBatchSize = 1;
+
+            std::atomic<uint32_t> state; // odd while the task is open
+            std::atomic<uint32_t> nextIndex;
+            std::atomic<uint32_t> finishedCount;
+            std::atomic<uint32_t> busyWorkers;
+            std::atomic<uint32_t> sleepingWorkers;
+            std::atomic<bool> running;
+
+            Mutex wakeMutex;
+            Condition wakeCondition;
+            std::vector<Thread> workers;
+        };
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,304 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cmath>
+#include "Resampler.hpp"
+#include "math/SIMD.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static const uint32_t SINC_HALF_WIDTH = 8;
+        static const uint32_t SINC_TAPS = 2 * SINC_HALF_WIDTH;
+        static const uint32_t SINC_PHASES = 64;
+
+        // filter coefficients for SINC_PHASES + 1 evenly spaced fractional positions
+        static const float* getSincTable()
+        {
+            static const std::vector<float> table = []() {
+                const double pi = 3.14159265358979323846;
+                std::vector<float> result((SINC_PHASES + 1) * SINC_TAPS);
+
+                for (uint32_t phase = 0; phase <= SINC_PHASES; ++phase)
+                {
+                    float* row = result.data() + phase * SINC_TAPS;
+                    double fraction = static_cast<double>(phase) / SINC_PHASES;
+                    double sum = 0.0;
+
+                    for (uint32_t tap = 0; tap < SINC_TAPS; ++tap)
+                    {
+                        double x = static_cast<double>(tap) - (SINC_HALF_WIDTH - 1) - fraction;
+                        double sinc = (x == 0.0) ? 1.0 : sin(pi * x) / (pi * x);
+
+                        // Blackman window
+                        double w = pi * x / SINC_HALF_WIDTH;
+                        double window = (fabs(x) >= SINC_HALF_WIDTH) ? 0.0 : 0.42 + 0.5 * cos(w) + 0.08 * cos(2.0 * w);
+
+                        row[tap] = static_cast<float>(sinc * window);
+                        sum += row[tap];
+                    }
+
+                    // unity gain for DC
+                    for (uint32_t tap = 0; tap < SINC_TAPS; ++tap)
+                    {
+                        row[tap] = static_cast<float>(row[tap] / sum);
+                    }
+                }
+
+                return result;
+            }();
+
+            return table.data();
+        }
+
+        struct LinearFilter
+        {
+            static const uint32_t HALF_WIDTH = 1;
+
+            // samples points to the first frame used by the filter
+            inline float operator()(const float* samples, float fraction) const
+            {
+                return samples[0] + (samples[1] - samples[0]) * fraction;
+            }
+        };
+
+        struct CubicFilter
+        {
+            static const uint32_t HALF_WIDTH = 2;
+
+            // Catmull-Rom spline
+            inline float operator()(const float* samples, float fraction) const
+            {
+                float a = samples[0];
+                float b = samples[1];
+                float c = samples[2];
+                float d = samples[3];
+
+                return b + 0.5f * fraction * (c - a + fraction * (2.0f * a - 5.0f * b + 4.0f * c - d +
+                                                                  fraction * (3.0f * (b - c) + d - a)));
+            }
+        };
+
+        struct SincFilter
+        {
+            static const uint32_t HALF_WIDTH = SINC_HALF_WIDTH;
+
+            SincFilter(): table(getSincTable()) {}
+
+            inline float operator()(const float* samples, float fraction) const
+            {
+                float phase = fraction * SINC_PHASES;
+                uint32_t index = std::min(static_cast<uint32_t>(phase), SINC_PHASES - 1);
+                SIMDVector::Vector t = SIMDVector::set(phase - static_cast<float>(index));
+
+                const float* row = table + index * SINC_TAPS;
+                const float* nextRow = row + SINC_TAPS;
+
+                SIMDVector::Vector sum = SIMDVector::set(0.0f);
+
+                for (uint32_t tap = 0; tap < SINC_TAPS; tap += SIMDVector::SIZE)
+                {
+                    // interpolate between the two nearest phases
+                    SIMDVector::Vector coefficient = SIMDVector::load(row + tap);
+                    coefficient = SIMDVector::add(coefficient, SIMDVector::mul(SIMDVector::sub(SIMDVector::load(nextRow + tap), coefficient), t));
+
+                    sum = SIMDVector::add(sum, SIMDVector::mul(coefficient, SIMDVector::load(samples + tap)));
+                }
+
+                float lanes[SIMDVector::SIZE];
+                SIMDVector::store(lanes, sum);
+
+                float result = 0.0f;
+                for (uint32_t i = 0; i < SIMDVector::SIZE; ++i) result += lanes[i];
+
+                return result;
+            }
+
+            const float* table;
+        };
+
+        static uint32_t getHalfWidth(Resampler::Quality quality)
+        {
+            switch (quality)
+            {
+                case Resampler::Quality::LINEAR: return LinearFilter::HALF_WIDTH;
+                case Resampler::Quality::CUBIC: return CubicFilter::HALF_WIDTH;
+                case Resampler::Quality::SINC: return SincFilter::HALF_WIDTH;
+            }
+
+            return 1;
+        }
+
+        template<class Filter>
+        static void resampleChannel(const Filter& filter, const float* samples, uint32_t bufferedFrames,
+                                    double position, double ratio,
+                                    float* destination, uint32_t frames, uint16_t channels)
+        {
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                double framePosition = position + frame * ratio;
+                uint32_t index = static_cast<uint32_t>(framePosition);
+
+                if (index + Filter::HALF_WIDTH >= bufferedFrames)
+                {
+                    // not enough source frames
+                    for (; frame < frames; ++frame) destination[frame * channels] = 0.0f;
+                    break;
+                }
+
+                float fraction = static_cast<float>(framePosition - index);
+                destination[frame * channels] = filter(samples + index + 1 - Filter::HALF_WIDTH, fraction);
+            }
+        }
+
+        Resampler::Resampler(Quality initQuality):
+            quality(initQuality)
+        {
+            if (quality == Quality::SINC) getSincTable();
+
+            reset();
+        }
+
+        void Resampler::setQuality(Quality newQuality)
+        {
+            if (quality != newQuality)
+            {
+                quality = newQuality;
+                reset();
+            }
+        }
+
+        void Resampler::reset()
+        {
+            // start with silence before the first frame, so that the filter has history to read
+            halfWidth = getHalfWidth(quality);
+            bufferedFrames = halfWidth - 1;
+            position = static_cast<double>(halfWidth - 1);
+            cleared = false;
+        }
+
+        uint32_t Resampler::getSourceFrames(uint32_t frames, double ratio) const
+        {
+            if (frames == 0) return 0;
+
+            double lastPosition = position + (frames - 1) * ratio;
+            uint32_t neededFrames = static_cast<uint32_t>(lastPosition) + halfWidth + 1;
+
+            return (neededFrames > bufferedFrames) ? neededFrames - bufferedFrames : 0;
+        }
+
+        void Resampler::process(const float* source, uint32_t sourceFrames, uint16_t newChannels,
+                                float* destination, uint32_t frames, double ratio)
+        {
+            if (channels != newChannels)
+            {
+                channels = newChannels;
+                capacity = 0;
+                buffer.clear();
+                reset();
+            }
+
+            reserve(bufferedFrames + sourceFrames);
+
+            if (!cleared)
+            {
+                for (uint16_t channel = 0; channel < channels; ++channel)
+                {
+                    std::fill(buffer.begin() + channel * capacity,
+                              buffer.begin() + channel * capacity + bufferedFrames, 0.0f);
+                }
+
+                cleared = true;
+            }
+
+            // store every channel separately
+            for (uint16_t channel = 0; channel < channels; ++channel)
+            {
+                float* samples = buffer.data() + channel * capacity + bufferedFrames;
+
+                for (uint32_t frame = 0; frame < sourceFrames; ++frame)
+                {
+                    samples[frame] = source[frame * channels + channel];
+                }
+            }
+
+            bufferedFrames += sourceFrames;
+
+            for (uint16_t channel = 0; channel < channels; ++channel)
+            {
+                const float* samples = buffer.data() + channel * capacity;
+
+                if (ratio == 1.0 && position == floor(position) &&
+                    static_cast<uint32_t>(position) + frames + halfWidth <= bufferedFrames)
+                {
+                    samples += static_cast<uint32_t>(position);
+
+                    for (uint32_t frame = 0; frame < frames; ++frame)
+                    {
+                        destination[frame * channels + channel] = samples[frame];
+                    }
+                }
+                else
+                {
+                    switch (quality)
+                    {
+                        case Quality::LINEAR:
+                            resampleChannel(LinearFilter(), samples, bufferedFrames, position, ratio,
+                                            destination + channel, frames, channels);
+                            break;
+                        case Quality::CUBIC:
+                            resampleChannel(CubicFilter(), samples, bufferedFrames, position, ratio,
+                                            destination + channel, frames, channels);
+                            break;
+                        case Quality::SINC:
+                            resampleChannel(SincFilter(), samples, bufferedFrames, position, ratio,
+                                            destination + channel, frames, channels);
+                            break;
+                    }
+                }
+            }
+
+            // drop the frames that the filter won't read anymore
+            position += frames * ratio;
+            uint32_t consumedFrames = static_cast<uint32_t>(position) + 1 - halfWidth;
+            if (static_cast<uint32_t>(position) + 1 < halfWidth) consumedFrames = 0;
+            consumedFrames = std::min(consumedFrames, bufferedFrames);
+
+            if (consumedFrames > 0)
+            {
+                for (uint16_t channel = 0; channel < channels; ++channel)
+                {
+                    float* samples = buffer.data() + channel * capacity;
+                    std::copy(samples + consumedFrames, samples + bufferedFrames, samples);
+                }
+
+                bufferedFrames -= consumedFrames;
+                position -= consumedFrames;
+            }
+        }
+
+        void Resampler::reserve(uint32_t frames)
+        {
+            if (frames > capacity)
+            {
+                uint32_t newCapacity = std::max(frames, capacity * 2);
+                std::vector<float> newBuffer(channels * newCapacity);
+
+                if (cleared)
+                {
+                    for (uint16_t channel = 0; channel < channels; ++channel)
+                    {
+                        std::copy(buffer.begin() + channel * capacity,
+                                  buffer.begin() + channel * capacity + bufferedFrames,
+                                  newBuffer.begin() + channel * newCapacity);
+                    }
+                }
+
+                buffer.swap(newBuffer);
+                capacity = newCapacity;
+            }
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,54 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Converts a stream of interleaved frames to a different rate. The fractional read position and the
+        // frames needed by the interpolation filter are kept between calls, so consecutive blocks join without clicks.
+        class Resampler final
+        {
+        public:
+            enum class Quality
+            {
+                LINEAR,
+                CUBIC,
+                SINC // 16 tap windowed sinc, the cutoff is not lowered when the rate goes down
+            };
+
+            explicit Resampler(Quality initQuality = Quality::CUBIC);
+
+            inline Quality getQuality() const { return quality; }
+            void setQuality(Quality newQuality);
+
+            void reset();
+
+            // number of source frames that process needs to produce the given number of frames
+            uint32_t getSourceFrames(uint32_t frames, double ratio) const;
+
+            // ratio is the source frame rate divided by the destination frame rate
+            void process(const float* source, uint32_t sourceFrames, uint16_t newChannels,
+                         float* destination, uint32_t frames, double ratio);
+
+        private:
+            void reserve(uint32_t frames);
+
+            Quality quality;
+            uint32_t halfWidth; // number of frames the filter reads on each side of the position
+            uint16_t channels = 0;
+
+            double position; // in frames from the beginning of the buffer
+            uint32_t bufferedFrames;
+            bool cleared = false;
+
+            uint32_t capacity = 0; // frames per channel
+            std::vector<float> buffer; // one block of capacity frames per channel
+        };
+    } // namespace audio
+} // namespace ouzel
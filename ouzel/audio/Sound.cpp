@@ -1,9 +1,11 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include "Sound.hpp"
 #include "Audio.hpp"
 #include "AudioDevice.hpp"
+#include "Kernels.hpp"
 #include "SoundData.hpp"
 #include "Stream.hpp"
 #include "core/Engine.hpp"
@@ -70,6 +72,16 @@ namespace ouzel
             spatialized = newSpatialized;
         }
 
+        void Sound::setResamplerQuality(Resampler::Quality newResamplerQuality)
+        {
+            resamplerQuality = newResamplerQuality;
+        }
+
+        void Sound::setPriority(int32_t newPriority)
+        {
+            priority = newPriority;
+        }
+
         bool Sound::play(bool repeatSound)
         {
             if (actor) position = actor->getWorldPosition();
@@ -110,8 +122,10 @@ namespace ouzel
             return true;
         }
 
-        void Sound::addRenderCommands(std::vector<AudioDevice::RenderCommand>& renderCommands)
+        void Sound::addRenderCommands(RenderGraph& renderGraph)
         {
+            if (stream) stream->prefetch();
+
             if (soundData && stream && stream->isPlaying())
             {
                 if (transformDirty && actor)
@@ -120,36 +134,50 @@ namespace ouzel
                     transformDirty = false;
                 }
 
-                AudioDevice::RenderCommand renderCommand;
-
-                renderCommand.attributeCallback = std::bind(&Sound::setAttributes,
-                                                            std::placeholders::_1,
-                                                            std::placeholders::_2,
-                                                            std::placeholders::_3,
-                                                            std::placeholders::_4,
-                                                            std::placeholders::_5,
-                                                            pitch,
-                                                            gain,
-                                                            rolloffFactor);
-
-                renderCommand.renderCallback = std::bind(&Sound::render,
-                                                         std::placeholders::_1,
-                                                         std::placeholders::_2,
-                                                         std::placeholders::_3,
-                                                         std::placeholders::_4,
-                                                         std::placeholders::_5,
-                                                         std::placeholders::_6,
-                                                         std::placeholders::_7,
-                                                         std::placeholders::_8,
-                                                         std::placeholders::_9,
-                                                         soundData,
-                                                         stream,
-                                                         position,
-                                                         minDistance,
-                                                         maxDistance,
-                                                         spatialized);
-
-                renderCommands.push_back(renderCommand);
+                uint32_t node = renderGraph.beginNode(std::bind(&Sound::setAttributes,
+                                                                std::placeholders::_1,
+                                                                std::placeholders::_2,
+                                                                std::placeholders::_3,
+                                                                std::placeholders::_4,
+                                                                std::placeholders::_5,
+                                                                pitch,
+                                                                gain,
+                                                                rolloffFactor),
+                                                      std::bind(&Sound::render,
+                                                                std::placeholders::_1,
+                                                                std::placeholders::_2,
+                                                                std::placeholders::_3,
+                                                                std::placeholders::_4,
+                                                                std::placeholders::_5,
+                                                                std::placeholders::_6,
+                                                                std::placeholders::_7,
+                                                                std::placeholders::_8,
+                                                                std::placeholders::_9,
+                                                                soundData,
+                                                                stream,
+                                                                position,
+                                                                minDistance,
+                                                                maxDistance,
+                                                                spatialized,
+                                                                resamplerQuality));
+
+                RenderGraph::Voice voice;
+                voice.position = position;
+                voice.minDistance = minDistance;
+                voice.maxDistance = maxDistance;
+                voice.spatialized = spatialized;
+                voice.priority = priority;
+                voice.skipCallback = std::bind(&Sound::skip,
+                                               std::placeholders::_1,
+                                               std::placeholders::_2,
+                                               std::placeholders::_3,
+                                               std::placeholders::_4,
+                                               std::placeholders::_5,
+                                               soundData,
+                                               stream);
+                renderGraph.setVoice(node, voice);
+
+                renderGraph.endNode(node);
             }
         }
 
@@ -197,31 +225,36 @@ namespace ouzel
                            float pitch,
                            float gain,
                            float rolloffFactor,
-                           std::vector<float>& result,
+                           float* result,
                            const std::shared_ptr<SoundData>& soundData,
                            const std::shared_ptr<Stream>& stream,
                            const Vector3& position,
                            float minDistance,
                            float maxDistance,
-                           bool spatialized)
+                           bool spatialized,
+                           Resampler::Quality resamplerQuality)
         {
             if (soundData && stream)
             {
                 if (!stream->isPlaying())
                 {
-                    result.clear();
+                    std::fill(result, result + frames * channels, 0.0f);
                 }
                 else
                 {
                     if (stream->getShouldReset())
                     {
                         stream->reset();
+                        stream->getResampler().reset();
                         stream->setShouldReset(false);
                     }
 
+                    stream->getResampler().setQuality(resamplerQuality);
+
                     soundData->getData(stream.get(), frames, channels, sampleRate, pitch, result);
 
-                    std::vector<float> channelVolume(channels, gain);
+                    float channelVolume[Audio::MAX_CHANNELS];
+                    std::fill(channelVolume, channelVolume + channels, gain);
 
                     if (spatialized)
                     {
@@ -229,12 +262,12 @@ namespace ouzel
                         float distance = clamp(offset.length(), minDistance, maxDistance);
                         float attenuation = minDistance / (minDistance + rolloffFactor * (distance - minDistance)); // inverse distance
 
-                        for (float& volume : channelVolume)
+                        for (uint32_t channel = 0; channel < channels; ++channel)
                         {
-                            volume *= attenuation;
+                            channelVolume[channel] *= attenuation;
                         }
 
-                        if (channelVolume.size() > 1)
+                        if (channels > 1)
                         {
                             Quaternion inverseRotation = listenerRotation;
                             inverseRotation.invert();
@@ -250,17 +283,54 @@ namespace ouzel
                         }
                     }
 
-                    for (uint32_t frame = 0; frame < result.size() / channels; ++frame)
-                    {
-                        for (uint32_t channel = 0; channel < channels; ++channel)
-                        {
-                            result[frame * channels + channel] *= channelVolume[channel];
-                        }
-                    }
+                    // ramp from the previous gains to avoid clicks when the volume or the position changes
+                    const float* previousChannelVolume = stream->hasChannelVolumes() ? stream->getChannelVolumes() : channelVolume;
+                    applyGainRamp(result, frames, channels, previousChannelVolume, channelVolume);
+                    stream->setChannelVolumes(channelVolume, channels);
                 }
             }
 
             return true;
         }
+
+        void Sound::skip(uint32_t frames,
+                         uint16_t channels,
+                         uint32_t sampleRate,
+                         float pitch,
+                         float* result,
+                         const std::shared_ptr<SoundData>& soundData,
+                         const std::shared_ptr<Stream>& stream)
+        {
+            if (soundData && stream && stream->isPlaying())
+            {
+                if (stream->getShouldReset())
+                {
+                    stream->reset();
+                    stream->getResampler().reset();
+                    stream->setShouldReset(false);
+                }
+
+                float channelVolume[Audio::MAX_CHANNELS];
+                std::fill(channelVolume, channelVolume + Audio::MAX_CHANNELS, 0.0f);
+
+                // a voice that was audible in the previous block is rendered once more with a ramp to silence,
+                // cutting it off would click
+                const float* previousChannelVolume = stream->getChannelVolumes();
+
+                if (stream->hasChannelVolumes() &&
+                    std::any_of(previousChannelVolume, previousChannelVolume + channels, [](float volume) { return volume != 0.0f; }))
+                {
+                    soundData->getData(stream.get(), frames, channels, sampleRate, pitch, result);
+                    applyGainRamp(result, frames, channels, previousChannelVolume, channelVolume);
+                }
+                else
+                {
+                    soundData->skip(stream.get(), frames, sampleRate, pitch);
+                }
+
+                // fade in when the voice becomes real again
+                stream->setChannelVolumes(channelVolume, Audio::MAX_CHANNELS);
+            }
+        }
     } // namespace audio
 } // namespace ouzel
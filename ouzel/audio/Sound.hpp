@@ -48,6 +48,13 @@ namespace ouzel
             inline bool isSpatialized() const { return spatialized; }
             void setSpatialized(bool newSpatialized);
 
+            inline Resampler::Quality getResamplerQuality() const { return resamplerQuality; }
+            void setResamplerQuality(Resampler::Quality newResamplerQuality);
+
+            // voices with a higher priority are kept when there are more voices than the voice budget
+            inline int32_t getPriority() const { return priority; }
+            void setPriority(int32_t newPriority);
+
             bool play(bool repeatSound = false);
             bool pause();
             bool stop();
@@ -55,7 +62,7 @@ namespace ouzel
             bool isPlaying() const { return playing; }
             bool isRepeating() const { return repeating; }
 
-            virtual void addRenderCommands(std::vector<AudioDevice::RenderCommand>& renderCommands) override;
+            virtual void addRenderCommands(RenderGraph& renderGraph) override;
 
             virtual void onReset() override;
             virtual void onStop() override;
@@ -80,13 +87,22 @@ namespace ouzel
                                float pitch,
                                float gain,
                                float rolloffFactor,
-                               std::vector<float>& result,
+                               float* result,
                                const std::shared_ptr<SoundData>& soundData,
                                const std::shared_ptr<Stream>& stream,
                                const Vector3& position,
                                float minDistance,
                                float maxDistance,
-                               bool spatialized);
+                               bool spatialized,
+                               Resampler::Quality resamplerQuality);
+
+            static void skip(uint32_t frames,
+                             uint16_t channels,
+                             uint32_t sampleRate,
+                             float pitch,
+                             float* result,
+                             const std::shared_ptr<SoundData>& soundData,
+                             const std::shared_ptr<Stream>& stream);
 
             std::shared_ptr<SoundData> soundData;
             std::shared_ptr<Stream> stream;
@@ -98,6 +114,9 @@ namespace ouzel
             float minDistance = 1.0f;
             float maxDistance = FLT_MAX;
 
+            Resampler::Quality resamplerQuality = Resampler::Quality::CUBIC;
+            int32_t priority = 0;
+
             bool transformDirty = true;
             bool spatialized = true;
             bool playing = false;
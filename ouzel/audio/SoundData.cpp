@@ -1,9 +1,13 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include "SoundData.hpp"
 #include "Audio.hpp"
+#include "Kernels.hpp"
+#include "Stream.hpp"
 #include "core/Engine.hpp"
+#include "files/FileMapping.hpp"
 
 namespace ouzel
 {
@@ -19,43 +23,62 @@ namespace ouzel
 
         bool SoundData::init(const std::string& filename)
         {
-            std::vector<uint8_t> data;
-            if (!engine->getFileSystem()->readFile(filename, data))
+            FileMapping mapping;
+            if (!engine->getFileSystem()->mapFile(filename, mapping))
             {
                 return false;
             }
 
-            return init(data);
+            return init(mapping.getData());
         }
 
-        bool SoundData::init(const std::vector<uint8_t>&)
+        bool SoundData::init(const DataView&)
         {
             return true;
         }
 
-        bool SoundData::getData(Stream* stream, uint32_t frames, uint32_t neededChannels, uint32_t neededSampleRate, float pitch, std::vector<float>& result)
+        bool SoundData::skip(Stream* stream, uint32_t frames, uint32_t neededSampleRate, float pitch)
         {
-            uint32_t neededFrames = static_cast<uint32_t>(frames * pitch * sampleRate / neededSampleRate);
+            double sourceFrames = static_cast<double>(pitch) * sampleRate / neededSampleRate * frames + stream->getSkipFraction();
+            uint32_t wholeFrames = static_cast<uint32_t>(sourceFrames);
+            stream->setSkipFraction(sourceFrames - wholeFrames);
 
-            if (!readData(stream, neededFrames, tempData))
+            // the filter history is not valid after a jump
+            stream->getResampler().reset();
+
+            return skipData(stream, wholeFrames);
+        }
+
+        bool SoundData::skipData(Stream* stream, uint32_t frames)
+        {
+            // decode and drop the frames if the format can not skip them
+            return readData(stream, frames, stream->getDecodeBuffer());
+        }
+
+        bool SoundData::getData(Stream* stream, uint32_t frames, uint32_t neededChannels, uint32_t neededSampleRate, float pitch, float* result)
+        {
+            Resampler& resampler = stream->getResampler();
+            double ratio = static_cast<double>(pitch) * sampleRate / neededSampleRate;
+            uint32_t sourceFrames = resampler.getSourceFrames(frames, ratio);
+
+            std::vector<float>& decodeBuffer = stream->getDecodeBuffer();
+            std::vector<float>& resampleBuffer = stream->getResampleBuffer();
+
+            if (!readData(stream, sourceFrames, decodeBuffer))
             {
                 return false;
             }
 
-            if (pitch != 1.0f)
-            {
-                uint32_t srcFrames = static_cast<uint32_t>(tempData.size()) / channels;
+            if (resampleBuffer.size() < frames * channels) resampleBuffer.resize(frames * channels);
+            resampler.process(decodeBuffer.data(), sourceFrames, channels, resampleBuffer.data(), frames, ratio);
+            const float* resampledData = resampleBuffer.data();
 
-                Audio::resample(tempData, srcFrames, resampledData, frames, channels);
-            }
-            else
+            if (channels == 1 && neededChannels == 2)
             {
-                resampledData = tempData;
+                convertMonoToStereo(resampledData, result, frames);
             }
-
-            if (neededChannels != channels)
+            else if (neededChannels != channels)
             {
-                result.resize(frames * neededChannels);
 
                 // front left channel
                 if (channels >= 1)
@@ -233,7 +256,7 @@ namespace ouzel
             }
             else
             {
-                result = resampledData;
+                std::copy(resampledData, resampledData + frames * channels, result);
             }
 
             return true;
@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "files/DataView.hpp"
 
 namespace ouzel
 {
@@ -29,22 +30,23 @@ namespace ouzel
             SoundData& operator=(SoundData&&) = delete;
 
             virtual bool init(const std::string& filename);
-            virtual bool init(const std::vector<uint8_t>& newData);
+            virtual bool init(const DataView& newData);
 
             virtual std::shared_ptr<Stream> createStream() = 0;
-            bool getData(Stream* stream, uint32_t frames, uint32_t neededChannels, uint32_t neededSampleRate, float pitch, std::vector<float>& result);
+            bool getData(Stream* stream, uint32_t frames, uint32_t neededChannels, uint32_t neededSampleRate, float pitch, float* result);
+
+            // advances the stream as if the frames were rendered, used for virtual voices
+            bool skip(Stream* stream, uint32_t frames, uint32_t neededSampleRate, float pitch);
 
             inline uint16_t getChannels() const { return channels; }
             inline uint32_t getSampleRate() const { return sampleRate; }
 
         protected:
             virtual bool readData(Stream* stream, uint32_t frames, std::vector<float>& result) = 0;
+            virtual bool skipData(Stream* stream, uint32_t frames);
 
             uint16_t channels = 0;
             uint32_t sampleRate = 0;
-
-            std::vector<float> tempData;
-            std::vector<float> resampledData;
         };
     } // namespace audio
 } // namespace ouzel
@@ -1,9 +1,12 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include "SoundDataVorbis.hpp"
 #include "StreamVorbis.hpp"
+#include "core/Engine.hpp"
 #include "files/FileSystem.hpp"
+#include "thread/Lock.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
 #include "stb_vorbis.c"
@@ -12,40 +15,219 @@ namespace ouzel
 {
     namespace audio
     {
-        SoundDataVorbis::SoundDataVorbis()
+        static bool readBuffer(StreamVorbis* stream, const PCMCache::Buffer& buffer, uint32_t frames, std::vector<float>& result)
         {
+            uint32_t totalFrames = 0;
+
+            result.resize(frames * buffer.channels);
+            stream->setSeekPending(false);
+
+            while (totalFrames < frames && buffer.frames > 0)
+            {
+                if (stream->isRepeating() && stream->getPosition() >= buffer.frames) stream->reset();
+
+                uint32_t position = stream->getPosition();
+                uint32_t count = std::min(frames - totalFrames, buffer.frames - position);
+
+                if (buffer.format == Audio::Format::SINT16)
+                {
+                    const int16_t* source = buffer.intSamples.data() + position * buffer.channels;
+                    float* destination = result.data() + totalFrames * buffer.channels;
+
+                    for (uint32_t i = 0; i < count * buffer.channels; ++i)
+                    {
+                        destination[i] = static_cast<float>(source[i]) / 32767.0f;
+                    }
+                }
+                else
+                {
+                    std::copy(buffer.floatSamples.begin() + position * buffer.channels,
+                              buffer.floatSamples.begin() + (position + count) * buffer.channels,
+                              result.begin() + totalFrames * buffer.channels);
+                }
+
+                stream->setPosition(position + count);
+                totalFrames += count;
+
+                if (!stream->isRepeating()) break;
+            }
+
+            if (stream->getPosition() >= buffer.frames) stream->reset();
+
+            std::fill(result.begin() + totalFrames * buffer.channels, result.end(), 0.0f);
+
+            return true;
         }
 
-        bool SoundDataVorbis::init(const std::vector<uint8_t>& newData)
+        SoundDataVorbis::SoundDataVorbis(const std::shared_ptr<PCMCache>& initPCMCache):
+            pcmCache(initPCMCache)
         {
-            data = newData;
+        }
+
+        bool SoundDataVorbis::init(const DataView& newData)
+        {
+            data.assign(newData.begin(), newData.end());
 
             stb_vorbis* vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
             stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
 
             channels = static_cast<uint16_t>(info.channels);
             sampleRate = info.sample_rate;
+            length = stb_vorbis_stream_length_in_samples(vorbisStream);
 
             stb_vorbis_close(vorbisStream);
 
+            if (pcmCache && isDecodable()) decodeBuffer();
+
             return true;
         }
 
         std::shared_ptr<Stream> SoundDataVorbis::createStream()
         {
+            if (pcmCache)
+            {
+                std::shared_ptr<const PCMCache::Buffer> pcmBuffer = getBuffer();
+                if (pcmBuffer) return std::make_shared<StreamVorbis>(pcmBuffer);
+            }
+
             return std::make_shared<StreamVorbis>(data);
         }
 
+        bool SoundDataVorbis::isDecodable() const
+        {
+            uint32_t sampleSize = (pcmCache->getFormat() == Audio::Format::SINT16) ? sizeof(int16_t) : sizeof(float);
+            size_t decodedSize = static_cast<size_t>(length) * channels * sampleSize;
+
+            return length > 0 && decodedSize <= pcmCache->getDecodeThreshold();
+        }
+
+        std::shared_ptr<const PCMCache::Buffer> SoundDataVorbis::getBuffer()
+        {
+            std::shared_ptr<const PCMCache::Buffer> pcmBuffer;
+
+            {
+                Lock lock(bufferMutex);
+
+                pcmBuffer = buffer.lock();
+
+                if (pcmBuffer)
+                {
+                    // the buffer could have been evicted while it was still playing
+                    if (!pcmCache->touch(pcmBuffer)) pcmCache->insert(pcmBuffer);
+                    return pcmBuffer;
+                }
+
+                if (decoding || !isDecodable()) return nullptr;
+
+                decoding = true;
+            }
+
+            // the evicted buffer is decoded on a worker thread, the compressed data is played until it is ready
+            JobSystem* jobSystem = engine ? engine->getJobSystem() : nullptr;
+
+            if (jobSystem)
+            {
+                jobSystem->runBackground(std::bind(&SoundDataVorbis::decodeBuffer, shared_from_this()));
+            }
+            else
+            {
+                decodeBuffer();
+            }
+
+            Lock lock(bufferMutex);
+            return buffer.lock();
+        }
+
+        void SoundDataVorbis::decodeBuffer()
+        {
+            std::shared_ptr<const PCMCache::Buffer> pcmBuffer = decode();
+
+            Lock lock(bufferMutex);
+
+            if (pcmBuffer)
+            {
+                buffer = pcmBuffer;
+                pcmCache->insert(pcmBuffer);
+            }
+
+            decoding = false;
+        }
+
+        std::shared_ptr<PCMCache::Buffer> SoundDataVorbis::decode() const
+        {
+            stb_vorbis* vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
+
+            if (!vorbisStream)
+            {
+                Log(Log::Level::ERR) << "Failed to decode Vorbis sound";
+                return nullptr;
+            }
+
+            std::shared_ptr<PCMCache::Buffer> result = std::make_shared<PCMCache::Buffer>();
+            result->format = pcmCache->getFormat();
+            result->channels = channels;
+
+            uint32_t frames = 0;
+
+            if (result->format == Audio::Format::SINT16)
+            {
+                result->intSamples.resize(length * channels);
+
+                while (frames < length)
+                {
+                    int resultFrames = stb_vorbis_get_samples_short_interleaved(vorbisStream, channels,
+                                                                                result->intSamples.data() + frames * channels,
+                                                                                static_cast<int>((length - frames) * channels));
+                    if (resultFrames <= 0) break;
+                    frames += static_cast<uint32_t>(resultFrames);
+                }
+
+                result->intSamples.resize(frames * channels);
+            }
+            else
+            {
+                result->floatSamples.resize(length * channels);
+
+                while (frames < length)
+                {
+                    int resultFrames = stb_vorbis_get_samples_float_interleaved(vorbisStream, channels,
+                                                                                result->floatSamples.data() + frames * channels,
+                                                                                static_cast<int>((length - frames) * channels));
+                    if (resultFrames <= 0) break;
+                    frames += static_cast<uint32_t>(resultFrames);
+                }
+
+                result->floatSamples.resize(frames * channels);
+            }
+
+            stb_vorbis_close(vorbisStream);
+
+            result->frames = frames;
+
+            return result;
+        }
+
         bool SoundDataVorbis::readData(Stream* stream, uint32_t frames, std::vector<float>& result)
         {
             StreamVorbis* streamVorbis = static_cast<StreamVorbis*>(stream);
 
+            if (const PCMCache::Buffer* pcmBuffer = streamVorbis->getBuffer().get())
+            {
+                return readBuffer(streamVorbis, *pcmBuffer, frames, result);
+            }
+
             uint32_t neededSize = frames * channels;
             uint32_t totalSize = 0;
             stb_vorbis* vorbisStream = streamVorbis->getVorbisStream();
 
             result.resize(neededSize);
 
+            if (streamVorbis->isSeekPending())
+            {
+                stb_vorbis_seek(vorbisStream, streamVorbis->getPosition());
+                streamVorbis->setSeekPending(false);
+            }
+
             while (neededSize > 0)
             {
                 if (vorbisStream->eof)
@@ -53,7 +235,8 @@ namespace ouzel
                     stream->reset();
                 }
 
-                int resultFrames = stb_vorbis_get_samples_float_interleaved(vorbisStream, channels, result.data(), neededSize);
+                int resultFrames = stb_vorbis_get_samples_float_interleaved(vorbisStream, channels, result.data() + totalSize, neededSize);
+                streamVorbis->setPosition(streamVorbis->getPosition() + static_cast<uint32_t>(resultFrames));
                 totalSize += static_cast<uint32_t>(resultFrames) * channels;
                 neededSize -= static_cast<uint32_t>(resultFrames) * channels;
 
@@ -69,5 +252,29 @@ namespace ouzel
 
             return true;
         }
+
+        bool SoundDataVorbis::skipData(Stream* stream, uint32_t frames)
+        {
+            if (length == 0) return SoundData::skipData(stream, frames);
+
+            StreamVorbis* streamVorbis = static_cast<StreamVorbis*>(stream);
+
+            // seeking is delayed until the stream is read again
+            uint32_t position = streamVorbis->getPosition() + frames;
+
+            if (position >= length)
+            {
+                stream->reset();
+
+                if (!stream->isRepeating()) return true;
+
+                position %= length;
+            }
+
+            streamVorbis->setPosition(position);
+            streamVorbis->setSeekPending(true);
+
+            return true;
+        }
     } // namespace audio
 } // namespace ouzel
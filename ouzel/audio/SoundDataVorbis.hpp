@@ -4,27 +4,44 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
+#include "audio/PCMCache.hpp"
 #include "audio/SoundData.hpp"
+#include "thread/Mutex.hpp"
 
 namespace ouzel
 {
     namespace audio
     {
-        class SoundDataVorbis: public SoundData
+        class SoundDataVorbis: public SoundData, public std::enable_shared_from_this<SoundDataVorbis>
         {
         public:
-            SoundDataVorbis();
+            // short sounds are decoded to the PCM cache if one is given
+            explicit SoundDataVorbis(const std::shared_ptr<PCMCache>& initPCMCache = nullptr);
 
-            virtual bool init(const std::vector<uint8_t>& newData) override;
+            virtual bool init(const DataView& newData) override;
 
             virtual std::shared_ptr<Stream> createStream() override;
 
         protected:
             virtual bool readData(Stream* stream, uint32_t frames, std::vector<float>& result) override;
+            virtual bool skipData(Stream* stream, uint32_t frames) override;
+
+            bool isDecodable() const;
+            // returns nullptr while an evicted buffer is decoded again
+            std::shared_ptr<const PCMCache::Buffer> getBuffer();
+            void decodeBuffer();
+            std::shared_ptr<PCMCache::Buffer> decode() const;
 
             std::vector<uint8_t> data;
+            uint32_t length = 0;
+
+            std::shared_ptr<PCMCache> pcmCache;
+            Mutex bufferMutex;
+            std::weak_ptr<const PCMCache::Buffer> buffer;
+            bool decoding = false;
         };
     } // namespace audio
 } // namespace ouzel
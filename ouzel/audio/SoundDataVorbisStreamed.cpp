@@ -0,0 +1,114 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "SoundDataVorbisStreamed.hpp"
+#include "StreamVorbisStreamed.hpp"
+#include "core/Engine.hpp"
+#include "files/File.hpp"
+#include "files/FileSystem.hpp"
+#include "utils/Log.hpp"
+#define STB_VORBIS_HEADER_ONLY
+#include "stb_vorbis.c"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static const uint32_t HEADER_CHUNK_SIZE = 4096;
+        static const uint32_t MAX_HEADER_SIZE = 4 * 1024 * 1024;
+
+        SoundDataVorbisStreamed::SoundDataVorbisStreamed()
+        {
+        }
+
+        bool SoundDataVorbisStreamed::init(const std::string& newFilename)
+        {
+            File file;
+            uint64_t offset;
+            uint64_t size;
+
+            if (!engine->getFileSystem()->openFile(newFilename, file, offset, size))
+            {
+                return false;
+            }
+
+            // read until all the header packets are available
+            std::vector<uint8_t> header;
+            stb_vorbis* vorbisStream = nullptr;
+
+            while (!vorbisStream)
+            {
+                uint32_t chunkSize = static_cast<uint32_t>(std::min(static_cast<uint64_t>(HEADER_CHUNK_SIZE), size - header.size()));
+
+                if (chunkSize == 0 || header.size() + chunkSize > MAX_HEADER_SIZE)
+                {
+                    Log(Log::Level::ERR) << "Failed to read Vorbis header of " << newFilename;
+                    return false;
+                }
+
+                size_t headerSize = header.size();
+                header.resize(headerSize + chunkSize);
+
+                if (!file.read(header.data() + headerSize, chunkSize))
+                {
+                    Log(Log::Level::ERR) << "Failed to read file " << newFilename;
+                    return false;
+                }
+
+                int used = 0;
+                int error = 0;
+                vorbisStream = stb_vorbis_open_pushdata(header.data(), static_cast<int>(header.size()), &used, &error, nullptr);
+
+                if (!vorbisStream && error != VORBIS_need_more_data)
+                {
+                    Log(Log::Level::ERR) << "Failed to open Vorbis stream " << newFilename << ", error: " << error;
+                    return false;
+                }
+            }
+
+            stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
+
+            channels = static_cast<uint16_t>(info.channels);
+            sampleRate = info.sample_rate;
+
+            stb_vorbis_close(vorbisStream);
+
+            filename = newFilename;
+
+            return true;
+        }
+
+        bool SoundDataVorbisStreamed::init(const DataView&)
+        {
+            Log(Log::Level::ERR) << "Streamed Vorbis sound data has to be initialized with a file name";
+            return false;
+        }
+
+        std::shared_ptr<Stream> SoundDataVorbisStreamed::createStream()
+        {
+            return std::make_shared<StreamVorbisStreamed>(filename, channels);
+        }
+
+        bool SoundDataVorbisStreamed::readData(Stream* stream, uint32_t frames, std::vector<float>& result)
+        {
+            StreamVorbisStreamed* streamVorbis = static_cast<StreamVorbisStreamed*>(stream);
+
+            result.resize(frames * channels);
+
+            // frames that are not decoded yet are played as silence
+            uint32_t readFrames = streamVorbis->read(result.data(), frames);
+            std::fill(result.begin() + readFrames * channels, result.end(), 0.0f);
+
+            return true;
+        }
+
+        bool SoundDataVorbisStreamed::skipData(Stream* stream, uint32_t frames)
+        {
+            StreamVorbisStreamed* streamVorbis = static_cast<StreamVorbisStreamed*>(stream);
+            streamVorbis->skip(frames);
+
+            return true;
+        }
+    } // namespace audio
+} // namespace ouzel
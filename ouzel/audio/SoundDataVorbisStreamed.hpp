@@ -0,0 +1,34 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "audio/SoundData.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Vorbis sound data that is decoded from the file while playing, only the file name is kept in memory.
+        // Every stream opens its own handle to the file or archive entry.
+        class SoundDataVorbisStreamed: public SoundData
+        {
+        public:
+            SoundDataVorbisStreamed();
+
+            virtual bool init(const std::string& newFilename) override;
+            virtual bool init(const DataView& newData) override;
+
+            virtual std::shared_ptr<Stream> createStream() override;
+
+        protected:
+            virtual bool readData(Stream* stream, uint32_t frames, std::vector<float>& result) override;
+            virtual bool skipData(Stream* stream, uint32_t frames) override;
+
+            std::string filename;
+        };
+    } // namespace audio
+} // namespace ouzel
@@ -1,6 +1,7 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include <iterator>
 #include "SoundDataWave.hpp"
 #include "StreamWave.hpp"
@@ -22,7 +23,7 @@ namespace ouzel
         {
         }
 
-        bool SoundDataWave::init(const std::vector<uint8_t>& newData)
+        bool SoundDataWave::init(const DataView& newData)
         {
             uint32_t offset = 0;
 
@@ -258,5 +259,29 @@ namespace ouzel
 
             return true;
         }
+
+        bool SoundDataWave::skipData(Stream* stream, uint32_t frames)
+        {
+            StreamWave* streamWave = static_cast<StreamWave*>(stream);
+
+            if (data.empty()) return true;
+
+            uint32_t neededSize = frames * channels;
+
+            while (neededSize > 0)
+            {
+                if (stream->isRepeating() && (data.size() - streamWave->getOffset()) == 0) streamWave->reset();
+
+                uint32_t size = std::min(neededSize, static_cast<uint32_t>(data.size() - streamWave->getOffset()));
+                streamWave->setOffset(streamWave->getOffset() + size);
+                neededSize -= size;
+
+                if (!stream->isRepeating()) break;
+            }
+
+            if ((data.size() - streamWave->getOffset()) == 0) streamWave->reset();
+
+            return true;
+        }
     } // namespace audio
 } // namespace ouzel
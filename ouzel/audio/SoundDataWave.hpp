@@ -17,12 +17,13 @@ namespace ouzel
         public:
             SoundDataWave();
 
-            virtual bool init(const std::vector<uint8_t>& newData) override;
+            virtual bool init(const DataView& newData) override;
 
             virtual std::shared_ptr<Stream> createStream() override;
 
         protected:
             virtual bool readData(Stream* stream, uint32_t frames, std::vector<float>& result) override;
+            virtual bool skipData(Stream* stream, uint32_t frames) override;
 
             std::vector<float> data;
         };
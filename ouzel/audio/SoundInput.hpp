@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include "audio/AudioDevice.hpp"
+#include "audio/RenderGraph.hpp"
 
 namespace ouzel
 {
@@ -20,7 +20,7 @@ namespace ouzel
             inline SoundOutput* getOutput() const { return output; }
             void setOutput(SoundOutput* newOutput);
 
-            virtual void addRenderCommands(std::vector<AudioDevice::RenderCommand>& renderCommands) = 0;
+            virtual void addRenderCommands(RenderGraph& renderGraph) = 0;
 
         protected:
             SoundOutput* output = nullptr;
@@ -1,6 +1,7 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
 #include "Stream.hpp"
 #include "thread/Lock.hpp"
 
@@ -13,7 +14,7 @@ namespace ouzel
         }
 
         Stream::Stream():
-            playing(false), shouldReset(false)
+            playing(false), repeating(false), shouldReset(false)
         {
         }
 
@@ -32,6 +33,12 @@ namespace ouzel
             }
         }
 
+        void Stream::setChannelVolumes(const float* newChannelVolumes, uint16_t channels)
+        {
+            std::copy(newChannelVolumes, newChannelVolumes + channels, channelVolumes);
+            channelVolumesSet = true;
+        }
+
         void Stream::setEventListener(EventListener* newEventListener)
         {
             Lock lock(listenerMutex);
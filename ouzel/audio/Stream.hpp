@@ -5,6 +5,9 @@
 
 #include <cstdint>
 #include <atomic>
+#include <vector>
+#include "audio/Audio.hpp"
+#include "audio/Resampler.hpp"
 #include "thread/Mutex.hpp"
 
 namespace ouzel
@@ -33,6 +36,9 @@ namespace ouzel
 
             virtual void reset();
 
+            // called on the game thread every frame, streams that decode ahead of the audio thread schedule their work here
+            virtual void prefetch() {}
+
             bool isPlaying() const { return playing; }
             void setPlaying(bool newPlaying) { playing = newPlaying; }
 
@@ -44,6 +50,22 @@ namespace ouzel
 
             void setEventListener(EventListener* newEventListener);
 
+            // used only by the audio thread
+            inline Resampler& getResampler() { return resampler; }
+
+            // scratch buffers of SoundData::getData, every voice has its own, so that voices can be rendered in parallel
+            inline std::vector<float>& getDecodeBuffer() { return decodeBuffer; }
+            inline std::vector<float>& getResampleBuffer() { return resampleBuffer; }
+
+            // part of a source frame left over from skipping, used only by the audio thread
+            inline double getSkipFraction() const { return skipFraction; }
+            inline void setSkipFraction(double newSkipFraction) { skipFraction = newSkipFraction; }
+
+            // per channel gains of the previous rendered block, used only by the audio thread
+            inline bool hasChannelVolumes() const { return channelVolumesSet; }
+            inline const float* getChannelVolumes() const { return channelVolumes; }
+            void setChannelVolumes(const float* newChannelVolumes, uint16_t channels);
+
         private:
             std::atomic<bool> playing;
             std::atomic<bool> repeating;
@@ -51,6 +73,14 @@ namespace ouzel
 
             Mutex listenerMutex;
             EventListener* eventListener = nullptr;
+
+            Resampler resampler;
+            std::vector<float> decodeBuffer;
+            std::vector<float> resampleBuffer;
+            double skipFraction = 0.0;
+
+            float channelVolumes[Audio::MAX_CHANNELS];
+            bool channelVolumesSet = false;
         };
     } // namespace audio
 } // namespace ouzel
@@ -14,6 +14,11 @@ namespace ouzel
             vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
         }
 
+        StreamVorbis::StreamVorbis(const std::shared_ptr<const PCMCache::Buffer>& initBuffer):
+            buffer(initBuffer)
+        {
+        }
+
         StreamVorbis::~StreamVorbis()
         {
             if (vorbisStream)
@@ -26,7 +31,9 @@ namespace ouzel
         {
             Stream::reset();
 
-            stb_vorbis_seek_start(vorbisStream);
+            if (vorbisStream) stb_vorbis_seek_start(vorbisStream);
+            position = 0;
+            seekPending = false;
         }
     } // namespace audio
 } // namespace ouzel
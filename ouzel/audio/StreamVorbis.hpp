@@ -4,7 +4,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
+#include "PCMCache.hpp"
 #include "Stream.hpp"
 
 struct stb_vorbis;
@@ -17,13 +19,26 @@ namespace ouzel
         {
         public:
             StreamVorbis(const std::vector<uint8_t>& data);
+            // plays the sound from the decoded buffer instead of decoding it
+            StreamVorbis(const std::shared_ptr<const PCMCache::Buffer>& initBuffer);
             virtual ~StreamVorbis();
             virtual void reset() override;
 
             inline stb_vorbis* getVorbisStream() const { return vorbisStream; }
+            inline const std::shared_ptr<const PCMCache::Buffer>& getBuffer() const { return buffer; }
+
+            // frames from the beginning of the stream
+            inline uint32_t getPosition() const { return position; }
+            inline void setPosition(uint32_t newPosition) { position = newPosition; }
+
+            inline bool isSeekPending() const { return seekPending; }
+            inline void setSeekPending(bool newSeekPending) { seekPending = newSeekPending; }
 
         private:
             stb_vorbis* vorbisStream = nullptr;
+            std::shared_ptr<const PCMCache::Buffer> buffer;
+            uint32_t position = 0;
+            bool seekPending = false;
         };
     } // namespace audio
 } // namespace ouzel
@@ -0,0 +1,347 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <functional>
+#include "StreamVorbisStreamed.hpp"
+#include "core/Engine.hpp"
+#include "files/FileSystem.hpp"
+#include "utils/Log.hpp"
+#define STB_VORBIS_HEADER_ONLY
+#include "stb_vorbis.c"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static const uint32_t READ_CHUNK_SIZE = 16384;
+        static const uint32_t INPUT_BUFFER_SIZE = 65536;
+        static const uint32_t MAX_INPUT_BUFFER_SIZE = 4 * 1024 * 1024; // header packets can contain pictures
+
+        StreamVorbisStreamed::StreamVorbisStreamed(const std::string& filename, uint16_t initChannels):
+            channels(initChannels),
+            input(INPUT_BUFFER_SIZE),
+            ring(RING_FRAMES * initChannels),
+            readFrame(0), writeFrame(0), skipFrames(0),
+            boundaryHead(0), boundaryTail(0),
+            requestedGeneration(0), restartedGeneration(0)
+        {
+            if (!engine->getFileSystem()->openFile(filename, file, fileOffset, fileSize) ||
+                !restart())
+            {
+                finished = true;
+                return;
+            }
+
+            prefetch();
+        }
+
+        StreamVorbisStreamed::~StreamVorbisStreamed()
+        {
+            // the only job of the counter is a background job, so nothing is executed here
+            JobSystem* jobSystem = engine->getJobSystem();
+            if (jobSystem) jobSystem->wait(counter, true);
+
+            if (vorbisStream)
+            {
+                stb_vorbis_close(vorbisStream);
+            }
+        }
+
+        void StreamVorbisStreamed::reset()
+        {
+            Stream::reset();
+
+            skipFrames.store(0, std::memory_order_relaxed);
+
+            // the ring buffer is discarded once the job has restarted decoding
+            requestedGeneration.store(requestedGeneration.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        void StreamVorbisStreamed::prefetch()
+        {
+            if (!counter.isDone()) return;
+
+            if (restartedGeneration.load(std::memory_order_relaxed) == requestedGeneration.load(std::memory_order_acquire))
+            {
+                if (finished) return;
+
+                // refill only when less than half of the ring buffer is left
+                if (writeFrame.load(std::memory_order_relaxed) - readFrame.load(std::memory_order_relaxed) > RING_FRAMES / 2)
+                {
+                    return;
+                }
+            }
+
+            // the reads and the decoding are done only by the workers (or right here if there are none), never by
+            // threads that wait for their own jobs
+            JobSystem* jobSystem = engine->getJobSystem();
+            if (jobSystem) jobSystem->runBackground(std::bind(&StreamVorbisStreamed::decode, this), &counter);
+            else decode();
+        }
+
+        uint32_t StreamVorbisStreamed::read(float* result, uint32_t frames)
+        {
+            uint32_t generation = requestedGeneration.load(std::memory_order_relaxed);
+
+            // the job has not restarted decoding yet
+            if (restartedGeneration.load(std::memory_order_acquire) != generation) return 0;
+
+            if (readGeneration != generation)
+            {
+                readFrame.store(restartFrame, std::memory_order_release);
+                boundaryTail.store(restartBoundary, std::memory_order_release);
+                readGeneration = generation;
+            }
+
+            uint32_t currentFrame = readFrame.load(std::memory_order_relaxed);
+            uint32_t resultFrames = 0;
+
+            while (resultFrames < frames)
+            {
+                uint32_t availableFrames = writeFrame.load(std::memory_order_acquire) - currentFrame;
+
+                uint32_t tail = boundaryTail.load(std::memory_order_relaxed);
+                Boundary boundary = {0, false};
+                bool hasBoundary = false;
+
+                if (tail != boundaryHead.load(std::memory_order_acquire))
+                {
+                    boundary = boundaries[tail % MAX_BOUNDARIES];
+
+                    if (boundary.frame - currentFrame <= availableFrames)
+                    {
+                        availableFrames = boundary.frame - currentFrame;
+                        hasBoundary = true;
+                    }
+                }
+
+                uint32_t count = std::min(availableFrames, frames - resultFrames);
+                uint32_t index = currentFrame & (RING_FRAMES - 1);
+                uint32_t firstCount = std::min(count, RING_FRAMES - index);
+
+                if (result)
+                {
+                    std::copy(ring.begin() + index * channels,
+                              ring.begin() + (index + firstCount) * channels,
+                              result + resultFrames * channels);
+                    std::copy(ring.begin(),
+                              ring.begin() + (count - firstCount) * channels,
+                              result + (resultFrames + firstCount) * channels);
+                }
+
+                resultFrames += count;
+                currentFrame += count;
+                readFrame.store(currentFrame, std::memory_order_release);
+
+                if (hasBoundary && currentFrame == boundary.frame)
+                {
+                    boundaryTail.store(tail + 1, std::memory_order_release);
+
+                    // the job continues from the beginning of the file only if the stream was repeating when it reached the end
+                    if (boundary.looped && isRepeating())
+                    {
+                        Stream::reset();
+                    }
+                    else
+                    {
+                        reset();
+                        break;
+                    }
+                }
+                else if (count == 0) // buffer underrun
+                {
+                    break;
+                }
+            }
+
+            return resultFrames;
+        }
+
+        void StreamVorbisStreamed::skip(uint32_t frames)
+        {
+            uint32_t skippedFrames = read(nullptr, frames);
+
+            // nothing to skip after the end of the file
+            if (skippedFrames < frames && isPlaying())
+            {
+                skipFrames.fetch_add(frames - skippedFrames, std::memory_order_relaxed);
+            }
+        }
+
+        void StreamVorbisStreamed::decode()
+        {
+            uint32_t generation = requestedGeneration.load(std::memory_order_acquire);
+
+            if (restartedGeneration.load(std::memory_order_relaxed) != generation)
+            {
+                finished = !restart();
+                dropFrames = 0;
+                restartFrame = writeFrame.load(std::memory_order_relaxed);
+                restartBoundary = boundaryHead.load(std::memory_order_relaxed);
+                restartedGeneration.store(generation, std::memory_order_release);
+            }
+
+            while (!finished)
+            {
+                dropFrames += skipFrames.exchange(0, std::memory_order_relaxed);
+
+                if (outputOffset < outputFrames && dropFrames > 0)
+                {
+                    uint32_t count = std::min(dropFrames, outputFrames - outputOffset);
+                    outputOffset += count;
+                    dropFrames -= count;
+                }
+                else if (outputOffset < outputFrames)
+                {
+                    uint32_t currentFrame = writeFrame.load(std::memory_order_relaxed);
+                    uint32_t freeFrames = RING_FRAMES - (currentFrame - readFrame.load(std::memory_order_acquire));
+
+                    if (freeFrames == 0) break;
+
+                    uint32_t count = std::min(freeFrames, outputFrames - outputOffset);
+
+                    for (uint32_t frame = 0; frame < count; ++frame)
+                    {
+                        float* destination = ring.data() + ((currentFrame + frame) & (RING_FRAMES - 1)) * channels;
+
+                        for (uint16_t channel = 0; channel < channels; ++channel)
+                        {
+                            destination[channel] = output[channel][outputOffset + frame];
+                        }
+                    }
+
+                    outputOffset += count;
+                    writeFrame.store(currentFrame + count, std::memory_order_release);
+                }
+                else if (!decodeFrame())
+                {
+                    uint32_t head = boundaryHead.load(std::memory_order_relaxed);
+
+                    // wait for the audio thread to reach the previous boundaries
+                    if (head - boundaryTail.load(std::memory_order_acquire) >= MAX_BOUNDARIES) break;
+
+                    bool looped = isRepeating() && restart();
+
+                    Boundary& boundary = boundaries[head % MAX_BOUNDARIES];
+                    boundary.frame = writeFrame.load(std::memory_order_relaxed);
+                    boundary.looped = looped;
+                    boundaryHead.store(head + 1, std::memory_order_release);
+
+                    if (!looped) finished = true;
+                }
+            }
+        }
+
+        bool StreamVorbisStreamed::decodeFrame()
+        {
+            for (;;)
+            {
+                if (!vorbisStream)
+                {
+                    int used = 0;
+                    int error = 0;
+                    vorbisStream = stb_vorbis_open_pushdata(input.data() + inputStart, static_cast<int>(inputEnd - inputStart),
+                                                            &used, &error, nullptr);
+
+                    if (vorbisStream)
+                    {
+                        inputStart += static_cast<uint32_t>(used);
+                    }
+                    else if (error != VORBIS_need_more_data)
+                    {
+                        Log(Log::Level::ERR) << "Failed to open Vorbis stream, error: " << error;
+                        return false;
+                    }
+                    else if (!fillInput())
+                    {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                int frameChannels = 0;
+                float** frameOutput = nullptr;
+                int samples = 0;
+                int used = stb_vorbis_decode_frame_pushdata(vorbisStream, input.data() + inputStart, static_cast<int>(inputEnd - inputStart),
+                                                            &frameChannels, &frameOutput, &samples);
+                inputStart += static_cast<uint32_t>(used);
+
+                if (samples > 0)
+                {
+                    if (frameChannels != channels)
+                    {
+                        Log(Log::Level::ERR) << "Vorbis stream changed the channel count";
+                        return false;
+                    }
+
+                    output = frameOutput;
+                    outputFrames = static_cast<uint32_t>(samples);
+                    outputOffset = 0;
+
+                    return true;
+                }
+
+                // the decoder needs a whole page
+                if (used == 0 && !fillInput()) return false;
+            }
+        }
+
+        bool StreamVorbisStreamed::fillInput()
+        {
+            if (inputStart > 0)
+            {
+                std::copy(input.begin() + inputStart, input.begin() + inputEnd, input.begin());
+                inputEnd -= inputStart;
+                inputStart = 0;
+            }
+
+            if (readPosition == fileSize) return false;
+
+            if (inputEnd == input.size())
+            {
+                if (input.size() >= MAX_INPUT_BUFFER_SIZE)
+                {
+                    Log(Log::Level::ERR) << "Vorbis page is too big";
+                    return false;
+                }
+
+                input.resize(input.size() * 2);
+            }
+
+            uint32_t size = static_cast<uint32_t>(std::min(static_cast<uint64_t>(std::min(READ_CHUNK_SIZE, static_cast<uint32_t>(input.size()) - inputEnd)),
+                                                           fileSize - readPosition));
+            uint32_t bytesRead;
+
+            if (!file.readAt(input.data() + inputEnd, size, fileOffset + readPosition, bytesRead) || bytesRead == 0)
+            {
+                Log(Log::Level::ERR) << "Failed to read file";
+                return false;
+            }
+
+            inputEnd += bytesRead;
+            readPosition += bytesRead;
+
+            return true;
+        }
+
+        bool StreamVorbisStreamed::restart()
+        {
+            if (vorbisStream)
+            {
+                stb_vorbis_close(vorbisStream);
+                vorbisStream = nullptr;
+            }
+
+            inputStart = 0;
+            inputEnd = 0;
+            readPosition = 0;
+            output = nullptr;
+            outputFrames = 0;
+            outputOffset = 0;
+
+            return true;
+        }
+    } // namespace audio
+} // namespace ouzel
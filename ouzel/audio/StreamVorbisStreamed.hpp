@@ -0,0 +1,92 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Stream.hpp"
+#include "files/File.hpp"
+#include "thread/JobSystem.hpp"
+
+struct stb_vorbis;
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Decodes the file in a job and keeps up to RING_FRAMES decoded frames ahead of the audio thread.
+        // The job is the only writer and the audio thread the only reader of the ring buffer.
+        class StreamVorbisStreamed: public Stream
+        {
+        public:
+            StreamVorbisStreamed(const std::string& filename, uint16_t initChannels);
+            virtual ~StreamVorbisStreamed();
+
+            virtual void reset() override;
+            virtual void prefetch() override;
+
+            // used only by the audio thread, returns the number of frames written to the result
+            uint32_t read(float* result, uint32_t frames);
+
+            // used only by the audio thread, drops the decoded frames and lets the job drop the rest
+            void skip(uint32_t frames);
+
+        private:
+            static const uint32_t RING_FRAMES = 16384;
+            static const uint32_t MAX_BOUNDARIES = 4;
+
+            void decode();
+            bool decodeFrame();
+            bool fillInput();
+            bool restart();
+
+            uint16_t channels;
+
+            // used only by the decoding job
+            File file;
+            uint64_t fileOffset = 0;
+            uint64_t fileSize = 0;
+            uint64_t readPosition = 0;
+
+            stb_vorbis* vorbisStream = nullptr;
+            std::vector<uint8_t> input;
+            uint32_t inputStart = 0;
+            uint32_t inputEnd = 0;
+
+            float** output = nullptr;
+            uint32_t outputFrames = 0;
+            uint32_t outputOffset = 0;
+            uint32_t dropFrames = 0;
+            bool finished = false;
+
+            std::vector<float> ring;
+            std::atomic<uint32_t> readFrame;
+            std::atomic<uint32_t> writeFrame;
+            std::atomic<uint32_t> skipFrames; // frames that the job has to drop
+
+            // frames at which the end of the file was reached
+            struct Boundary
+            {
+                uint32_t frame;
+                bool looped;
+            };
+
+            Boundary boundaries[MAX_BOUNDARIES];
+            std::atomic<uint32_t> boundaryHead;
+            std::atomic<uint32_t> boundaryTail;
+
+            // the audio thread requests decoding from the beginning by incrementing requestedGeneration,
+            // the job answers by setting restartedGeneration after restartFrame and restartBoundary
+            std::atomic<uint32_t> requestedGeneration;
+            std::atomic<uint32_t> restartedGeneration;
+            uint32_t restartFrame = 0;
+            uint32_t restartBoundary = 0;
+            uint32_t readGeneration = 0;
+
+            JobSystem::Counter counter;
+        };
+    } // namespace audio
+} // namespace ouzel
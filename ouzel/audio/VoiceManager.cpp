@@ -0,0 +1,87 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "VoiceManager.hpp"
+#include "math/MathUtils.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        VoiceManager::VoiceManager():
+            maxVoices(128),
+            audibilityThreshold(0.001f), // -60 dB
+            realVoiceCount(0),
+            virtualVoiceCount(0)
+        {
+        }
+
+        void VoiceManager::update(RenderGraph& renderGraph)
+        {
+            const std::vector<RenderGraph::Node>& nodes = renderGraph.getNodes();
+            float threshold = audibilityThreshold;
+
+            candidates.clear();
+
+            uint32_t virtualCount = 0;
+
+            for (uint32_t index = 0; index < nodes.size(); ++index)
+            {
+                if (nodes[index].voice == RenderGraph::NO_VOICE) continue;
+
+                const RenderGraph::Voice& voice = renderGraph.getVoice(nodes[index].voice);
+                RenderGraph::Attributes& attributes = renderGraph.getAttributes(index);
+
+                float audibility = attributes.gain;
+
+                if (voice.spatialized)
+                {
+                    // same inverse distance attenuation as Sound::render, it stays constant beyond the max distance
+                    float distance = clamp((voice.position - attributes.listenerPosition).length(), voice.minDistance, voice.maxDistance);
+                    audibility *= voice.minDistance / (voice.minDistance + attributes.rolloffFactor * (distance - voice.minDistance));
+                }
+
+                if (audibility < threshold)
+                {
+                    attributes.virtualized = true;
+                    ++virtualCount;
+                }
+                else
+                {
+                    Candidate candidate;
+                    candidate.node = index;
+                    candidate.priority = voice.priority;
+                    candidate.audibility = audibility;
+                    candidates.push_back(candidate);
+                }
+            }
+
+            uint32_t voiceLimit = maxVoices;
+
+            if (candidates.size() > voiceLimit)
+            {
+                // node index breaks the ties, so that the same voices are kept every block
+                std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                    if (a.priority != b.priority) return a.priority > b.priority;
+                    if (a.audibility != b.audibility) return a.audibility > b.audibility;
+                    return a.node < b.node;
+                });
+
+                for (uint32_t i = voiceLimit; i < candidates.size(); ++i)
+                {
+                    renderGraph.getAttributes(candidates[i].node).virtualized = true;
+                    ++virtualCount;
+                }
+
+                realVoiceCount = voiceLimit;
+            }
+            else
+            {
+                realVoiceCount = static_cast<uint32_t>(candidates.size());
+            }
+
+            virtualVoiceCount = virtualCount;
+        }
+    } // namespace audio
+} // namespace ouzel
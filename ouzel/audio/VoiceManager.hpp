@@ -0,0 +1,60 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "audio/RenderGraph.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Decides which voices of the render graph are rendered. Voices that are quieter than the audibility
+        // threshold or don't fit in the voice budget become virtual, they keep their playback position but are not
+        // decoded or mixed. A voice that becomes virtual fades out during its first virtual block. Voices with a
+        // higher priority are kept first, then the louder ones.
+        class VoiceManager final
+        {
+        public:
+            VoiceManager();
+
+            VoiceManager(const VoiceManager&) = delete;
+            VoiceManager& operator=(const VoiceManager&) = delete;
+
+            VoiceManager(VoiceManager&&) = delete;
+            VoiceManager& operator=(VoiceManager&&) = delete;
+
+            inline uint32_t getMaxVoices() const { return maxVoices; }
+            inline void setMaxVoices(uint32_t newMaxVoices) { maxVoices = newMaxVoices; }
+
+            inline float getAudibilityThreshold() const { return audibilityThreshold; }
+            inline void setAudibilityThreshold(float newAudibilityThreshold) { audibilityThreshold = newAudibilityThreshold; }
+
+            // voice counts of the last rendered block
+            inline uint32_t getRealVoiceCount() const { return realVoiceCount; }
+            inline uint32_t getVirtualVoiceCount() const { return virtualVoiceCount; }
+
+            // called on the audio thread after the attributes of the graph are resolved
+            void update(RenderGraph& renderGraph);
+
+        private:
+            struct Candidate
+            {
+                uint32_t node;
+                int32_t priority;
+                float audibility;
+            };
+
+            std::atomic<uint32_t> maxVoices;
+            std::atomic<float> audibilityThreshold;
+
+            std::atomic<uint32_t> realVoiceCount;
+            std::atomic<uint32_t> virtualVoiceCount;
+
+            std::vector<Candidate> candidates;
+        };
+    } // namespace audio
+} // namespace ouzel
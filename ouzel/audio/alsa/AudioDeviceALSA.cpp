@@ -5,6 +5,9 @@
 
 #if OUZEL_COMPILE_ALSA
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include "AudioDeviceALSA.hpp"
 #include "core/Engine.hpp"
 #include "utils/Log.hpp"
@@ -16,6 +19,7 @@ namespace ouzel
         AudioDeviceALSA::AudioDeviceALSA():
             AudioDevice(Audio::Driver::ALSA), running(false)
         {
+            bufferSize = 1024;
         }
 
         AudioDeviceALSA::~AudioDeviceALSA()
@@ -88,18 +92,44 @@ namespace ouzel
                 return false;
             }
 
-            if ((err = snd_pcm_hw_params_set_rate(playbackHandle, hwParams, sampleRate, 0)) < 0)
+            unsigned int rate = sampleRate;
+
+            if ((err = snd_pcm_hw_params_set_rate_near(playbackHandle, hwParams, &rate, nullptr)) < 0)
             {
                 Log(Log::Level::ERR) << "Failed to set sample rate, error: " << err;
                 return false;
             }
 
-            if ((err = snd_pcm_hw_params_set_channels(playbackHandle, hwParams, channels)) < 0)
+            if (rate != sampleRate)
+            {
+                Log(Log::Level::WARN) << "Sample rate " << sampleRate << " is not supported, using " << rate;
+                sampleRate = rate;
+            }
+
+            unsigned int channelCount = channels;
+
+            if ((err = snd_pcm_hw_params_set_channels_near(playbackHandle, hwParams, &channelCount)) < 0)
             {
                 Log(Log::Level::ERR) << "Failed to set channel count, error: " << err;
                 return false;
             }
 
+            if (channelCount != channels)
+            {
+                if (channelCount > Audio::MAX_CHANNELS)
+                {
+                    Log(Log::Level::ERR) << "Unsupported channel count " << channelCount;
+                    return false;
+                }
+
+                Log(Log::Level::WARN) << "Channel count " << channels << " is not supported, using " << channelCount;
+                channels = static_cast<uint16_t>(channelCount);
+            }
+
+            // more periods leave room for adjusting the latency
+            periodSize = bufferSize;
+            if (adaptiveLatency) periods = 8;
+
             unsigned int periodLength = periodSize * 1000000 / sampleRate; // period length in microseconds
             unsigned int bufferLength = periodLength * periods; // buffer length in microseconds
             int dir;
@@ -128,6 +158,8 @@ namespace ouzel
                 return false;
             }
 
+            bufferSize = static_cast<uint32_t>(periodSize);
+
             if ((err = snd_pcm_hw_params(playbackHandle, hwParams)) < 0)
             {
                 Log(Log::Level::ERR) << "Failed to set hardware parameters, error: " << err;
@@ -149,7 +181,7 @@ namespace ouzel
                 return false;
             }
 
-            if ((err = snd_pcm_sw_params_set_avail_min(playbackHandle, swParams, 4096)) < 0)
+            if ((err = snd_pcm_sw_params_set_avail_min(playbackHandle, swParams, periodSize)) < 0)
             {
                 Log(Log::Level::ERR) << "Failed to set minimum available count, error: " << err;
                 return false;
@@ -176,6 +208,10 @@ namespace ouzel
             snd_pcm_sw_params_free(swParams);
             swParams = nullptr;
 
+            // the largest write is the whole buffer, allocate it up front so that the audio thread doesn't have to
+            data.reserve(periods * periodSize * channels * sizeof(float));
+
+            running = true;
             audioThread = Thread(std::bind(&AudioDeviceALSA::run, this), "Audio");
 
             return true;
@@ -183,6 +219,13 @@ namespace ouzel
 
         void AudioDeviceALSA::run()
         {
+            snd_pcm_uframes_t bufferFrames = periods * periodSize;
+
+            // frames kept in the device buffer, in adaptive mode it is lowered until underruns appear
+            snd_pcm_uframes_t targetFrames = bufferFrames;
+            snd_pcm_uframes_t minTargetFrames = adaptiveLatency ? 2 * periodSize : bufferFrames;
+            uint64_t stableFrames = 0;
+
             while (running)
             {
                 int err;
@@ -199,6 +242,8 @@ namespace ouzel
                     if (frames == -EPIPE)
                     {
                         Log(Log::Level::WARN) << "Buffer underrun occurred";
+                        profiler.addUnderrun();
+                        increaseLatency(targetFrames, minTargetFrames, stableFrames);
 
                         if ((err = snd_pcm_prepare(playbackHandle)) < 0)
                         {
@@ -215,28 +260,36 @@ namespace ouzel
                     }
                 }
 
-                if (static_cast<snd_pcm_uframes_t>(frames) > periods * periodSize)
+                if (static_cast<snd_pcm_uframes_t>(frames) > bufferFrames)
                 {
                     Log(Log::Level::WARN) << "Buffer size exceeded, error: " << frames;
+                    profiler.addXrun();
                     snd_pcm_reset(playbackHandle);
                     continue;
                 }
 
-                if (static_cast<snd_pcm_uframes_t>(frames) < periodSize)
+                snd_pcm_uframes_t queuedFrames = bufferFrames - static_cast<snd_pcm_uframes_t>(frames);
+                snd_pcm_uframes_t writeFrames = (targetFrames > queuedFrames) ? targetFrames - queuedFrames : 0;
+
+                if (writeFrames < periodSize)
                 {
+                    // wait until a whole period can be written
+                    std::this_thread::sleep_for(std::chrono::microseconds((periodSize - writeFrames) * 1000000 / sampleRate));
                     continue;
                 }
 
-                if (!getData(frames, data))
+                if (!getData(static_cast<uint32_t>(writeFrames), data))
                 {
                     break;
                 }
 
-                if ((err = snd_pcm_writei(playbackHandle, data.data(), frames)) < 0)
+                if ((err = snd_pcm_writei(playbackHandle, data.data(), writeFrames)) < 0)
                 {
                     if (err == -EPIPE)
                     {
                         Log(Log::Level::WARN) << "Buffer underrun occurred";
+                        profiler.addUnderrun();
+                        increaseLatency(targetFrames, minTargetFrames, stableFrames);
 
                         if ((err = snd_pcm_prepare(playbackHandle)) < 0)
                         {
@@ -250,8 +303,35 @@ namespace ouzel
                         break;
                     }
                 }
+                else if (targetFrames > minTargetFrames)
+                {
+                    // lower the latency by a period after every two seconds without underruns
+                    stableFrames += writeFrames;
+
+                    if (stableFrames >= 2 * sampleRate)
+                    {
+                        targetFrames -= periodSize;
+                        stableFrames = 0;
+                    }
+                }
             }
         }
+
+        void AudioDeviceALSA::increaseLatency(snd_pcm_uframes_t& targetFrames,
+                                              snd_pcm_uframes_t& minTargetFrames,
+                                              uint64_t& stableFrames)
+        {
+            if (!adaptiveLatency) return;
+
+            snd_pcm_uframes_t bufferFrames = periods * periodSize;
+
+            // don't go back to the latency that caused the underrun
+            minTargetFrames = std::min(targetFrames + periodSize, bufferFrames);
+            targetFrames = std::min(targetFrames + 2 * periodSize, bufferFrames);
+            stableFrames = 0;
+
+            Log(Log::Level::INFO) << "Audio latency increased to " << targetFrames << " frames";
+        }
     } // namespace audio
 } // namespace ouzel
 
@@ -28,13 +28,16 @@ namespace ouzel
             virtual bool init(bool debugAudio) override;
 
             void run();
+            void increaseLatency(snd_pcm_uframes_t& targetFrames,
+                                 snd_pcm_uframes_t& minTargetFrames,
+                                 uint64_t& stableFrames);
 
             snd_pcm_t* playbackHandle = nullptr;
             snd_pcm_hw_params_t* hwParams = nullptr;
             snd_pcm_sw_params_t* swParams = nullptr;
 
             unsigned int periods = 4;
-            snd_pcm_uframes_t periodSize = 1024;
+            snd_pcm_uframes_t periodSize = 0;
 
             std::vector<uint8_t> data;
 
@@ -117,7 +117,7 @@ namespace ouzel
             DSBUFFERDESC bufferDesc;
             bufferDesc.dwSize = sizeof(bufferDesc);
             bufferDesc.dwFlags = DSBCAPS_CTRLVOLUME | DSBCAPS_CTRLPOSITIONNOTIFY;
-            bufferDesc.dwBufferBytes = 2 * bufferSize;
+            bufferDesc.dwBufferBytes = 2 * bufferSize * channels * sizeof(int16_t);
             bufferDesc.dwReserved = 0;
             bufferDesc.lpwfxFormat = &waveFormat;
             bufferDesc.guid3DAlgorithm = GUID_NULL;
@@ -172,10 +172,10 @@ namespace ouzel
             notifyEvents[1] = CreateEvent(nullptr, true, false, nullptr);
 
             DSBPOSITIONNOTIFY positionNotifyEvents[2];
-            positionNotifyEvents[0].dwOffset = bufferSize - 1;
+            positionNotifyEvents[0].dwOffset = bufferSize * channels * sizeof(int16_t) - 1;
             positionNotifyEvents[0].hEventNotify = notifyEvents[0];
 
-            positionNotifyEvents[1].dwOffset = 2 * bufferSize - 1;
+            positionNotifyEvents[1].dwOffset = 2 * bufferSize * channels * sizeof(int16_t) - 1;
             positionNotifyEvents[1].hEventNotify = notifyEvents[1];
 
             hr = notify->SetNotificationPositions(2, positionNotifyEvents);
@@ -215,7 +215,8 @@ namespace ouzel
 
                     uint8_t* bufferPointer;
                     DWORD lockedBufferSize;
-                    HRESULT hr = buffer->Lock(nextBuffer * bufferSize, bufferSize, reinterpret_cast<void**>(&bufferPointer), &lockedBufferSize, nullptr, 0, 0);
+                    DWORD bufferBytes = bufferSize * channels * sizeof(int16_t);
+                    HRESULT hr = buffer->Lock(nextBuffer * bufferBytes, bufferBytes, reinterpret_cast<void**>(&bufferPointer), &lockedBufferSize, nullptr, 0, 0);
                     if (FAILED(hr))
                     {
                         Log(Log::Level::ERR) << "Failed to lock DirectSound buffer, error: " << hr;
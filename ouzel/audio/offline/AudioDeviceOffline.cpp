@@ -0,0 +1,160 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "AudioDeviceOffline.hpp"
+#include "utils/Log.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static const uint32_t WAVE_HEADER_SIZE = 44;
+
+        AudioDeviceOffline::AudioDeviceOffline():
+            AudioDevice(Audio::Driver::OFFLINE),
+            renderedFrames(0),
+            running(false)
+        {
+            format = Audio::Format::FLOAT32;
+        }
+
+        AudioDeviceOffline::~AudioDeviceOffline()
+        {
+            stop();
+            closeOutputFile();
+
+            if (profiler.getStats().callbackCount > 0) profiler.log();
+        }
+
+        bool AudioDeviceOffline::openOutputFile(const std::string& filename)
+        {
+            closeOutputFile();
+
+            outputFile.open(filename, std::ios::binary | std::ios::trunc);
+
+            if (!outputFile)
+            {
+                Log(Log::Level::ERR) << "Failed to open file " << filename;
+                return false;
+            }
+
+            // the sizes are written when the file is closed
+            uint8_t header[WAVE_HEADER_SIZE] = {
+                'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+                'f', 'm', 't', ' ', 16, 0, 0, 0
+            };
+
+            encodeUInt16Little(header + 20, 3); // IEEE float
+            encodeUInt16Little(header + 22, channels);
+            encodeUInt32Little(header + 24, sampleRate);
+            encodeUInt32Little(header + 28, sampleRate * channels * sizeof(float));
+            encodeUInt16Little(header + 32, static_cast<uint16_t>(channels * sizeof(float)));
+            encodeUInt16Little(header + 34, 32);
+
+            header[36] = 'd';
+            header[37] = 'a';
+            header[38] = 't';
+            header[39] = 'a';
+
+            outputFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+            outputSize = 0;
+
+            return true;
+        }
+
+        void AudioDeviceOffline::closeOutputFile()
+        {
+            if (outputFile.is_open())
+            {
+                uint8_t size[4];
+
+                encodeUInt32Little(size, WAVE_HEADER_SIZE - 8 + outputSize);
+                outputFile.seekp(4);
+                outputFile.write(reinterpret_cast<const char*>(size), sizeof(size));
+
+                encodeUInt32Little(size, outputSize);
+                outputFile.seekp(40);
+                outputFile.write(reinterpret_cast<const char*>(size), sizeof(size));
+
+                outputFile.close();
+            }
+        }
+
+        bool AudioDeviceOffline::render(uint64_t frames)
+        {
+            while (frames > 0)
+            {
+                uint32_t currentFrames = static_cast<uint32_t>(std::min(frames, static_cast<uint64_t>(bufferSize)));
+
+                if (!renderBuffer(currentFrames)) return false;
+
+                frames -= currentFrames;
+            }
+
+            return true;
+        }
+
+        void AudioDeviceOffline::start(uint64_t frames)
+        {
+            stop();
+
+            running = true;
+            renderThread = Thread(std::bind(&AudioDeviceOffline::run, this, frames), "Audio");
+        }
+
+        void AudioDeviceOffline::stop()
+        {
+            running = false;
+            // assigning an empty thread joins the current one, so it is not joined again by start or the destructor
+            renderThread = Thread();
+        }
+
+        void AudioDeviceOffline::run(uint64_t frames)
+        {
+            while (running)
+            {
+                uint32_t currentFrames = bufferSize;
+
+                if (frames > 0)
+                {
+                    if (frames <= bufferSize)
+                    {
+                        currentFrames = static_cast<uint32_t>(frames);
+                        running = false;
+                    }
+
+                    frames -= currentFrames;
+                }
+
+                if (!renderBuffer(currentFrames)) break;
+            }
+
+            running = false;
+        }
+
+        bool AudioDeviceOffline::renderBuffer(uint32_t frames)
+        {
+            if (!process())
+            {
+                return false;
+            }
+
+            if (!getData(frames, data))
+            {
+                return false;
+            }
+
+            renderedFrames += frames;
+
+            if (outputFile.is_open())
+            {
+                outputFile.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+                outputSize += static_cast<uint32_t>(data.size());
+            }
+
+            return true;
+        }
+    } // namespace audio
+} // namespace ouzel
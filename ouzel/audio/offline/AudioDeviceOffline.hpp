@@ -0,0 +1,58 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "audio/AudioDevice.hpp"
+#include "thread/Thread.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Renders the audio without a sound card as fast as possible, optionally to a 32-bit float WAV file.
+        // render() is deterministic when it is called between Audio updates on the game thread.
+        class AudioDeviceOffline: public AudioDevice
+        {
+            friend Audio;
+        public:
+            virtual ~AudioDeviceOffline();
+
+            // the header of the file is completed when it is closed
+            bool openOutputFile(const std::string& filename);
+            void closeOutputFile();
+
+            // renders the frames on the calling thread
+            bool render(uint64_t frames);
+
+            // renders on a separate thread, frames 0 means until stop is called
+            void start(uint64_t frames = 0);
+            void stop();
+            inline bool isRunning() const { return running; }
+
+            // the callback times are reported by getProfiler()
+            inline uint64_t getRenderedFrames() const { return renderedFrames; }
+
+        protected:
+            AudioDeviceOffline();
+
+            void run(uint64_t frames);
+            bool renderBuffer(uint32_t frames);
+
+            std::vector<uint8_t> data;
+
+            std::ofstream outputFile;
+            uint32_t outputSize = 0;
+
+            std::atomic<uint64_t> renderedFrames;
+
+            std::atomic<bool> running;
+            Thread renderThread;
+        };
+    } // namespace audio
+} // namespace ouzel
@@ -224,14 +224,14 @@ namespace ouzel
 
             format = Audio::Format::SINT16;
 
-            getData(bufferSize / (channels * sizeof(int16_t)), data);
+            getData(bufferSize, data);
 
             alBufferData(buffers[0], sampleFormat,
                          data.data(),
                          static_cast<ALsizei>(data.size()),
                          static_cast<ALsizei>(sampleRate));
 
-            getData(bufferSize / (channels * sizeof(int16_t)), data);
+            getData(bufferSize, data);
 
             alBufferData(buffers[1], sampleFormat,
                          data.data(),
@@ -299,7 +299,7 @@ namespace ouzel
                     return false;
                 }
 
-                if (!getData(bufferSize / (channels * sizeof(int16_t)), data))
+                if (!getData(bufferSize, data))
                 {
                     return false;
                 }
@@ -321,6 +321,9 @@ namespace ouzel
                 alGetSourcei(sourceId, AL_SOURCE_STATE, &state);
                 if (state != AL_PLAYING)
                 {
+                    // the source stops when it runs out of queued buffers
+                    profiler.addUnderrun();
+
                     alSourcePlay(sourceId);
 
                     if (checkOpenALError())
@@ -165,7 +165,7 @@ namespace ouzel
                 return false;
             }
 
-            if (!getData(bufferSize / (channels * sizeof(int16_t)), data))
+            if (!getData(bufferSize, data))
             {
                 return false;
             }
@@ -192,7 +192,7 @@ namespace ouzel
                 return;
             }
 
-            if (!getData(bufferSize / (channels * sizeof(int16_t)), data))
+            if (!getData(bufferSize, data))
             {
                 return;
             }
@@ -23,6 +23,7 @@ namespace ouzel
         AudioDeviceXA2::AudioDeviceXA2():
             AudioDevice(Audio::Driver::XAUDIO2), running(false)
         {
+            bufferSize = 1024;
         }
 
         AudioDeviceXA2::~AudioDeviceXA2()
@@ -165,7 +166,7 @@ namespace ouzel
 
             format = Audio::Format::FLOAT32;
 
-            getData(bufferSize / (channels * sizeof(float)), data[0]);
+            getData(bufferSize, data[0]);
 
             XAUDIO2_BUFFER bufferData;
             bufferData.Flags = 0;
@@ -185,7 +186,7 @@ namespace ouzel
                 return false;
             }
 
-            getData(bufferSize / (channels * sizeof(float)), data[1]);
+            getData(bufferSize, data[1]);
             bufferData.AudioBytes = static_cast<UINT32>(data[1].size());
             bufferData.pAudioData = data[1].data();
 
@@ -225,7 +226,7 @@ namespace ouzel
                     return;
                 }
 
-                if (!getData(bufferSize / (channels * sizeof(float)), data[nextBuffer]))
+                if (!getData(bufferSize, data[nextBuffer]))
                 {
                     return;
                 }
@@ -2,6 +2,7 @@
 // This file is part of the Ouzel engine.
 
 #include <algorithm>
+#include <thread>
 #include "Engine.hpp"
 #include "Setup.h"
 #include "utils/Log.hpp"
@@ -10,6 +11,7 @@
 #include "graphics/Renderer.hpp"
 #include "graphics/RenderDevice.hpp"
 #include "audio/Audio.hpp"
+#include "audio/AudioDevice.hpp"
 #include "thread/Lock.hpp"
 
 #if OUZEL_PLATFORM_MACOS
@@ -39,7 +41,7 @@ namespace ouzel
     ouzel::Engine* engine = nullptr;
 
     Engine::Engine():
-        active(false), paused(false), screenSaverEnabled(true)
+        executeQueue(256), active(false), paused(false), screenSaverEnabled(true)
     {
         engine = this;
     }
@@ -68,6 +70,9 @@ namespace ouzel
         }
 #endif
 
+        // the loading jobs use the engine
+        cache.cancelAsyncLoads();
+
         for (UpdateCallback* updateCallback : updateCallbackAddSet)
         {
             updateCallback->engine = nullptr;
@@ -100,6 +105,17 @@ namespace ouzel
         bool highDpi = true; // should high DPI resolution be used
         audio::Audio::Driver audioDriver = audio::Audio::Driver::DEFAULT;
         bool debugAudio = false;
+        uint32_t maxVoices = 0;
+        uint32_t audioBufferSize = 0;
+        uint32_t audioSampleRate = 0;
+        uint16_t audioChannels = 0;
+        bool audioAdaptiveLatency = false;
+#if OUZEL_MULTITHREADED
+        // the thread that waits for the jobs also executes them
+        uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1U) - 1;
+#else
+        uint32_t workerCount = 0;
+#endif
 
         defaultSettings.init("settings.ini");
         userSettings.init(fileSystem.getStorageDirectory() + FileSystem::DIRECTORY_SEPARATOR + "settings.ini");
@@ -209,6 +225,10 @@ namespace ouzel
             {
                 audioDriver = ouzel::audio::Audio::Driver::EMPTY;
             }
+            else if (audioDriverValue == "offline")
+            {
+                audioDriver = ouzel::audio::Audio::Driver::OFFLINE;
+            }
             else if (audioDriverValue == "openal")
             {
                 audioDriver = ouzel::audio::Audio::Driver::OPENAL;
@@ -243,6 +263,34 @@ namespace ouzel
         std::string debugAudioValue = userEngineSection.getValue("debugAudio", defaultEngineSection.getValue("debugAudio"));
         if (!debugAudioValue.empty()) debugAudio = (debugAudioValue == "true" || debugAudioValue == "1" || debugAudioValue == "yes");
 
+        std::string maxVoicesValue = userEngineSection.getValue("maxVoices", defaultEngineSection.getValue("maxVoices"));
+        if (!maxVoicesValue.empty()) maxVoices = static_cast<uint32_t>(std::stoul(maxVoicesValue));
+
+        std::string audioBufferSizeValue = userEngineSection.getValue("audioBufferSize", defaultEngineSection.getValue("audioBufferSize"));
+        if (!audioBufferSizeValue.empty()) audioBufferSize = static_cast<uint32_t>(std::stoul(audioBufferSizeValue));
+
+        std::string audioSampleRateValue = userEngineSection.getValue("audioSampleRate", defaultEngineSection.getValue("audioSampleRate"));
+        if (!audioSampleRateValue.empty()) audioSampleRate = static_cast<uint32_t>(std::stoul(audioSampleRateValue));
+
+        std::string audioChannelsValue = userEngineSection.getValue("audioChannels", defaultEngineSection.getValue("audioChannels"));
+        if (!audioChannelsValue.empty()) audioChannels = static_cast<uint16_t>(std::stoul(audioChannelsValue));
+
+        std::string audioAdaptiveLatencyValue = userEngineSection.getValue("audioAdaptiveLatency", defaultEngineSection.getValue("audioAdaptiveLatency"));
+        if (!audioAdaptiveLatencyValue.empty()) audioAdaptiveLatency = (audioAdaptiveLatencyValue == "true" || audioAdaptiveLatencyValue == "1" || audioAdaptiveLatencyValue == "yes");
+
+        std::string soundDecodeThresholdValue = userEngineSection.getValue("soundDecodeThreshold", defaultEngineSection.getValue("soundDecodeThreshold"));
+        if (!soundDecodeThresholdValue.empty()) cache.getPCMCache()->setDecodeThreshold(static_cast<size_t>(std::stoull(soundDecodeThresholdValue)));
+
+        std::string soundCacheSizeValue = userEngineSection.getValue("soundCacheSize", defaultEngineSection.getValue("soundCacheSize"));
+        if (!soundCacheSizeValue.empty()) cache.getPCMCache()->setBudget(static_cast<size_t>(std::stoull(soundCacheSizeValue)));
+
+#if OUZEL_MULTITHREADED
+        std::string workerCountValue = userEngineSection.getValue("workerCount", defaultEngineSection.getValue("workerCount"));
+        if (!workerCountValue.empty()) workerCount = static_cast<uint32_t>(std::stoul(workerCountValue));
+#endif
+
+        jobSystem.reset(new JobSystem(workerCount));
+
         if (graphicsDriver == graphics::Renderer::Driver::DEFAULT)
         {
             auto availableDrivers = graphics::Renderer::getAvailableRenderDrivers();
@@ -326,11 +374,13 @@ namespace ouzel
 
         audio.reset(new audio::Audio(audioDriver));
 
-        if (!audio->init(debugAudio))
+        if (!audio->init(debugAudio, audioBufferSize, audioSampleRate, audioChannels, audioAdaptiveLatency))
         {
             return false;
         }
 
+        if (maxVoices) audio->getDevice()->getVoiceManager().setMaxVoices(maxVoices);
+
 #if OUZEL_PLATFORM_MACOS
         input.reset(new input::InputMacOS());
 #elif OUZEL_PLATFORM_IOS
@@ -491,6 +541,8 @@ namespace ouzel
 
             updateCallbackAddSet.clear();
 
+            // the update callbacks (animators included) are not spread over the job system, because they run in
+            // priority order, several animators can move the same actor and the callbacks can add or remove others
             for (UpdateCallback* updateCallback : updateCallbacks)
             {
                 auto i = std::find(updateCallbackDeleteSet.begin(), updateCallbackDeleteSet.end(), updateCallback);
@@ -510,7 +562,7 @@ namespace ouzel
             if (renderer->getDevice()->getRefillQueue())
             {
                 sceneManager.draw();
-                renderer->getDevice()->flushCommands();
+                renderer->flushCommands();
             }
 
             audio->update();
@@ -578,32 +630,16 @@ namespace ouzel
         }
     }
 
-    void Engine::executeOnUpdateThread(const std::function<void(void)>& func)
+    void Engine::executeOnUpdateThread(SmallFunction func)
     {
-        Lock lock(executeMutex);
-
-        executeQueue.push(func);
+        executeQueue.push(std::move(func));
     }
 
     void Engine::executeAll()
     {
-        std::function<void(void)> func;
-
-        for (;;)
-        {
-            {
-                Lock lock(executeMutex);
-                if (executeQueue.empty()) break;
-
-                func = std::move(executeQueue.front());
-                executeQueue.pop();
-            }
-
-            if (func)
-            {
-                func();
-            }
-        }
+        executeQueue.drain([](SmallFunction& func) {
+            if (func) func();
+        });
     }
 
     bool Engine::openURL(const std::string&)
@@ -21,6 +21,8 @@
 #include "localization/Localization.hpp"
 #include "network/Network.hpp"
 #include "thread/Condition.hpp"
+#include "thread/JobSystem.hpp"
+#include "thread/MPSCQueue.hpp"
 #include "thread/Mutex.hpp"
 #include "thread/Thread.hpp"
 #include "utils/INI.hpp"
@@ -57,6 +59,7 @@ namespace ouzel
         inline input::Input* getInput() const { return input.get(); }
         inline Localization* getLocalization() { return &localization; }
         inline network::Network* getNetwork() { return &network; }
+        inline JobSystem* getJobSystem() const { return jobSystem.get(); }
 
         inline const ini::Data& getDefaultSettings() const { return defaultSettings; }
         inline const ini::Data& getUserSettings() const { return userSettings; }
@@ -73,7 +76,7 @@ namespace ouzel
         void scheduleUpdate(UpdateCallback* callback);
         void unscheduleUpdate(UpdateCallback* callback);
 
-        void executeOnUpdateThread(const std::function<void(void)>& func);
+        void executeOnUpdateThread(SmallFunction func);
 
         void update();
 
@@ -88,6 +91,7 @@ namespace ouzel
         virtual void main();
         void executeAll();
 
+        std::unique_ptr<JobSystem> jobSystem;
         FileSystem fileSystem;
         EventDispatcher eventDispatcher;
         Window window;
@@ -114,8 +118,7 @@ namespace ouzel
         Condition updateCondition;
 #endif
 
-        std::queue<std::function<void(void)>> executeQueue;
-        Mutex executeMutex;
+        MPSCQueue<SmallFunction> executeQueue;
 
         std::atomic<bool> active;
         std::atomic<bool> paused;
@@ -143,3 +143,7 @@
 #if defined(__SSE__)
     #define OUZEL_SUPPORTS_SSE 1
 #endif
+
+#if defined(__SSE2__)
+    #define OUZEL_SUPPORTS_SSE2 1
+#endif
@@ -4,11 +4,11 @@
 #include <algorithm>
 #include "EventDispatcher.hpp"
 #include "EventHandler.hpp"
-#include "thread/Lock.hpp"
 
 namespace ouzel
 {
-    EventDispatcher::EventDispatcher()
+    EventDispatcher::EventDispatcher():
+        eventQueue(1024)
     {
     }
 
@@ -57,128 +57,137 @@ namespace ouzel
 
         eventHandlerAddSet.clear();
 
-        Event event;
+        bool propagate = true;
+        size_t dispatchedCount = 0;
 
-        for (;;)
+        // the events that were deferred in the previous call go first
+        for (; propagate && dispatchedCount < deferredEvents.size(); ++dispatchedCount)
         {
-            {
-                Lock lock(eventQueueMutex);
-                if (eventQueue.empty()) break;
+            propagate = dispatchEvent(deferredEvents[dispatchedCount]);
+        }
+
+        deferredEvents.erase(deferredEvents.begin(), deferredEvents.begin() + static_cast<std::ptrdiff_t>(dispatchedCount));
 
-                event = std::move(eventQueue.front());
-                eventQueue.pop();
+        eventQueue.drain([this, &propagate](Event& event) {
+            if (propagate)
+            {
+                propagate = dispatchEvent(event);
             }
+            else
+            {
+                deferredEvents.push_back(std::move(event));
+            }
+        });
+    }
 
-            bool propagate = true;
+    bool EventDispatcher::dispatchEvent(const Event& event)
+    {
+        bool propagate = true;
 
-            for (const EventHandler* eventHandler : eventHandlers)
-            {
-                auto i = std::find(eventHandlerDeleteSet.begin(), eventHandlerDeleteSet.end(), eventHandler);
+        for (const EventHandler* eventHandler : eventHandlers)
+        {
+            auto i = std::find(eventHandlerDeleteSet.begin(), eventHandlerDeleteSet.end(), eventHandler);
 
-                if (i == eventHandlerDeleteSet.end())
+            if (i == eventHandlerDeleteSet.end())
+            {
+                switch (event.type)
                 {
-                    switch (event.type)
-                    {
-                        case Event::Type::KEY_PRESS:
-                        case Event::Type::KEY_RELEASE:
-                        case Event::Type::KEY_REPEAT:
-                            if (eventHandler->keyboardHandler)
-                            {
-                                propagate = eventHandler->keyboardHandler(event.type, event.keyboardEvent);
-                            }
-                            break;
-
-                        case Event::Type::MOUSE_PRESS:
-                        case Event::Type::MOUSE_RELEASE:
-                        case Event::Type::MOUSE_SCROLL:
-                        case Event::Type::MOUSE_MOVE:
-                            if (eventHandler->mouseHandler)
-                            {
-                                propagate = eventHandler->mouseHandler(event.type, event.mouseEvent);
-                            }
-                            break;
-                        case Event::Type::TOUCH_BEGIN:
-                        case Event::Type::TOUCH_MOVE:
-                        case Event::Type::TOUCH_END:
-                        case Event::Type::TOUCH_CANCEL:
-                            if (eventHandler->touchHandler)
-                            {
-                                propagate = eventHandler->touchHandler(event.type, event.touchEvent);
-                            }
-                            break;
-                        case Event::Type::GAMEPAD_CONNECT:
-                        case Event::Type::GAMEPAD_DISCONNECT:
-                        case Event::Type::GAMEPAD_BUTTON_CHANGE:
-                            if (eventHandler->gamepadHandler)
-                            {
-                                propagate = eventHandler->gamepadHandler(event.type, event.gamepadEvent);
-                            }
-                            break;
-                        case Event::Type::WINDOW_SIZE_CHANGE:
-                        case Event::Type::WINDOW_TITLE_CHANGE:
-                        case Event::Type::FULLSCREEN_CHANGE:
-                        case Event::Type::SCREEN_CHANGE:
-                        case Event::Type::RESOLUTION_CHANGE:
-                            if (eventHandler->windowHandler)
-                            {
-                                propagate = eventHandler->windowHandler(event.type, event.windowEvent);
-                            }
-                            break;
-                        case Event::Type::ENGINE_START:
-                        case Event::Type::ENGINE_STOP:
-                        case Event::Type::ENGINE_RESUME:
-                        case Event::Type::ENGINE_PAUSE:
-                        case Event::Type::ORIENTATION_CHANGE:
-                        case Event::Type::LOW_MEMORY:
-                        case Event::Type::OPEN_FILE:
-                            if (eventHandler->systemHandler)
-                            {
-                                propagate = eventHandler->systemHandler(event.type, event.systemEvent);
-                            }
-                            break;
-                        case Event::Type::ACTOR_ENTER:
-                        case Event::Type::ACTOR_LEAVE:
-                        case Event::Type::ACTOR_PRESS:
-                        case Event::Type::ACTOR_RELEASE:
-                        case Event::Type::ACTOR_CLICK:
-                        case Event::Type::ACTOR_DRAG:
-                        case Event::Type::WIDGET_CHANGE:
-                            if (eventHandler->uiHandler)
-                            {
-                                propagate = eventHandler->uiHandler(event.type, event.uiEvent);
-                            }
-                            break;
-                        case Event::Type::ANIMATION_START:
-                        case Event::Type::ANIMATION_RESET:
-                        case Event::Type::ANIMATION_FINISH:
-                            if (eventHandler->animationHandler)
-                            {
-                                propagate = eventHandler->animationHandler(event.type, event.animationEvent);
-                            }
-                            break;
-                        case Event::Type::SOUND_START:
-                        case Event::Type::SOUND_RESET:
-                        case Event::Type::SOUND_FINISH:
-                            if (eventHandler->soundHandler)
-                            {
-                                propagate = eventHandler->soundHandler(event.type, event.soundEvent);
-                            }
-                            break;
-                        case Event::Type::USER:
-                            if (eventHandler->userHandler)
-                            {
-                                propagate = eventHandler->userHandler(event.type, event.userEvent);
-                            }
-                            break;
-                    }
+                    case Event::Type::KEY_PRESS:
+                    case Event::Type::KEY_RELEASE:
+                    case Event::Type::KEY_REPEAT:
+                        if (eventHandler->keyboardHandler)
+                        {
+                            propagate = eventHandler->keyboardHandler(event.type, event.keyboardEvent);
+                        }
+                        break;
+
+                    case Event::Type::MOUSE_PRESS:
+                    case Event::Type::MOUSE_RELEASE:
+                    case Event::Type::MOUSE_SCROLL:
+                    case Event::Type::MOUSE_MOVE:
+                        if (eventHandler->mouseHandler)
+                        {
+                            propagate = eventHandler->mouseHandler(event.type, event.mouseEvent);
+                        }
+                        break;
+                    case Event::Type::TOUCH_BEGIN:
+                    case Event::Type::TOUCH_MOVE:
+                    case Event::Type::TOUCH_END:
+                    case Event::Type::TOUCH_CANCEL:
+                        if (eventHandler->touchHandler)
+                        {
+                            propagate = eventHandler->touchHandler(event.type, event.touchEvent);
+                        }
+                        break;
+                    case Event::Type::GAMEPAD_CONNECT:
+                    case Event::Type::GAMEPAD_DISCONNECT:
+                    case Event::Type::GAMEPAD_BUTTON_CHANGE:
+                        if (eventHandler->gamepadHandler)
+                        {
+                            propagate = eventHandler->gamepadHandler(event.type, event.gamepadEvent);
+                        }
+                        break;
+                    case Event::Type::WINDOW_SIZE_CHANGE:
+                    case Event::Type::WINDOW_TITLE_CHANGE:
+                    case Event::Type::FULLSCREEN_CHANGE:
+                    case Event::Type::SCREEN_CHANGE:
+                    case Event::Type::RESOLUTION_CHANGE:
+                        if (eventHandler->windowHandler)
+                        {
+                            propagate = eventHandler->windowHandler(event.type, event.windowEvent);
+                        }
+                        break;
+                    case Event::Type::ENGINE_START:
+                    case Event::Type::ENGINE_STOP:
+                    case Event::Type::ENGINE_RESUME:
+                    case Event::Type::ENGINE_PAUSE:
+                    case Event::Type::ORIENTATION_CHANGE:
+                    case Event::Type::LOW_MEMORY:
+                    case Event::Type::OPEN_FILE:
+                        if (eventHandler->systemHandler)
+                        {
+                            propagate = eventHandler->systemHandler(event.type, event.systemEvent);
+                        }
+                        break;
+                    case Event::Type::ACTOR_ENTER:
+                    case Event::Type::ACTOR_LEAVE:
+                    case Event::Type::ACTOR_PRESS:
+                    case Event::Type::ACTOR_RELEASE:
+                    case Event::Type::ACTOR_CLICK:
+                    case Event::Type::ACTOR_DRAG:
+                    case Event::Type::WIDGET_CHANGE:
+                        if (eventHandler->uiHandler)
+                        {
+                            propagate = eventHandler->uiHandler(event.type, event.uiEvent);
+                        }
+                        break;
+                    case Event::Type::ANIMATION_START:
+                    case Event::Type::ANIMATION_RESET:
+                    case Event::Type::ANIMATION_FINISH:
+                        if (eventHandler->animationHandler)
+                        {
+                            propagate = eventHandler->animationHandler(event.type, event.animationEvent);
+                        }
+                        break;
+                    case Event::Type::SOUND_START:
+                    case Event::Type::SOUND_RESET:
+                    case Event::Type::SOUND_FINISH:
+                        if (eventHandler->soundHandler)
+                        {
+                            propagate = eventHandler->soundHandler(event.type, event.soundEvent);
+                        }
+                        break;
+                    case Event::Type::USER:
+                        if (eventHandler->userHandler)
+                        {
+                            propagate = eventHandler->userHandler(event.type, event.userEvent);
+                        }
+                        break;
                 }
             }
-
-            if (!propagate)
-            {
-                break;
-            }
         }
+
+        return propagate;
     }
 
     void EventDispatcher::addEventHandler(EventHandler* eventHandler)
@@ -219,8 +228,6 @@ namespace ouzel
 
     void EventDispatcher::postEvent(const Event& event)
     {
-        Lock lock(eventQueueMutex);
-
         eventQueue.push(event);
     }
 }
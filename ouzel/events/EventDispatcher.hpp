@@ -4,11 +4,11 @@
 #pragma once
 
 #include <vector>
-#include <queue>
 #include <set>
 #include <cstdint>
 #include "events/Event.hpp"
 #include "events/EventHandler.hpp"
+#include "thread/MPSCQueue.hpp"
 
 namespace ouzel
 {
@@ -34,11 +34,14 @@ namespace ouzel
     protected:
         EventDispatcher();
 
+        // returns false if the remaining events should be dispatched in the next call to dispatchEvents
+        bool dispatchEvent(const Event& event);
+
         std::vector<EventHandler*> eventHandlers;
         std::set<EventHandler*> eventHandlerAddSet;
         std::set<EventHandler*> eventHandlerDeleteSet;
 
-        Mutex eventQueueMutex;
-        std::queue<Event> eventQueue;
+        MPSCQueue<Event> eventQueue;
+        std::vector<Event> deferredEvents; // taken from the queue, but not dispatched yet
     };
 }
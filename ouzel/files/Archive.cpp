@@ -1,11 +1,14 @@
 // Copyright (C) 2018 Elviss Strazdins
 // This file is part of the Ouzel engine.
 
+#include <algorithm>
+#include <climits>
 #include "Archive.hpp"
 #include "FileSystem.hpp"
 #include "core/Engine.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
+#include "stb_image.h"
 
 namespace ouzel
 {
@@ -19,131 +22,299 @@ namespace ouzel
         if (fileSystem) fileSystem->removeArchive(this);
     }
 
+    static const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    static const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    static const uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+    static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+    static const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+    static const uint16_t ZIP64_EXTRA_FIELD = 0x0001;
+
+    static const uint32_t LOCAL_HEADER_SIZE = 30;
+    static const uint32_t CENTRAL_HEADER_SIZE = 46;
+    static const uint32_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    static const uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE = 56;
+    static const uint32_t ZIP64_LOCATOR_SIZE = 20;
+    static const uint32_t MAX_COMMENT_SIZE = 0xFFFF;
+    static const uint64_t MAX_DEFLATE_RATIO = 1032; // the best compression ratio Deflate can achieve
+
+    // File::readAt takes 32-bit sizes
+    static bool readData(const File& file, uint8_t* buffer, uint64_t size, uint64_t offset)
+    {
+        while (size > 0)
+        {
+            uint32_t chunkSize = static_cast<uint32_t>(std::min(size, static_cast<uint64_t>(0x40000000)));
+            if (!file.readAt(buffer, chunkSize, offset)) return false;
+            buffer += chunkSize;
+            offset += chunkSize;
+            size -= chunkSize;
+        }
+
+        return true;
+    }
+
     bool Archive::open(const std::string& filename)
     {
-        if (!file.open(engine->getFileSystem()->getPath(filename, false), File::READ))
+        path = engine->getFileSystem()->getPath(filename, false);
+
+        if (!file.open(path, File::READ))
         {
             Log(Log::Level::ERR) << "Failed to open file " << filename;
             return false;
         }
 
-        for (;;)
+        fileSize = file.getSize();
+
+        // the end of central directory record is followed only by the comment, read them together with the ZIP64 locator
+        uint64_t tailSize = std::min(fileSize, static_cast<uint64_t>(ZIP64_LOCATOR_SIZE + END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_SIZE));
+        uint64_t tailOffset = fileSize - tailSize;
+        std::vector<uint8_t> tail(static_cast<size_t>(tailSize));
+
+        if (!readData(file, tail.data(), tailSize, tailOffset))
         {
-            uint32_t signature;
+            Log(Log::Level::ERR) << "Failed to read end of central directory";
+            return false;
+        }
 
-            if (!file.read(&signature, sizeof(signature)))
-            {
-                Log(Log::Level::ERR) << "Failed to read signature";
-                return false;
-            }
+        if (tailSize < END_OF_CENTRAL_DIRECTORY_SIZE)
+        {
+            Log(Log::Level::ERR) << "Failed to find end of central directory";
+            return false;
+        }
 
-            if (decodeUInt32Little(&signature) == 0x02014b50) // central directory
-            {
-                break;
-            }
+        uint32_t end = static_cast<uint32_t>(tailSize - END_OF_CENTRAL_DIRECTORY_SIZE);
 
-            if (decodeUInt32Little(&signature) != 0x04034b50)
+        for (;;)
+        {
+            if (decodeUInt32Little(tail.data() + end) == END_OF_CENTRAL_DIRECTORY_SIGNATURE) break;
+
+            if (end == 0)
             {
-                Log(Log::Level::ERR) << "Bad signature";
+                Log(Log::Level::ERR) << "Failed to find end of central directory";
                 return false;
             }
 
-            uint8_t version[2];
+            --end;
+        }
 
-            if (!file.read(version, sizeof(version)))
+        uint64_t entryCount = decodeUInt16Little(tail.data() + end + 10);
+        uint64_t centralDirectorySize = decodeUInt32Little(tail.data() + end + 12);
+        uint64_t centralDirectoryOffset = decodeUInt32Little(tail.data() + end + 16);
+
+        if (entryCount == 0xFFFF || centralDirectorySize == 0xFFFFFFFF || centralDirectoryOffset == 0xFFFFFFFF)
+        {
+            if (end < ZIP64_LOCATOR_SIZE ||
+                decodeUInt32Little(tail.data() + end - ZIP64_LOCATOR_SIZE) != ZIP64_LOCATOR_SIGNATURE)
             {
-                Log(Log::Level::ERR) << "Failed to read version";
+                Log(Log::Level::ERR) << "Failed to find ZIP64 end of central directory locator";
                 return false;
             }
 
-            uint16_t flags;
+            uint64_t zip64EndOffset = decodeUInt64Little(tail.data() + end - ZIP64_LOCATOR_SIZE + 8);
+            uint8_t zip64End[ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE];
 
-            if (!file.read(&flags, sizeof(flags)))
+            if (!file.readAt(zip64End, sizeof(zip64End), zip64EndOffset))
             {
-                Log(Log::Level::ERR) << "Failed to read flags";
+                Log(Log::Level::ERR) << "Failed to read ZIP64 end of central directory";
                 return false;
             }
 
-            uint16_t compression;
-            if (!file.read(&compression, sizeof(compression)))
+            if (decodeUInt32Little(zip64End) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE)
             {
-                Log(Log::Level::ERR) << "Failed to read compression";
+                Log(Log::Level::ERR) << "Bad ZIP64 end of central directory signature";
                 return false;
             }
 
-            if (compression != 0x00)
-            {
-                Log(Log::Level::ERR) << "Unsupported compression";
-                return false;
-            }
+            entryCount = decodeUInt64Little(zip64End + 32);
+            centralDirectorySize = decodeUInt64Little(zip64End + 40);
+            centralDirectoryOffset = decodeUInt64Little(zip64End + 48);
+        }
+
+        if (centralDirectorySize > fileSize || centralDirectoryOffset > fileSize - centralDirectorySize)
+        {
+            Log(Log::Level::ERR) << "Invalid central directory";
+            return false;
+        }
 
-            if (!file.seek(4, File::CURRENT))
+        // the whole central directory is read at once
+        std::vector<uint8_t> centralDirectory(static_cast<size_t>(centralDirectorySize));
+
+        if (!readData(file, centralDirectory.data(), centralDirectorySize, centralDirectoryOffset))
+        {
+            Log(Log::Level::ERR) << "Failed to read central directory";
+            return false;
+        }
+
+        size_t offset = 0;
+
+        for (uint64_t i = 0; i < entryCount; ++i)
+        {
+            if (centralDirectory.size() - offset < CENTRAL_HEADER_SIZE ||
+                decodeUInt32Little(centralDirectory.data() + offset) != CENTRAL_HEADER_SIGNATURE)
             {
-                Log(Log::Level::ERR) << "Failed to skip file modification time";
+                Log(Log::Level::ERR) << "Bad central directory file header";
                 return false;
             }
 
-            if (!file.seek(4, File::CURRENT))
+            const uint8_t* header = centralDirectory.data() + offset;
+
+            uint16_t flags = decodeUInt16Little(header + 8);
+            uint16_t compression = decodeUInt16Little(header + 10);
+            uint64_t compressedSize = decodeUInt32Little(header + 20);
+            uint64_t size = decodeUInt32Little(header + 24);
+            uint16_t fileNameLength = decodeUInt16Little(header + 28);
+            uint16_t extraFieldLength = decodeUInt16Little(header + 30);
+            uint16_t commentLength = decodeUInt16Little(header + 32);
+            uint64_t headerOffset = decodeUInt32Little(header + 42);
+
+            if (centralDirectory.size() - offset < CENTRAL_HEADER_SIZE + fileNameLength + extraFieldLength + commentLength)
             {
-                Log(Log::Level::ERR) << "Failed to skip CRC-32";
+                Log(Log::Level::ERR) << "Bad central directory file header";
                 return false;
             }
 
-            uint32_t compressedSize;
-            if (!file.read(&compressedSize, sizeof(compressedSize)))
+            std::string name(reinterpret_cast<const char*>(header + CENTRAL_HEADER_SIZE), fileNameLength);
+
+            // the ZIP64 extra field contains only the values that don't fit in the header
+            const uint8_t* extraField = header + CENTRAL_HEADER_SIZE + fileNameLength;
+
+            for (uint32_t extraOffset = 0; extraOffset + 4 <= extraFieldLength;)
             {
-                Log(Log::Level::ERR) << "Failed to read compressed size";
-                return false;
+                uint16_t id = decodeUInt16Little(extraField + extraOffset);
+                uint16_t length = decodeUInt16Little(extraField + extraOffset + 2);
+                extraOffset += 4;
+
+                if (extraOffset + length > extraFieldLength) break;
+
+                if (id == ZIP64_EXTRA_FIELD)
+                {
+                    const uint8_t* value = extraField + extraOffset;
+                    const uint8_t* valueEnd = value + length;
+
+                    if (size == 0xFFFFFFFF && value + 8 <= valueEnd)
+                    {
+                        size = decodeUInt64Little(value);
+                        value += 8;
+                    }
+
+                    if (compressedSize == 0xFFFFFFFF && value + 8 <= valueEnd)
+                    {
+                        compressedSize = decodeUInt64Little(value);
+                        value += 8;
+                    }
+
+                    if (headerOffset == 0xFFFFFFFF && value + 8 <= valueEnd)
+                    {
+                        headerOffset = decodeUInt64Little(value);
+                        value += 8;
+                    }
+                }
+
+                extraOffset += length;
             }
 
-            uint32_t uncompressedSize;
-            if (!file.read(&uncompressedSize, sizeof(uncompressedSize)))
+            offset += CENTRAL_HEADER_SIZE + fileNameLength + extraFieldLength + commentLength;
+
+            // directories
+            if (!name.empty() && name.back() == '/') continue;
+
+            if (flags & 0x01)
             {
-                Log(Log::Level::ERR) << "Failed to read compressed size";
-                return false;
+                Log(Log::Level::WARN) << "Encrypted file " << name << " is not supported";
+                continue;
             }
 
-            uint16_t fileNameLength;
-            if (!file.read(&fileNameLength, sizeof(fileNameLength)))
+            if (compression != STORED && compression != DEFLATED)
             {
-                Log(Log::Level::ERR) << "Failed to read file name length";
-                return false;
+                Log(Log::Level::WARN) << "Unsupported compression of file " << name;
+                continue;
             }
 
-            uint16_t extraFieldLength;
-            if (!file.read(&extraFieldLength, sizeof(extraFieldLength)))
+            Entry& entry = entries[name];
+            entry.headerOffset = headerOffset;
+            entry.compressedSize = compressedSize;
+            entry.size = size;
+            entry.compression = compression;
+        }
+
+        return true;
+    }
+
+    bool Archive::getDataOffset(const Entry& entry, uint64_t& offset) const
+    {
+        // the extra field of the local header can differ from the one in the central directory
+        uint8_t header[LOCAL_HEADER_SIZE];
+
+        if (!file.readAt(header, sizeof(header), entry.headerOffset))
+        {
+            Log(Log::Level::ERR) << "Failed to read local file header";
+            return false;
+        }
+
+        if (decodeUInt32Little(header) != LOCAL_HEADER_SIGNATURE)
+        {
+            Log(Log::Level::ERR) << "Bad local file header signature";
+            return false;
+        }
+
+        offset = entry.headerOffset + LOCAL_HEADER_SIZE + decodeUInt16Little(header + 26) + decodeUInt16Little(header + 28);
+
+        // the sizes come from the archive, so they are checked before anything is allocated for them
+        if (offset > fileSize || entry.compressedSize > fileSize - offset ||
+            (entry.compression == STORED && entry.size != entry.compressedSize) ||
+            (entry.compression == DEFLATED && entry.size / MAX_DEFLATE_RATIO > entry.compressedSize))
+        {
+            Log(Log::Level::ERR) << "Invalid file entry";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Archive::readFile(const std::string& filename, std::vector<uint8_t>& data) const
+    {
+        auto i = entries.find(filename);
+
+        if (i == entries.end()) return false;
+
+        const Entry& entry = i->second;
+        uint64_t offset;
+
+        if (!getDataOffset(entry, offset)) return false;
+
+        if (entry.compression == DEFLATED)
+        {
+            if (entry.compressedSize > INT_MAX || entry.size > INT_MAX)
             {
-                Log(Log::Level::ERR) << "Failed to read compression";
+                Log(Log::Level::ERR) << "Compressed file " << filename << " is too big";
                 return false;
             }
 
-            char* name = new char[decodeUInt16Little(&fileNameLength) + 1];
+            std::vector<uint8_t> compressedData(static_cast<size_t>(entry.compressedSize));
 
-            if (!file.read(name, decodeUInt16Little(&fileNameLength)))
+            if (!readData(file, compressedData.data(), entry.compressedSize, offset))
             {
-                delete[] name;
-                Log(Log::Level::ERR) << "Failed to read file name";
+                Log(Log::Level::ERR) << "Failed to read file";
                 return false;
             }
 
-            name[decodeUInt16Little(&fileNameLength)] = '\0';
+            data.resize(static_cast<size_t>(entry.size));
 
-            Entry& entry = entries[name];
-            entry.size = decodeUInt32Little(&uncompressedSize);
-
-            delete[] name;
+            int size = stbi_zlib_decode_noheader_buffer(reinterpret_cast<char*>(data.data()), static_cast<int>(data.size()),
+                                                        reinterpret_cast<const char*>(compressedData.data()), static_cast<int>(compressedData.size()));
 
-            if (!file.seek(decodeUInt16Little(&extraFieldLength), File::CURRENT))
+            if (size < 0 || static_cast<uint64_t>(size) != entry.size)
             {
-                Log(Log::Level::ERR) << "Failed to skip extra field";
+                Log(Log::Level::ERR) << "Failed to decompress file " << filename;
                 return false;
             }
+        }
+        else
+        {
+            data.resize(static_cast<size_t>(entry.size));
 
-            entry.offset = file.getOffset();
-
-            if (!file.seek(decodeInt32Little(&uncompressedSize), File::CURRENT))
+            if (!readData(file, data.data(), entry.size, offset))
             {
-                Log(Log::Level::ERR) << "Failed to skip extra field";
+                Log(Log::Level::ERR) << "Failed to read file";
                 return false;
             }
         }
@@ -151,29 +322,62 @@ namespace ouzel
         return true;
     }
 
-    bool Archive::readFile(const std::string& filename, std::vector<uint8_t>& data) const
+    bool Archive::openFile(const std::string& filename, File& entryFile, uint64_t& offset, uint64_t& size) const
     {
         auto i = entries.find(filename);
 
         if (i == entries.end()) return false;
 
-        if (!file.seek(static_cast<int32_t>(i->second.offset), File::BEGIN))
+        const Entry& entry = i->second;
+
+        if (entry.compression != STORED)
         {
-            Log(Log::Level::ERR) << "Failed to seek file";
+            Log(Log::Level::ERR) << "Compressed file " << filename << " can not be read in parts";
             return false;
         }
 
-        data.resize(i->second.size);
+        if (!getDataOffset(entry, offset)) return false;
 
-        if (!file.read(data.data(), i->second.size))
+        if (!entryFile.open(path, File::READ))
         {
-            Log(Log::Level::ERR) << "Failed to read file";
+            Log(Log::Level::ERR) << "Failed to open file " << path;
             return false;
         }
 
+        if (!entryFile.seek(static_cast<int64_t>(offset), File::BEGIN))
+        {
+            Log(Log::Level::ERR) << "Failed to seek file";
+            return false;
+        }
+
+        size = entry.size;
+
         return true;
     }
 
+    bool Archive::mapFile(const std::string& filename, FileMapping& mapping) const
+    {
+        auto i = entries.find(filename);
+
+        if (i == entries.end()) return false;
+
+        const Entry& entry = i->second;
+
+        if (entry.compression != STORED)
+        {
+            std::vector<uint8_t> data;
+            if (!readFile(filename, data)) return false;
+
+            mapping.setData(std::move(data));
+            return true;
+        }
+
+        uint64_t offset;
+        if (!getDataOffset(entry, offset)) return false;
+
+        return mapping.map(file, offset, entry.size);
+    }
+
     bool Archive::fileExists(const std::string& filename) const
     {
         return entries.find(filename) != entries.end();
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include "files/File.hpp"
+#include "files/FileMapping.hpp"
 
 namespace ouzel
 {
@@ -29,20 +30,39 @@ namespace ouzel
 
         bool open(const std::string& filename);
 
+        // can be called from several threads at the same time
         bool readFile(const std::string& filename, std::vector<uint8_t>& data) const;
 
+        // opens a separate handle to the archive, so that the entry can be read in parts, works only for stored entries
+        bool openFile(const std::string& filename, File& entryFile, uint64_t& offset, uint64_t& size) const;
+
+        // maps stored entries into memory, compressed entries are decompressed into the mapping
+        bool mapFile(const std::string& filename, FileMapping& mapping) const;
+
         bool fileExists(const std::string& filename) const;
 
     private:
-        FileSystem* fileSystem = nullptr;
-        File file;
+        enum Compression
+        {
+            STORED = 0,
+            DEFLATED = 8
+        };
 
         struct Entry
         {
-            uint32_t offset;
-            uint32_t size;
+            uint64_t headerOffset; // offset of the local file header
+            uint64_t compressedSize;
+            uint64_t size;
+            uint16_t compression;
         };
 
+        bool getDataOffset(const Entry& entry, uint64_t& offset) const;
+
+        FileSystem* fileSystem = nullptr;
+        std::string path;
+        File file;
+        uint64_t fileSize = 0;
+
         std::map<std::string, Entry> entries;
     };
 }
@@ -0,0 +1,40 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ouzel
+{
+    // Read-only view of bytes owned by someone else (a vector or a FileMapping), it must not outlive the owner.
+    // It has the same accessors as a const std::vector<uint8_t>, so the parsers can take either.
+    class DataView final
+    {
+    public:
+        DataView() {}
+        DataView(const uint8_t* initData, size_t initSize):
+            bytes(initData), length(initSize)
+        {
+        }
+        DataView(const std::vector<uint8_t>& vector):
+            bytes(vector.data()), length(vector.size())
+        {
+        }
+
+        inline const uint8_t* data() const { return bytes; }
+        inline size_t size() const { return length; }
+        inline bool empty() const { return length == 0; }
+
+        inline const uint8_t* begin() const { return bytes; }
+        inline const uint8_t* end() const { return bytes + length; }
+
+        inline const uint8_t& operator[](size_t index) const { return bytes[index]; }
+
+    private:
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+    };
+}
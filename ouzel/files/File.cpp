@@ -6,6 +6,7 @@
 #if OUZEL_PLATFORM_WINDOWS
 #else
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 #include "File.hpp"
@@ -119,6 +120,44 @@ namespace ouzel
 #endif
     }
 
+    bool File::readAt(void* buffer, uint32_t size, uint64_t offset) const
+    {
+        uint8_t* dest = static_cast<uint8_t*>(buffer);
+        uint32_t bytesRead;
+
+        for (; size > 0; size -= bytesRead, dest += bytesRead, offset += bytesRead)
+        {
+            if (!readAt(dest, size, offset, bytesRead)) return false;
+            if (bytesRead == 0) return false;
+        }
+
+        return true;
+    }
+
+    bool File::readAt(void* buffer, uint32_t size, uint64_t offset, uint32_t& bytesRead) const
+    {
+#if OUZEL_PLATFORM_WINDOWS
+        if (file == INVALID_HANDLE_VALUE) return false;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD n;
+        BOOL ret = ReadFile(file, buffer, size, &n, &overlapped);
+        if (!ret && GetLastError() == ERROR_HANDLE_EOF)
+        {
+            bytesRead = 0;
+            return true;
+        }
+        bytesRead = static_cast<uint32_t>(n);
+        return ret != 0;
+#else
+        if (fd == -1) return false;
+        ssize_t ret = ::pread(fd, buffer, size, static_cast<off_t>(offset));
+        bytesRead = static_cast<uint32_t>(ret);
+        return ret != -1;
+#endif
+    }
+
     bool File::write(const void* buffer, uint32_t size) const
     {
         const uint8_t* src = static_cast<const uint8_t*>(buffer);
@@ -149,7 +188,7 @@ namespace ouzel
 #endif
     }
 
-    bool File::seek(int32_t offset, int method) const
+    bool File::seek(int64_t offset, int method) const
     {
 #if OUZEL_PLATFORM_WINDOWS
         if (file == INVALID_HANDLE_VALUE) return false;
@@ -157,28 +196,48 @@ namespace ouzel
         if (method == BEGIN) moveMethod = FILE_BEGIN;
         else if (method == CURRENT) moveMethod = FILE_CURRENT;
         else if (method == END) moveMethod = FILE_END;
-        return SetFilePointer(file, offset, nullptr, moveMethod) != 0;
+        LARGE_INTEGER distance;
+        distance.QuadPart = offset;
+        return SetFilePointerEx(file, distance, nullptr, moveMethod) != 0;
 #else
         if (fd == -1) return false;
         int whence = 0;
         if (method == BEGIN) whence = SEEK_SET;
         else if (method == CURRENT) whence = SEEK_CUR;
         else if (method == END) whence = SEEK_END;
-        return lseek(fd, offset, whence) != -1;
+        return lseek(fd, static_cast<off_t>(offset), whence) != -1;
 #endif
     }
 
-    uint32_t File::getOffset() const
+    uint64_t File::getOffset() const
     {
 #if OUZEL_PLATFORM_WINDOWS
         if (file == INVALID_HANDLE_VALUE) return 0;
-        DWORD ret = SetFilePointer(file, 0, nullptr, FILE_CURRENT);
-        return static_cast<uint32_t>(ret);
+        LARGE_INTEGER distance;
+        distance.QuadPart = 0;
+        LARGE_INTEGER position;
+        if (!SetFilePointerEx(file, distance, &position, FILE_CURRENT)) return 0;
+        return static_cast<uint64_t>(position.QuadPart);
 #else
         if (fd == -1) return 0;
         off_t ret = lseek(fd, 0, SEEK_CUR);
         if (ret == -1) return 0;
-        return static_cast<uint32_t>(ret);
+        return static_cast<uint64_t>(ret);
+#endif
+    }
+
+    uint64_t File::getSize() const
+    {
+#if OUZEL_PLATFORM_WINDOWS
+        if (file == INVALID_HANDLE_VALUE) return 0;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) return 0;
+        return static_cast<uint64_t>(size.QuadPart);
+#else
+        if (fd == -1) return 0;
+        struct stat buf;
+        if (fstat(fd, &buf) == -1) return 0;
+        return static_cast<uint64_t>(buf.st_size);
 #endif
     }
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #if OUZEL_PLATFORM_WINDOWS
@@ -15,8 +16,11 @@
 
 namespace ouzel
 {
+    class FileMapping;
+
     class File
     {
+        friend FileMapping;
     public:
         enum Mode
         {
@@ -57,10 +61,14 @@ namespace ouzel
 
         bool read(void* buffer, uint32_t size) const;
         bool read(void* buffer, uint32_t size, uint32_t& bytesRead) const;
+        // reads from the given offset without using the file position, so several threads can read the same file
+        bool readAt(void* buffer, uint32_t size, uint64_t offset) const;
+        bool readAt(void* buffer, uint32_t size, uint64_t offset, uint32_t& bytesRead) const;
         bool write(const void* buffer, uint32_t size) const;
         bool write(const void* buffer, uint32_t size, uint32_t& bytesWritten) const;
-        bool seek(int32_t offset, int method) const;
-        uint32_t getOffset() const;
+        bool seek(int64_t offset, int method) const;
+        uint64_t getOffset() const;
+        uint64_t getSize() const;
 
     protected:
 #if OUZEL_PLATFORM_WINDOWS
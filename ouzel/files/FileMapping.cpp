@@ -0,0 +1,153 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "core/Setup.h"
+#include <limits>
+#if !OUZEL_PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "FileMapping.hpp"
+#include "File.hpp"
+#include "utils/Log.hpp"
+
+namespace ouzel
+{
+    FileMapping::~FileMapping()
+    {
+        unmap();
+    }
+
+    FileMapping::FileMapping(FileMapping&& other):
+        address(other.address),
+        mappedSize(other.mappedSize),
+        buffer(std::move(other.buffer)),
+        bytes(other.bytes),
+        length(other.length)
+    {
+        other.address = nullptr;
+        other.mappedSize = 0;
+        other.bytes = nullptr;
+        other.length = 0;
+    }
+
+    FileMapping& FileMapping::operator=(FileMapping&& other)
+    {
+        if (&other != this)
+        {
+            unmap();
+
+            address = other.address;
+            mappedSize = other.mappedSize;
+            buffer = std::move(other.buffer);
+            bytes = other.bytes;
+            length = other.length;
+
+            other.address = nullptr;
+            other.mappedSize = 0;
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+
+        return *this;
+    }
+
+    bool FileMapping::map(const File& file, uint64_t offset, uint64_t size)
+    {
+        unmap();
+
+        if (size == 0) return true;
+
+        if (size > std::numeric_limits<size_t>::max())
+        {
+            Log(Log::Level::ERR) << "File is too big to be mapped";
+            return false;
+        }
+
+        // touching pages past the end of the file would crash instead of failing
+        if (offset > file.getSize() || size > file.getSize() - offset)
+        {
+            Log(Log::Level::ERR) << "Mapped range is outside of the file";
+            return false;
+        }
+
+#if OUZEL_PLATFORM_WINDOWS
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+
+        // the view has to start at a multiple of the allocation granularity
+        uint64_t alignedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+        uint64_t viewSize = size + (offset - alignedOffset);
+
+        HANDLE mapping = CreateFileMappingW(file.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            Log(Log::Level::ERR) << "Failed to create file mapping";
+            return false;
+        }
+
+        address = MapViewOfFile(mapping, FILE_MAP_READ,
+                                static_cast<DWORD>(alignedOffset >> 32),
+                                static_cast<DWORD>(alignedOffset & 0xFFFFFFFF),
+                                static_cast<SIZE_T>(viewSize));
+
+        // the view keeps the mapping object alive
+        CloseHandle(mapping);
+
+        if (!address)
+        {
+            Log(Log::Level::ERR) << "Failed to map view of file";
+            return false;
+        }
+#else
+        static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+        // the mapping has to start at a page boundary
+        uint64_t alignedOffset = offset - offset % pageSize;
+        uint64_t viewSize = size + (offset - alignedOffset);
+
+        void* result = mmap(nullptr, static_cast<size_t>(viewSize), PROT_READ, MAP_PRIVATE, file.fd, static_cast<off_t>(alignedOffset));
+
+        if (result == MAP_FAILED)
+        {
+            Log(Log::Level::ERR) << "Failed to map file";
+            return false;
+        }
+
+        address = result;
+#endif
+
+        mappedSize = static_cast<size_t>(viewSize);
+        bytes = static_cast<const uint8_t*>(address) + (offset - alignedOffset);
+        length = static_cast<size_t>(size);
+
+        return true;
+    }
+
+    void FileMapping::setData(std::vector<uint8_t>&& newData)
+    {
+        unmap();
+
+        buffer = std::move(newData);
+        bytes = buffer.data();
+        length = buffer.size();
+    }
+
+    void FileMapping::unmap()
+    {
+        if (address)
+        {
+#if OUZEL_PLATFORM_WINDOWS
+            UnmapViewOfFile(address);
+#else
+            munmap(address, mappedSize);
+#endif
+            address = nullptr;
+            mappedSize = 0;
+        }
+
+        buffer = std::vector<uint8_t>();
+        bytes = nullptr;
+        length = 0;
+    }
+}
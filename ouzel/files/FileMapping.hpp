@@ -0,0 +1,44 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "files/DataView.hpp"
+
+namespace ouzel
+{
+    class File;
+
+    // Maps a part of a file into memory read-only. The mapping stays valid after the file is closed.
+    // Data that can't be mapped (compressed archive entries, files in the Android application package)
+    // can be stored in the mapping instead, so that the users don't have to care where the bytes live.
+    class FileMapping final
+    {
+    public:
+        FileMapping() {}
+        ~FileMapping();
+
+        FileMapping(const FileMapping&) = delete;
+        FileMapping& operator=(const FileMapping&) = delete;
+
+        FileMapping(FileMapping&& other);
+        FileMapping& operator=(FileMapping&& other);
+
+        bool map(const File& file, uint64_t offset, uint64_t size);
+        void setData(std::vector<uint8_t>&& newData);
+        void unmap();
+
+        inline bool isMapped() const { return address != nullptr; }
+        inline DataView getData() const { return DataView(bytes, length); }
+
+    private:
+        void* address = nullptr; // start of the mapped pages
+        size_t mappedSize = 0;
+        std::vector<uint8_t> buffer;
+
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+    };
+}
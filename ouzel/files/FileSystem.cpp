@@ -24,6 +24,9 @@ extern "C" id NSTemporaryDirectory();
 
 #include "FileSystem.hpp"
 #include "Archive.hpp"
+#include "File.hpp"
+#include "FileMapping.hpp"
+#include "thread/Lock.hpp"
 #include "utils/Log.hpp"
 
 #if OUZEL_PLATFORM_WINDOWS || OUZEL_PLATFORM_LINUX || OUZEL_PLATFORM_RASPBIAN
@@ -255,7 +258,9 @@ namespace ouzel
 
         if (searchResources)
         {
-            for (const auto& archive : archives)
+            std::vector<Archive*> searchArchives = getArchives();
+
+            for (Archive* archive : searchArchives)
             {
                 if (archive->readFile(filename, data))
                 {
@@ -273,19 +278,127 @@ namespace ouzel
             return false;
         }
 
-        std::ifstream file(path, std::ios::binary);
+        File file;
 
-        if (!file)
+        if (!file.open(path, File::READ))
+        {
+            Log(Log::Level::ERR) << "Failed to open file " << path;
+            return false;
+        }
+
+        uint64_t size = file.getSize();
+        data.resize(static_cast<size_t>(size));
+
+        // File::readAt takes 32-bit sizes
+        for (uint64_t offset = 0; offset < size;)
+        {
+            uint32_t chunkSize = static_cast<uint32_t>(std::min(size - offset, static_cast<uint64_t>(0x40000000)));
+
+            if (!file.readAt(data.data() + offset, chunkSize, offset))
+            {
+                Log(Log::Level::ERR) << "Failed to read file " << path;
+                return false;
+            }
+
+            offset += chunkSize;
+        }
+
+        return true;
+    }
+
+    bool FileSystem::mapFile(const std::string& filename, FileMapping& mapping, bool searchResources) const
+    {
+#if OUZEL_PLATFORM_ANDROID
+        // files in the application package are read from the asset manager
+        if (!isAbsolutePath(filename))
+        {
+            std::vector<uint8_t> data;
+            if (!readFile(filename, data, searchResources)) return false;
+
+            mapping.setData(std::move(data));
+            return true;
+        }
+#endif
+
+        if (searchResources)
+        {
+            std::vector<Archive*> searchArchives = getArchives();
+
+            for (Archive* archive : searchArchives)
+            {
+                if (archive->mapFile(filename, mapping))
+                {
+                    return true;
+                }
+            }
+        }
+
+        std::string path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.empty())
+        {
+            Log(Log::Level::ERR) << "Failed to find file " << filename;
+            return false;
+        }
+
+        File file;
+
+        if (!file.open(path, File::READ))
+        {
+            Log(Log::Level::ERR) << "Failed to open file " << path;
+            return false;
+        }
+
+        if (!mapping.map(file, 0, file.getSize()))
+        {
+            Log(Log::Level::ERR) << "Failed to map file " << path;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool FileSystem::openFile(const std::string& filename, File& file, uint64_t& offset, uint64_t& size, bool searchResources) const
+    {
+#if OUZEL_PLATFORM_ANDROID
+        if (!isAbsolutePath(filename))
+        {
+            Log(Log::Level::ERR) << "Files in the application package can not be read in parts, file: " << filename;
+            return false;
+        }
+#endif
+
+        if (searchResources)
+        {
+            std::vector<Archive*> searchArchives = getArchives();
+
+            for (Archive* archive : searchArchives)
+            {
+                if (archive->openFile(filename, file, offset, size))
+                {
+                    return true;
+                }
+            }
+        }
+
+        std::string path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.empty())
+        {
+            Log(Log::Level::ERR) << "Failed to find file " << filename;
+            return false;
+        }
+
+        if (!file.open(path, File::READ))
         {
             Log(Log::Level::ERR) << "Failed to open file " << path;
             return false;
         }
 
-        std::streampos start = file.tellg();
-        file.seekg(0, std::ios::end);
-        data.resize(static_cast<size_t>(file.tellg() - start));
-        file.seekg(0, std::ios_base::beg);
-        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        offset = 0;
+        size = file.getSize();
 
         return true;
     }
@@ -439,10 +552,18 @@ namespace ouzel
         }
     }
 
+    std::vector<Archive*> FileSystem::getArchives() const
+    {
+        Lock lock(archiveMutex);
+        return archives;
+    }
+
     void FileSystem::addArchive(Archive* archive)
     {
         if (archive->fileSystem) archive->fileSystem->removeArchive(archive);
 
+        Lock lock(archiveMutex);
+
         auto i = std::find(archives.begin(), archives.end(), archive);
 
         if (i == archives.end())
@@ -454,6 +575,8 @@ namespace ouzel
 
     void FileSystem::removeArchive(Archive* archive)
     {
+        Lock lock(archiveMutex);
+
         auto i = std::find(archives.begin(), archives.end(), archive);
 
         if (i != archives.end())
@@ -6,11 +6,14 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "thread/Mutex.hpp"
 
 namespace ouzel
 {
     class Engine;
     class Archive;
+    class File;
+    class FileMapping;
 
     class FileSystem final
     {
@@ -30,11 +33,18 @@ namespace ouzel
         std::string getTempDirectory() const;
 
         bool readFile(const std::string& filename, std::vector<uint8_t>& data, bool searchResources = true) const;
+        // maps the file into memory when possible instead of copying it
+        bool mapFile(const std::string& filename, FileMapping& mapping, bool searchResources = true) const;
         bool writeFile(const std::string& filename, const std::vector<uint8_t>& data) const;
 
+        // opens a read handle for reading the file in parts, the data is size bytes starting at offset
+        bool openFile(const std::string& filename, File& file, uint64_t& offset, uint64_t& size, bool searchResources = true) const;
+
         bool resourceFileExists(const std::string& filename) const;
         std::string getPath(const std::string& filename, bool searchResources = true) const;
         void addResourcePath(const std::string& path);
+        // the files can be read on other threads while the archives are added or removed, but an archive must not be
+        // removed while a file is being read from it
         void addArchive(Archive* archive);
         void removeArchive(Archive* archive);
 
@@ -49,8 +59,12 @@ namespace ouzel
     protected:
         FileSystem();
 
+        // copy of the archive list that can be searched without holding the mutex
+        std::vector<Archive*> getArchives() const;
+
         std::string appPath;
         std::vector<std::string> resourcePaths;
+        mutable Mutex archiveMutex;
         std::vector<Archive*> archives;
     };
 }
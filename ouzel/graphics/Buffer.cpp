@@ -6,6 +6,7 @@
 #include "Renderer.hpp"
 #include "RenderDevice.hpp"
 #include "core/Engine.hpp"
+#include "utils/Log.hpp"
 
 namespace ouzel
 {
@@ -59,15 +60,54 @@ namespace ouzel
 
         bool Buffer::setData(const void* newData, uint32_t newSize)
         {
-            return setData(std::vector<uint8_t>(static_cast<const uint8_t*>(newData),
-                                                static_cast<const uint8_t*>(newData) + newSize));
+            std::vector<uint8_t>* stagingData = resource->acquireStagingData();
+            stagingData->assign(static_cast<const uint8_t*>(newData),
+                                static_cast<const uint8_t*>(newData) + newSize);
+
+            engine->getRenderer()->executeOnRenderThread(std::bind(&BufferResource::setStagingData,
+                                                                         resource,
+                                                                         stagingData));
+
+            return true;
         }
 
         bool Buffer::setData(const std::vector<uint8_t>& newData)
         {
-            engine->getRenderer()->executeOnRenderThread(std::bind(&BufferResource::setData,
+            return setData(newData.data(), static_cast<uint32_t>(newData.size()));
+        }
+
+        void* Buffer::map(uint32_t newSize)
+        {
+            if (!(flags & DYNAMIC))
+            {
+                Log(Log::Level::ERR) << "Only dynamic buffers can be mapped";
+                return nullptr;
+            }
+
+            if (mappedData)
+            {
+                Log(Log::Level::ERR) << "Buffer is already mapped";
+                return nullptr;
+            }
+
+            mappedData = resource->acquireStagingData();
+            mappedData->resize(newSize);
+
+            return mappedData->data();
+        }
+
+        bool Buffer::unmap()
+        {
+            if (!mappedData)
+            {
+                Log(Log::Level::ERR) << "Buffer is not mapped";
+                return false;
+            }
+
+            engine->getRenderer()->executeOnRenderThread(std::bind(&BufferResource::setStagingData,
                                                                          resource,
-                                                                         newData));
+                                                                         mappedData));
+            mappedData = nullptr;
 
             return true;
         }
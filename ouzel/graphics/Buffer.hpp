@@ -43,6 +43,11 @@ namespace ouzel
             bool setData(const void* newData, uint32_t newSize);
             bool setData(const std::vector<uint8_t>& newData);
 
+            // returns memory for newSize bytes of dynamic buffer data that unmap hands over to the render thread without copying,
+            // the previous contents of the memory are undefined
+            void* map(uint32_t newSize);
+            bool unmap();
+
             inline BufferResource* getResource() const { return resource; }
 
             inline uint32_t getFlags() const { return flags; }
@@ -53,6 +58,8 @@ namespace ouzel
 
             Buffer::Usage usage;
             uint32_t flags = 0;
+
+            std::vector<uint8_t>* mappedData = nullptr;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -2,6 +2,7 @@
 // This file is part of the Ouzel engine.
 
 #include "BufferResource.hpp"
+#include "thread/Lock.hpp"
 
 namespace ouzel
 {
@@ -40,9 +41,42 @@ namespace ouzel
                 return false;
             }
 
-            data = newData;
+            // staging data has already been swapped in
+            if (&newData != &data) data = newData;
 
             return true;
         }
+
+        std::vector<uint8_t>* BufferResource::acquireStagingData()
+        {
+            Lock lock(stagingMutex);
+
+            if (freeStagingData.empty())
+            {
+                stagingData.push_back(std::unique_ptr<std::vector<uint8_t>>(new std::vector<uint8_t>()));
+                return stagingData.back().get();
+            }
+
+            std::vector<uint8_t>* result = freeStagingData.back();
+            freeStagingData.pop_back();
+
+            return result;
+        }
+
+        bool BufferResource::setStagingData(std::vector<uint8_t>* newStagingData)
+        {
+            bool result = false;
+
+            if (flags & Buffer::DYNAMIC)
+            {
+                data.swap(*newStagingData);
+                result = setData(data);
+            }
+
+            Lock lock(stagingMutex);
+            freeStagingData.push_back(newStagingData);
+
+            return result;
+        }
     } // namespace graphics
 } // namespace ouzel
@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include "graphics/RenderResource.hpp"
 #include "graphics/Buffer.hpp"
+#include "thread/Mutex.hpp"
 
 namespace ouzel
 {
@@ -24,6 +26,11 @@ namespace ouzel
 
             virtual bool setData(const std::vector<uint8_t>& newData);
 
+            // staging buffers are filled on the game thread and swapped with the data on the render thread,
+            // after which they are reused
+            std::vector<uint8_t>* acquireStagingData();
+            bool setStagingData(std::vector<uint8_t>* newStagingData);
+
             inline uint32_t getFlags() const { return flags; }
             inline Buffer::Usage getUsage() const { return usage; }
             inline uint32_t getSize() const { return static_cast<uint32_t>(data.size()); }
@@ -34,6 +41,10 @@ namespace ouzel
             std::vector<uint8_t> data;
             Buffer::Usage usage;
             uint32_t flags = 0;
+
+            Mutex stagingMutex;
+            std::vector<std::unique_ptr<std::vector<uint8_t>>> stagingData;
+            std::vector<std::vector<uint8_t>*> freeStagingData;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -5,6 +5,7 @@
 #include "utils/Log.hpp"
 #include "core/Engine.hpp"
 #include "files/FileSystem.hpp"
+#include "files/FileMapping.hpp"
 #define STBI_NO_PSD
 #define STBI_NO_HDR
 #define STBI_NO_PIC
@@ -22,16 +23,16 @@ namespace ouzel
         bool ImageDataSTB::init(const std::string& filename,
                                 PixelFormat newPixelFormat)
         {
-            std::vector<uint8_t> newData;
-            if (!engine->getFileSystem()->readFile(filename, newData))
+            FileMapping mapping;
+            if (!engine->getFileSystem()->mapFile(filename, mapping))
             {
                 return false;
             }
 
-            return init(newData, newPixelFormat);
+            return init(mapping.getData(), newPixelFormat);
         }
 
-        bool ImageDataSTB::init(const std::vector<uint8_t>& newData,
+        bool ImageDataSTB::init(const DataView& newData,
                                 PixelFormat newPixelFormat)
         {
             int width;
@@ -5,6 +5,7 @@
 
 #include <string>
 #include "graphics/ImageData.hpp"
+#include "files/DataView.hpp"
 
 namespace ouzel
 {
@@ -15,7 +16,7 @@ namespace ouzel
         public:
             bool init(const std::string& filename,
                       PixelFormat newPixelFormat = PixelFormat::RGBA8_UNORM);
-            bool init(const std::vector<uint8_t>& newData,
+            bool init(const DataView& newData,
                       PixelFormat newPixelFormat = PixelFormat::RGBA8_UNORM);
             bool writeToFile(const std::string& filename);
         };
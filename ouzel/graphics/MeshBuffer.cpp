@@ -77,5 +77,18 @@ namespace ouzel
 
             return true;
         }
+
+        bool MeshBuffer::setInstanceBuffer(const std::shared_ptr<Buffer>& newInstanceBuffer)
+        {
+            instanceBuffer = newInstanceBuffer;
+
+            BufferResource* instanceBufferResource = instanceBuffer ? instanceBuffer->getResource() : nullptr;
+
+            engine->getRenderer()->executeOnRenderThread(std::bind(&MeshBufferResource::setInstanceBuffer,
+                                                                         resource,
+                                                                         instanceBufferResource));
+
+            return true;
+        }
     } // namespace graphics
 } // namespace ouzel
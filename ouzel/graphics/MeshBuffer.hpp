@@ -40,11 +40,16 @@ namespace ouzel
             inline const std::shared_ptr<Buffer>& getVertexBuffer() const { return vertexBuffer; }
             bool setVertexBuffer(const std::shared_ptr<Buffer>& newVertexBuffer);
 
+            // InstanceVertex records, only used by instanced draws
+            inline const std::shared_ptr<Buffer>& getInstanceBuffer() const { return instanceBuffer; }
+            bool setInstanceBuffer(const std::shared_ptr<Buffer>& newInstanceBuffer);
+
         private:
             MeshBufferResource* resource = nullptr;
 
             std::shared_ptr<Buffer> indexBuffer;
             std::shared_ptr<Buffer> vertexBuffer;
+            std::shared_ptr<Buffer> instanceBuffer;
             uint32_t indexSize = 0;
         };
     } // namespace graphics
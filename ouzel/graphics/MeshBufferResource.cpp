@@ -57,5 +57,17 @@ namespace ouzel
 
             return true;
         }
+
+        bool MeshBufferResource::setInstanceBuffer(BufferResource* newInstanceBuffer)
+        {
+            if (newInstanceBuffer && newInstanceBuffer->getUsage() != Buffer::Usage::VERTEX)
+            {
+                return false;
+            }
+
+            instanceBuffer = newInstanceBuffer;
+
+            return true;
+        }
     } // namespace graphics
 } // namespace ouzel
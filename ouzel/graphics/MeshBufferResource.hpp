@@ -31,12 +31,16 @@ namespace ouzel
             inline BufferResource* getVertexBuffer() const { return vertexBuffer; }
             virtual bool setVertexBuffer(BufferResource* newVertexBuffer);
 
+            inline BufferResource* getInstanceBuffer() const { return instanceBuffer; }
+            virtual bool setInstanceBuffer(BufferResource* newInstanceBuffer);
+
         protected:
             MeshBufferResource();
 
             uint32_t indexSize = 0;
             BufferResource* indexBuffer = nullptr;
             BufferResource* vertexBuffer = nullptr;
+            BufferResource* instanceBuffer = nullptr;
         };
     } // namespace graphics
 } // namespace ouzel
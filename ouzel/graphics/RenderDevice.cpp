@@ -16,7 +16,8 @@ namespace ouzel
             renderTargetProjectionTransform(Matrix4::IDENTITY),
             refillQueue(true),
             currentFPS(0.0f),
-            accumulatedFPS(0.0f)
+            accumulatedFPS(0.0f),
+            executeQueue(4096)
         {
         }
 
@@ -71,14 +72,13 @@ namespace ouzel
                 currentAccumulatedFPS = 0.0f;
             }
 
-            std::vector<DrawCommand> drawCommands;
             {
 #if OUZEL_MULTITHREADED
                 Lock lock(drawQueueMutex);
                 while (!queueFinished) queueCondition.wait(drawQueueMutex);
 #endif
 
-                drawCommands = drawQueue;
+                std::swap(drawQueue, renderQueue);
                 drawQueue.clear();
 
                 queueFinished = false;
@@ -97,7 +97,7 @@ namespace ouzel
 
             ++currentFrame;
 
-            if (!draw(drawCommands))
+            if (!draw(renderQueue))
             {
                 return false;
             }
@@ -150,22 +150,69 @@ namespace ouzel
             }
         }
 
-        bool RenderDevice::addDrawCommand(const DrawCommand& drawCommand)
+        bool RenderDevice::addDrawCommand(const DrawCommand& drawCommand,
+                                          const std::vector<std::vector<float>>& pixelShaderConstants,
+                                          const std::vector<std::vector<float>>& vertexShaderConstants)
         {
             Lock lock(drawQueueMutex);
 
-            drawQueue.push_back(drawCommand);
+            recordDrawCommand(drawCommand, pixelShaderConstants, vertexShaderConstants);
 
             return true;
         }
 
+        bool RenderDevice::addBatchDrawCommand(const DrawCommand& drawCommand,
+                                               const std::vector<std::vector<float>>& pixelShaderConstants,
+                                               const std::vector<std::vector<float>>& vertexShaderConstants,
+                                               uint32_t batchedDrawCalls)
+        {
+            Lock lock(drawQueueMutex);
+
+            recordDrawCommand(drawCommand, pixelShaderConstants, vertexShaderConstants);
+            ++queuedBatchCount;
+            queuedBatchedDrawCallCount += batchedDrawCalls;
+
+            return true;
+        }
+
+        void RenderDevice::recordDrawCommand(DrawCommand drawCommand,
+                                             const std::vector<std::vector<float>>& pixelShaderConstants,
+                                             const std::vector<std::vector<float>>& vertexShaderConstants)
+        {
+            drawCommand.pixelShaderConstantStart = static_cast<uint32_t>(drawQueue.shaderConstants.size());
+            drawCommand.pixelShaderConstantCount = static_cast<uint32_t>(pixelShaderConstants.size());
+
+            for (const std::vector<float>& pixelShaderConstant : pixelShaderConstants)
+            {
+                drawQueue.shaderConstants.push_back({static_cast<uint32_t>(drawQueue.constantData.size()),
+                                                     static_cast<uint32_t>(pixelShaderConstant.size())});
+                drawQueue.constantData.insert(drawQueue.constantData.end(), pixelShaderConstant.begin(), pixelShaderConstant.end());
+            }
+
+            drawCommand.vertexShaderConstantStart = static_cast<uint32_t>(drawQueue.shaderConstants.size());
+            drawCommand.vertexShaderConstantCount = static_cast<uint32_t>(vertexShaderConstants.size());
+
+            for (const std::vector<float>& vertexShaderConstant : vertexShaderConstants)
+            {
+                drawQueue.shaderConstants.push_back({static_cast<uint32_t>(drawQueue.constantData.size()),
+                                                     static_cast<uint32_t>(vertexShaderConstant.size())});
+                drawQueue.constantData.insert(drawQueue.constantData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+            }
+
+            drawQueue.drawCommands.push_back(drawCommand);
+        }
+
         void RenderDevice::flushCommands()
         {
             Lock lock(drawQueueMutex);
             refillQueue = false;
 
             queueFinished = true;
-            drawCallCount = static_cast<uint32_t>(drawQueue.size());
+            drawCallCount = static_cast<uint32_t>(drawQueue.drawCommands.size());
+            batchCount = queuedBatchCount;
+            batchedDrawCallCount = queuedBatchedDrawCallCount;
+            queuedBatchCount = 0;
+            queuedBatchedDrawCallCount = 0;
 
 #if OUZEL_MULTITHREADED
             queueCondition.signal();
@@ -177,32 +224,16 @@ namespace ouzel
             return true;
         }
 
-        void RenderDevice::executeOnRenderThread(const std::function<void(void)>& func)
+        void RenderDevice::executeOnRenderThread(SmallFunction func)
         {
-            Lock lock(executeMutex);
-
-            executeQueue.push(func);
+            executeQueue.push(std::move(func));
         }
 
         void RenderDevice::executeAll()
         {
-            std::function<void(void)> func;
-
-            for (;;)
-            {
-                {
-                    Lock lock(executeMutex);
-                    if (executeQueue.empty()) break;
-
-                    func = std::move(executeQueue.front());
-                    executeQueue.pop();
-                }
-
-                if (func)
-                {
-                    func();
-                }
-            }
+            executeQueue.drain([](SmallFunction& func) {
+                if (func) func();
+            });
         }
     } // namespace graphics
 } // namespace ouzel
@@ -13,6 +13,8 @@
 #include "graphics/Texture.hpp"
 #include "thread/Condition.hpp"
 #include "thread/Mutex.hpp"
+#include "thread/MPSCQueue.hpp"
+#include "thread/SmallFunction.hpp"
 
 namespace ouzel
 {
@@ -62,13 +64,16 @@ namespace ouzel
 
             struct DrawCommand
             {
-                std::vector<TextureResource*> textures;
+                TextureResource* textures[Texture::LAYERS];
                 ShaderResource* shader;
-                std::vector<std::vector<float>> pixelShaderConstants;
-                std::vector<std::vector<float>> vertexShaderConstants;
+                uint32_t pixelShaderConstantStart; // index of the first constant in DrawQueue::shaderConstants
+                uint32_t pixelShaderConstantCount;
+                uint32_t vertexShaderConstantStart;
+                uint32_t vertexShaderConstantCount;
                 BlendStateResource* blendState;
                 MeshBufferResource* meshBuffer;
                 uint32_t indexCount;
+                uint32_t instanceCount; // 0 for a draw without instancing
                 Renderer::DrawMode drawMode;
                 uint32_t startIndex;
                 TextureResource* renderTarget;
@@ -81,7 +86,39 @@ namespace ouzel
                 Renderer::CullMode cullMode;
             };
 
-            bool addDrawCommand(const DrawCommand& drawCommand);
+            struct ShaderConstant
+            {
+                uint32_t offset; // in floats
+                uint32_t size;
+            };
+
+            struct DrawQueue
+            {
+                std::vector<DrawCommand> drawCommands;
+                std::vector<ShaderConstant> shaderConstants;
+                std::vector<float> constantData; // linear arena for the shader constants of all draw commands
+
+                void clear()
+                {
+                    // keeps the capacity, so that no allocations happen in steady state
+                    drawCommands.clear();
+                    shaderConstants.clear();
+                    constantData.clear();
+                }
+
+                inline const float* getConstantData(const ShaderConstant& shaderConstant) const
+                {
+                    return constantData.data() + shaderConstant.offset;
+                }
+            };
+
+            bool addDrawCommand(const DrawCommand& drawCommand,
+                                const std::vector<std::vector<float>>& pixelShaderConstants,
+                                const std::vector<std::vector<float>>& vertexShaderConstants);
+            bool addBatchDrawCommand(const DrawCommand& drawCommand,
+                                     const std::vector<std::vector<float>>& pixelShaderConstants,
+                                     const std::vector<std::vector<float>>& vertexShaderConstants,
+                                     uint32_t batchedDrawCalls);
             void flushCommands();
 
             Vector2 convertScreenToNormalizedLocation(const Vector2& position)
@@ -97,6 +134,8 @@ namespace ouzel
             }
 
             inline uint32_t getDrawCallCount() const { return drawCallCount; }
+            inline uint32_t getBatchCount() const { return batchCount; }
+            inline uint32_t getBatchedDrawCallCount() const { return batchedDrawCallCount; }
 
             inline uint16_t getAPIMajorVersion() const { return apiMajorVersion; }
             inline uint16_t getAPIMinorVersion() const { return apiMinorVersion; }
@@ -105,6 +144,8 @@ namespace ouzel
             inline bool isMultisamplingSupported() const { return multisamplingSupported; }
             inline bool isAnisotropicFilteringSupported() const { return anisotropicFilteringSupported; }
             inline bool isRenderTargetsSupported() const { return renderTargetsSupported; }
+            inline bool isUIntIndicesSupported() const { return uintIndicesSupported; }
+            inline bool isInstancingSupported() const { return instancingSupported; }
 
             const Matrix4& getProjectionTransform(bool renderTarget) const
             {
@@ -114,7 +155,7 @@ namespace ouzel
             inline float getFPS() const { return currentFPS; }
             inline float getAccumulatedFPS() const { return accumulatedFPS; }
 
-            void executeOnRenderThread(const std::function<void(void)>& func);
+            void executeOnRenderThread(SmallFunction func);
 
         protected:
             RenderDevice(Renderer::Driver aDriver);
@@ -129,6 +170,9 @@ namespace ouzel
                               bool newDebugRenderer);
 
             void executeAll();
+            void recordDrawCommand(DrawCommand drawCommand,
+                                   const std::vector<std::vector<float>>& pixelShaderConstants,
+                                   const std::vector<std::vector<float>>& vertexShaderConstants);
             virtual void setSize(const Size2& newSize);
 
             virtual BlendStateResource* createBlendState() = 0;
@@ -138,7 +182,7 @@ namespace ouzel
             virtual BufferResource* createBuffer() = 0;
             virtual void deleteResource(RenderResource* resource);
 
-            virtual bool draw(const std::vector<DrawCommand>& drawCommands) = 0;
+            virtual bool draw(const DrawQueue& queue) = 0;
             virtual bool generateScreenshot(const std::string& filename);
 
             Renderer::Driver driver;
@@ -162,6 +206,8 @@ namespace ouzel
             bool multisamplingSupported = true;
             bool anisotropicFilteringSupported = true;
             bool renderTargetsSupported = true;
+            bool uintIndicesSupported = true;
+            bool instancingSupported = false;
 
             Matrix4 projectionTransform;
             Matrix4 renderTargetProjectionTransform;
@@ -177,8 +223,13 @@ namespace ouzel
             std::vector<std::unique_ptr<RenderResource>> resourceDeleteSet;
 
             uint32_t drawCallCount = 0;
+            uint32_t batchCount = 0; // number of draw calls that were produced by batching
+            uint32_t batchedDrawCallCount = 0; // number of draw calls merged into batches
+            uint32_t queuedBatchCount = 0;
+            uint32_t queuedBatchedDrawCallCount = 0;
 
-            std::vector<DrawCommand> drawQueue;
+            DrawQueue drawQueue; // filled by the game thread
+            DrawQueue renderQueue; // rendered by the render thread, swapped with drawQueue every frame
             Mutex drawQueueMutex;
             Condition queueCondition;
             bool queueFinished = false;
@@ -191,8 +242,7 @@ namespace ouzel
             float currentAccumulatedFPS = 0.0f;
             std::atomic<float> accumulatedFPS;
 
-            std::queue<std::function<void(void)>> executeQueue;
-            Mutex executeMutex;
+            MPSCQueue<SmallFunction> executeQueue;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -10,10 +10,13 @@
 #include "BlendStateResource.hpp"
 #include "MeshBufferResource.hpp"
 #include "BufferResource.hpp"
+#include "Buffer.hpp"
+#include "MeshBuffer.hpp"
 #include "events/EventHandler.hpp"
 #include "events/EventDispatcher.hpp"
 #include "core/Window.hpp"
 #include "utils/Log.hpp"
+#include "utils/Utils.hpp"
 
 #if OUZEL_PLATFORM_MACOS
 #include "graphics/metal/macos/RenderDeviceMetalMacOS.hpp"
@@ -76,7 +79,8 @@ namespace ouzel
             return availableDrivers;
         }
 
-        Renderer::Renderer(Driver driver)
+        Renderer::Renderer(Driver driver):
+            batchVertexShaderConstants(1)
         {
             for (uint32_t i = 0; i < 256; ++i)
             {
@@ -220,9 +224,9 @@ namespace ouzel
             return true;
         }
 
-        void Renderer::executeOnRenderThread(const std::function<void(void)>& func)
+        void Renderer::executeOnRenderThread(SmallFunction func)
         {
-            device->executeOnRenderThread(func);
+            device->executeOnRenderThread(std::move(func));
         }
 
         void Renderer::setClearColorBuffer(bool clear)
@@ -283,8 +287,12 @@ namespace ouzel
                                       bool wireframe,
                                       bool scissorTest,
                                       const Rect& scissorRectangle,
-                                      CullMode cullMode)
+                                      CullMode cullMode,
+                                      uint32_t instanceCount)
         {
+            // keep the draw order
+            flushBatch();
+
             if (!shader)
             {
                 Log(Log::Level::ERR) << "No shader passed to render queue";
@@ -303,34 +311,215 @@ namespace ouzel
                 return false;
             }
 
-            std::vector<TextureResource*> drawTextures;
+            if (instanceCount && (!device->isInstancingSupported() || !meshBuffer->getInstanceBuffer()))
+            {
+                Log(Log::Level::ERR) << "Invalid instanced draw passed to render queue";
+                return false;
+            }
+
+            if (textures.size() > Texture::LAYERS)
+            {
+                Log(Log::Level::ERR) << "Too many textures passed to render queue";
+                return false;
+            }
+
+            RenderDevice::DrawCommand drawCommand;
 
-            for (const std::shared_ptr<Texture>& texture : textures)
+            for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
             {
-                drawTextures.push_back(texture ? texture->getResource() : nullptr);
+                drawCommand.textures[layer] = (layer < textures.size() && textures[layer]) ? textures[layer]->getResource() : nullptr;
+            }
+
+            drawCommand.shader = shader->getResource();
+            drawCommand.blendState = blendState->getResource();
+            drawCommand.meshBuffer = meshBuffer->getResource();
+            drawCommand.indexCount = indexCount;
+            drawCommand.instanceCount = instanceCount;
+            drawCommand.drawMode = drawMode;
+            drawCommand.startIndex = startIndex;
+            drawCommand.renderTarget = renderTarget ? renderTarget->getResource() : nullptr;
+            drawCommand.viewport = viewport;
+            drawCommand.depthWrite = depthWrite;
+            drawCommand.depthTest = depthTest;
+            drawCommand.wireframe = wireframe;
+            drawCommand.scissorTest = scissorTest;
+            drawCommand.scissorRectangle = scissorRectangle;
+            drawCommand.cullMode = cullMode;
+
+            return device->addDrawCommand(drawCommand, pixelShaderConstants, vertexShaderConstants);
+        }
+
+        bool Renderer::addBatchedDrawCommand(const std::vector<std::shared_ptr<Texture>>& textures,
+                                             const std::shared_ptr<Shader>& shader,
+                                             const std::vector<std::vector<float>>& pixelShaderConstants,
+                                             const Matrix4& viewProjection,
+                                             const Matrix4& transform,
+                                             const std::shared_ptr<BlendState>& blendState,
+                                             const std::vector<uint16_t>& indices,
+                                             const std::vector<Vertex>& vertices,
+                                             const std::shared_ptr<Texture>& renderTarget,
+                                             const Rect& viewport,
+                                             bool depthWrite,
+                                             bool depthTest,
+                                             bool wireframe,
+                                             bool scissorTest,
+                                             const Rect& scissorRectangle,
+                                             CullMode cullMode)
+        {
+            if (!shader)
+            {
+                Log(Log::Level::ERR) << "No shader passed to render queue";
+                return false;
             }
 
-            RenderDevice::DrawCommand drawCommand = {
-                drawTextures,
-                shader->getResource(),
-                pixelShaderConstants,
-                vertexShaderConstants,
-                blendState->getResource(),
-                meshBuffer->getResource(),
-                indexCount,
-                drawMode,
-                startIndex,
-                renderTarget ? renderTarget->getResource() : nullptr,
-                viewport,
-                depthWrite,
-                depthTest,
-                wireframe,
-                scissorTest,
-                scissorRectangle,
-                cullMode
-            };
-
-            return device->addDrawCommand(drawCommand);
+            if (!blendState)
+            {
+                Log(Log::Level::ERR) << "No blend state passed to render queue";
+                return false;
+            }
+
+            if (indices.empty() || vertices.empty()) return true;
+
+            if (vertices.size() > 65536)
+            {
+                Log(Log::Level::ERR) << "Too many vertices passed to batch";
+                return false;
+            }
+
+            if (batchDrawCallCount)
+            {
+                if (batchVertices.size() + vertices.size() > 65536 ||
+                    batchState.textures != textures ||
+                    batchState.shader != shader ||
+                    batchState.blendState != blendState ||
+                    batchState.renderTarget != renderTarget ||
+                    batchState.depthWrite != depthWrite ||
+                    batchState.depthTest != depthTest ||
+                    batchState.wireframe != wireframe ||
+                    batchState.scissorTest != scissorTest ||
+                    batchState.cullMode != cullMode ||
+                    batchState.viewport != viewport ||
+                    (scissorTest && batchState.scissorRectangle != scissorRectangle) ||
+                    batchState.viewProjection != viewProjection ||
+                    batchState.pixelShaderConstants != pixelShaderConstants)
+                {
+                    flushBatch();
+                }
+            }
+
+            if (!batchDrawCallCount)
+            {
+                batchState.textures = textures;
+                batchState.shader = shader;
+                batchState.pixelShaderConstants = pixelShaderConstants;
+                batchState.viewProjection = viewProjection;
+                batchState.blendState = blendState;
+                batchState.renderTarget = renderTarget;
+                batchState.viewport = viewport;
+                batchState.depthWrite = depthWrite;
+                batchState.depthTest = depthTest;
+                batchState.wireframe = wireframe;
+                batchState.scissorTest = scissorTest;
+                batchState.scissorRectangle = scissorRectangle;
+                batchState.cullMode = cullMode;
+            }
+
+            uint16_t startVertex = static_cast<uint16_t>(batchVertices.size());
+
+            for (uint16_t index : indices)
+            {
+                batchIndices.push_back(startVertex + index);
+            }
+
+            for (const Vertex& vertex : vertices)
+            {
+                batchVertices.push_back(vertex);
+                Vertex& batchVertex = batchVertices.back();
+                transform.transformPoint(batchVertex.position);
+                transform.transformVector(batchVertex.normal);
+            }
+
+            ++batchDrawCallCount;
+
+            return true;
+        }
+
+        void Renderer::flushBatch()
+        {
+            if (!batchDrawCallCount) return;
+
+            std::vector<BatchBuffer>& buffers = batchBuffers[batchBufferSet];
+
+            if (batchBufferCount >= buffers.size())
+            {
+                BatchBuffer batchBuffer;
+
+                batchBuffer.indexBuffer = std::make_shared<Buffer>();
+                batchBuffer.indexBuffer->init(Buffer::Usage::INDEX, Buffer::DYNAMIC);
+
+                batchBuffer.vertexBuffer = std::make_shared<Buffer>();
+                batchBuffer.vertexBuffer->init(Buffer::Usage::VERTEX, Buffer::DYNAMIC);
+
+                batchBuffer.meshBuffer = std::make_shared<MeshBuffer>();
+                batchBuffer.meshBuffer->init(sizeof(uint16_t), batchBuffer.indexBuffer, batchBuffer.vertexBuffer);
+
+                buffers.push_back(batchBuffer);
+            }
+
+            const BatchBuffer& batchBuffer = buffers[batchBufferCount++];
+
+            batchBuffer.indexBuffer->setData(batchIndices.data(), static_cast<uint32_t>(getVectorSize(batchIndices)));
+            batchBuffer.vertexBuffer->setData(batchVertices.data(), static_cast<uint32_t>(getVectorSize(batchVertices)));
+
+            RenderDevice::DrawCommand drawCommand;
+
+            for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
+            {
+                drawCommand.textures[layer] = (layer < batchState.textures.size() && batchState.textures[layer]) ? batchState.textures[layer]->getResource() : nullptr;
+            }
+
+            drawCommand.shader = batchState.shader->getResource();
+            drawCommand.blendState = batchState.blendState->getResource();
+            drawCommand.meshBuffer = batchBuffer.meshBuffer->getResource();
+            drawCommand.indexCount = static_cast<uint32_t>(batchIndices.size());
+            drawCommand.instanceCount = 0;
+            drawCommand.drawMode = DrawMode::TRIANGLE_LIST;
+            drawCommand.startIndex = 0;
+            drawCommand.renderTarget = batchState.renderTarget ? batchState.renderTarget->getResource() : nullptr;
+            drawCommand.viewport = batchState.viewport;
+            drawCommand.depthWrite = batchState.depthWrite;
+            drawCommand.depthTest = batchState.depthTest;
+            drawCommand.wireframe = batchState.wireframe;
+            drawCommand.scissorTest = batchState.scissorTest;
+            drawCommand.scissorRectangle = batchState.scissorRectangle;
+            drawCommand.cullMode = batchState.cullMode;
+
+            batchVertexShaderConstants[0].assign(std::begin(batchState.viewProjection.m), std::end(batchState.viewProjection.m));
+
+            device->addBatchDrawCommand(drawCommand,
+                                        batchState.pixelShaderConstants,
+                                        batchVertexShaderConstants,
+                                        batchDrawCallCount);
+
+            batchIndices.clear();
+            batchVertices.clear();
+            batchDrawCallCount = 0;
+
+            // release the references
+            batchState.textures.clear();
+            batchState.shader.reset();
+            batchState.blendState.reset();
+            batchState.renderTarget.reset();
+        }
+
+        void Renderer::flushCommands()
+        {
+            flushBatch();
+
+            batchBufferSet = (batchBufferSet + 1) % 2;
+            batchBufferCount = 0;
+
+            device->flushCommands();
         }
     } // namespace graphics
 } // namespace ouzel
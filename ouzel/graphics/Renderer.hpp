@@ -15,7 +15,10 @@
 #include "math/Matrix4.hpp"
 #include "math/Size2.hpp"
 #include "math/Color.hpp"
+#include "assets/AssetId.hpp"
 #include "graphics/Texture.hpp"
+#include "graphics/Vertex.hpp"
+#include "thread/SmallFunction.hpp"
 
 namespace ouzel
 {
@@ -26,6 +29,7 @@ namespace ouzel
     {
         const std::string SHADER_TEXTURE = "shaderTexture";
         const std::string SHADER_COLOR = "shaderColor";
+        const std::string SHADER_PARTICLE = "shaderParticle"; // only with instancing
 
         const std::string BLEND_NO_BLEND = "blendNoBlend";
         const std::string BLEND_ADD = "blendAdd";
@@ -35,12 +39,24 @@ namespace ouzel
 
         const std::string TEXTURE_WHITE_PIXEL = "textureWhitePixel";
 
+        // for looking up the default assets without hashing their names
+        const assets::AssetId SHADER_TEXTURE_ID(SHADER_TEXTURE);
+        const assets::AssetId SHADER_COLOR_ID(SHADER_COLOR);
+        const assets::AssetId SHADER_PARTICLE_ID(SHADER_PARTICLE);
+        const assets::AssetId BLEND_NO_BLEND_ID(BLEND_NO_BLEND);
+        const assets::AssetId BLEND_ADD_ID(BLEND_ADD);
+        const assets::AssetId BLEND_MULTIPLY_ID(BLEND_MULTIPLY);
+        const assets::AssetId BLEND_ALPHA_ID(BLEND_ALPHA);
+        const assets::AssetId BLEND_SCREEN_ID(BLEND_SCREEN);
+        const assets::AssetId TEXTURE_WHITE_PIXEL_ID(TEXTURE_WHITE_PIXEL);
+
         class RenderDevice;
         class BlendState;
+        class Buffer;
         class MeshBuffer;
         class Shader;
 
-        class Renderer final
+        class Renderer
         {
             friend Engine;
             friend Window;
@@ -70,7 +86,7 @@ namespace ouzel
                 BACK
             };
 
-            ~Renderer();
+            virtual ~Renderer();
 
             Renderer(const Renderer&) = delete;
             Renderer& operator=(const Renderer&) = delete;
@@ -82,7 +98,7 @@ namespace ouzel
 
             inline RenderDevice* getDevice() const { return device.get(); }
 
-            void executeOnRenderThread(const std::function<void(void)>& func);
+            void executeOnRenderThread(SmallFunction func);
 
             void setClearColorBuffer(bool clear);
             inline bool getClearColorBuffer() const { return clearColorBuffer; }
@@ -116,7 +132,30 @@ namespace ouzel
                                 bool wireframe,
                                 bool scissorTest,
                                 const Rect& scissorRectangle,
-                                CullMode cullMode);
+                                CullMode cullMode,
+                                uint32_t instanceCount = 0);
+
+            // merges consecutive draws that share the same state into one dynamic mesh buffer,
+            // vertices are transformed by the transform on the CPU
+            bool addBatchedDrawCommand(const std::vector<std::shared_ptr<Texture>>& textures,
+                                       const std::shared_ptr<Shader>& shader,
+                                       const std::vector<std::vector<float>>& pixelShaderConstants,
+                                       const Matrix4& viewProjection,
+                                       const Matrix4& transform,
+                                       const std::shared_ptr<BlendState>& blendState,
+                                       const std::vector<uint16_t>& indices,
+                                       const std::vector<Vertex>& vertices,
+                                       const std::shared_ptr<Texture>& renderTarget,
+                                       const Rect& viewport,
+                                       bool depthWrite,
+                                       bool depthTest,
+                                       bool wireframe,
+                                       bool scissorTest,
+                                       const Rect& scissorRectangle,
+                                       CullMode cullMode);
+
+            void flushBatch();
+            void flushCommands();
 
         protected:
             explicit Renderer(Driver driver);
@@ -138,6 +177,41 @@ namespace ouzel
             float clearDepth = 1.0;
             bool clearColorBuffer = true;
             bool clearDepthBuffer = false;
+
+            struct BatchState
+            {
+                std::vector<std::shared_ptr<Texture>> textures;
+                std::shared_ptr<Shader> shader;
+                std::vector<std::vector<float>> pixelShaderConstants;
+                Matrix4 viewProjection;
+                std::shared_ptr<BlendState> blendState;
+                std::shared_ptr<Texture> renderTarget;
+                Rect viewport;
+                bool depthWrite = false;
+                bool depthTest = false;
+                bool wireframe = false;
+                bool scissorTest = false;
+                Rect scissorRectangle;
+                CullMode cullMode = CullMode::NONE;
+            };
+
+            struct BatchBuffer
+            {
+                std::shared_ptr<Buffer> indexBuffer;
+                std::shared_ptr<Buffer> vertexBuffer;
+                std::shared_ptr<MeshBuffer> meshBuffer;
+            };
+
+            BatchState batchState;
+            std::vector<uint16_t> batchIndices;
+            std::vector<Vertex> batchVertices;
+            uint32_t batchDrawCallCount = 0;
+            std::vector<std::vector<float>> batchVertexShaderConstants;
+
+            // two sets of buffers, so that the game thread never overwrites the buffers of the frame being rendered
+            std::vector<BatchBuffer> batchBuffers[2];
+            uint32_t batchBufferSet = 0;
+            size_t batchBufferCount = 0;
         };
     } // namespace graphics
 } // namespace ouzel
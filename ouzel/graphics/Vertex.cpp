@@ -24,5 +24,21 @@ namespace ouzel
         {
             texCoords[0] = initTexCoord;
         }
+
+        const std::vector<Vertex::Attribute> InstanceVertex::ATTRIBUTES = {
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_POSITION, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_SIZE, DataType::FLOAT),
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_ROTATION, DataType::FLOAT),
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM)
+        };
+
+        InstanceVertex::InstanceVertex()
+        {
+        }
+
+        InstanceVertex::InstanceVertex(const Vector2& initPosition, float initSize, float initRotation, Color initColor):
+            position(initPosition), size(initSize), rotation(initRotation), color(initColor)
+        {
+        }
     } // namespace graphics
 } // namespace ouzel
@@ -32,7 +32,11 @@ namespace ouzel
                     POINT_SIZE,
                     TANGENT,
                     TEXTURE_COORDINATES0,
-                    TEXTURE_COORDINATES1
+                    TEXTURE_COORDINATES1,
+                    INSTANCE_POSITION,
+                    INSTANCE_SIZE,
+                    INSTANCE_ROTATION,
+                    INSTANCE_COLOR
                 };
 
                 Attribute(Usage initUsage, DataType initDataType):
@@ -51,5 +55,20 @@ namespace ouzel
             Vector2 texCoords[2];
             Vector3 normal;
         };
+
+        // per-instance data of a quad that the vertex shader scales, rotates and moves
+        class InstanceVertex final
+        {
+        public:
+            static const std::vector<Vertex::Attribute> ATTRIBUTES;
+
+            InstanceVertex();
+            InstanceVertex(const Vector2& initPosition, float initSize, float initRotation, Color initColor);
+
+            Vector2 position;
+            float size = 0.0f;
+            float rotation = 0.0f; // in radians
+            Color color;
+        };
     } // namespace graphics
 } // namespace ouzel
@@ -419,7 +419,7 @@ namespace ouzel
             return true;
         }
 
-        bool RenderDeviceD3D11::draw(const std::vector<DrawCommand>& drawCommands)
+        bool RenderDeviceD3D11::draw(const DrawQueue& queue)
         {
             ID3D11ShaderResourceView* resourceViews[Texture::LAYERS];
             ID3D11SamplerState* samplers[Texture::LAYERS];
@@ -432,7 +432,7 @@ namespace ouzel
             viewport.MinDepth = 0.0f;
             viewport.MaxDepth = 1.0f;
 
-            if (drawCommands.empty())
+            if (queue.drawCommands.empty())
             {
                 frameBufferClearedFrame = currentFrame;
 
@@ -455,7 +455,7 @@ namespace ouzel
                     context->ClearDepthStencilView(depthStencilView, D3D11_CLEAR_DEPTH, clearDepth, 0);
                 }
             }
-            else for (const DrawCommand& drawCommand : drawCommands)
+            else for (const DrawCommand& drawCommand : queue.drawCommands)
             {
                 // render target
                 ID3D11RenderTargetView* newRenderTargetView = nullptr;
@@ -560,7 +560,7 @@ namespace ouzel
                 // pixel shader constants
                 const std::vector<ShaderResourceD3D11::Location>& pixelShaderConstantLocations = shaderD3D11->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
@@ -568,18 +568,20 @@ namespace ouzel
 
                 shaderData.clear();
 
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderResourceD3D11::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstant& pixelShaderConstant = queue.shaderConstants[drawCommand.pixelShaderConstantStart + i];
 
-                    if (sizeof(float) * pixelShaderConstant.size() != pixelShaderConstantLocation.size)
+                    if (sizeof(float) * pixelShaderConstant.size != pixelShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), pixelShaderConstant.begin(), pixelShaderConstant.end());
+                    shaderData.insert(shaderData.end(),
+                                      queue.getConstantData(pixelShaderConstant),
+                                      queue.getConstantData(pixelShaderConstant) + pixelShaderConstant.size);
                 }
 
                 if (!uploadBuffer(shaderD3D11->getPixelShaderConstantBuffer(),
@@ -595,7 +597,7 @@ namespace ouzel
                 // vertex shader constants
                 const std::vector<ShaderResourceD3D11::Location>& vertexShaderConstantLocations = shaderD3D11->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
@@ -603,18 +605,20 @@ namespace ouzel
 
                 shaderData.clear();
 
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderResourceD3D11::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstant& vertexShaderConstant = queue.shaderConstants[drawCommand.vertexShaderConstantStart + i];
 
-                    if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
+                    if (sizeof(float) * vertexShaderConstant.size != vertexShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                    shaderData.insert(shaderData.end(),
+                                      queue.getConstantData(vertexShaderConstant),
+                                      queue.getConstantData(vertexShaderConstant) + vertexShaderConstant.size);
                 }
 
                 if (!uploadBuffer(shaderD3D11->getVertexShaderConstantBuffer(),
@@ -643,12 +647,7 @@ namespace ouzel
 
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    TextureResourceD3D11* textureD3D11 = nullptr;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureD3D11 = static_cast<TextureResourceD3D11*>(drawCommand.textures[layer]);
-                    }
+                    TextureResourceD3D11* textureD3D11 = static_cast<TextureResourceD3D11*>(drawCommand.textures[layer]);
 
                     if (textureD3D11)
                     {
@@ -24,7 +24,7 @@ namespace ouzel
                               bool newDepth,
                               bool newDebugRenderer) override;
 
-            virtual bool draw(const std::vector<DrawCommand>& drawCommands) override;
+            virtual bool draw(const DrawQueue& queue) override;
 
             virtual BlendStateResource* createBlendState() override;
             virtual TextureResource* createTexture() override;
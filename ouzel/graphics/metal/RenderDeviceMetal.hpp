@@ -98,7 +98,7 @@ namespace ouzel
 
             virtual void setSize(const Size2& newSize) override;
 
-            virtual bool draw(const std::vector<DrawCommand>& drawCommands) override;
+            virtual bool draw(const DrawQueue& queue) override;
             virtual bool generateScreenshot(const std::string& filename) override;
 
             virtual BlendStateResource* createBlendState() override;
@@ -299,7 +299,7 @@ namespace ouzel
             metalLayer.drawableSize = drawableSize;
         }
 
-        bool RenderDeviceMetal::draw(const std::vector<DrawCommand>& drawCommands)
+        bool RenderDeviceMetal::draw(const DrawQueue& queue)
         {
             id<CAMetalDrawable> currentMetalDrawable = [metalLayer nextDrawable];
 
@@ -418,7 +418,7 @@ namespace ouzel
 
             ShaderConstantBuffer& shaderConstantBuffer = shaderConstantBuffers[shaderConstantBufferIndex];
 
-            if (drawCommands.empty())
+            if (queue.drawCommands.empty())
             {
                 frameBufferClearedFrame = currentFrame;
 
@@ -441,7 +441,7 @@ namespace ouzel
                 currentRenderPassDescriptor.colorAttachments[0].loadAction = colorBufferLoadAction;
                 currentRenderPassDescriptor.depthAttachment.loadAction = depthBufferLoadAction;
             }
-            else for (const DrawCommand& drawCommand : drawCommands)
+            else for (const DrawCommand& drawCommand : queue.drawCommands)
             {
                 MTLRenderPassDescriptorPtr newRenderPassDescriptor;
                 PipelineStateDesc pipelineStateDesc;
@@ -576,7 +576,7 @@ namespace ouzel
                 // pixel shader constants
                 const std::vector<ShaderResourceMetal::Location>& pixelShaderConstantLocations = shaderMetal->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
@@ -584,18 +584,20 @@ namespace ouzel
 
                 shaderData.clear();
 
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderResourceMetal::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstant& pixelShaderConstant = queue.shaderConstants[drawCommand.pixelShaderConstantStart + i];
 
-                    if (sizeof(float) * pixelShaderConstant.size() != pixelShaderConstantLocation.size)
+                    if (sizeof(float) * pixelShaderConstant.size != pixelShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), pixelShaderConstant.begin(), pixelShaderConstant.end());
+                    shaderData.insert(shaderData.end(),
+                                      queue.getConstantData(pixelShaderConstant),
+                                      queue.getConstantData(pixelShaderConstant) + pixelShaderConstant.size);
                 }
 
                 shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + shaderMetal->getPixelShaderAlignment() - 1) /
@@ -619,7 +621,7 @@ namespace ouzel
                 // vertex shader constants
                 const std::vector<ShaderResourceMetal::Location>& vertexShaderConstantLocations = shaderMetal->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
@@ -627,18 +629,20 @@ namespace ouzel
 
                 shaderData.clear();
 
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderResourceMetal::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstant& vertexShaderConstant = queue.shaderConstants[drawCommand.vertexShaderConstantStart + i];
 
-                    if (sizeof(float) * vertexShaderConstant.size() != vertexShaderConstantLocation.size)
+                    if (sizeof(float) * vertexShaderConstant.size != vertexShaderConstantLocation.size)
                     {
                         Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                         return false;
                     }
 
-                    shaderData.insert(shaderData.end(), vertexShaderConstant.begin(), vertexShaderConstant.end());
+                    shaderData.insert(shaderData.end(),
+                                      queue.getConstantData(vertexShaderConstant),
+                                      queue.getConstantData(vertexShaderConstant) + vertexShaderConstant.size);
                 }
 
                 shaderConstantBuffer.offset = ((shaderConstantBuffer.offset + shaderMetal->getVertexShaderAlignment() - 1) /
@@ -685,12 +689,7 @@ namespace ouzel
 
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    TextureResourceMetal* textureMetal = nullptr;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureMetal = static_cast<TextureResourceMetal*>(drawCommand.textures[layer]);
-                    }
+                    TextureResourceMetal* textureMetal = static_cast<TextureResourceMetal*>(drawCommand.textures[layer]);
 
                     if (textureMetal)
                     {
@@ -236,6 +236,22 @@ namespace ouzel
                 offset += getDataTypeSize(vertexAttribute.dataType);
             }
 
+            instanceAttribs.clear();
+
+            offset = 0;
+
+            for (const Vertex::Attribute& instanceAttribute : InstanceVertex::ATTRIBUTES)
+            {
+                instanceAttribs.push_back({
+                    getArraySize(instanceAttribute.dataType),
+                    getVertexFormat(instanceAttribute.dataType),
+                    isNormalized(instanceAttribute.dataType),
+                    static_cast<GLsizei>(sizeof(InstanceVertex)),
+                    static_cast<const GLchar*>(nullptr) + offset
+                });
+                offset += getDataTypeSize(instanceAttribute.dataType);
+            }
+
             indexBufferOGL = static_cast<BufferResourceOGL*>(indexBuffer);
             vertexBufferOGL = static_cast<BufferResourceOGL*>(vertexBuffer);
 
@@ -353,6 +369,28 @@ namespace ouzel
             return true;
         }
 
+        bool MeshBufferResourceOGL::setInstanceBuffer(BufferResource* newInstanceBuffer)
+        {
+            if (!MeshBufferResource::setInstanceBuffer(newInstanceBuffer))
+            {
+                return false;
+            }
+
+            instanceBufferOGL = static_cast<BufferResourceOGL*>(instanceBuffer);
+
+            if (vertexArrayId)
+            {
+                if (!renderDeviceOGL->bindVertexArray(vertexArrayId))
+                {
+                    return false;
+                }
+
+                return setInstanceAttributes();
+            }
+
+            return true;
+        }
+
         bool MeshBufferResourceOGL::bindBuffers()
         {
             if (vertexArrayId)
@@ -410,6 +448,11 @@ namespace ouzel
                     Log(Log::Level::ERR) << "Failed to update vertex attributes";
                     return false;
                 }
+
+                if (!setInstanceAttributes())
+                {
+                    return false;
+                }
             }
 
             return true;
@@ -467,6 +510,45 @@ namespace ouzel
                         return false;
                     }
                 }
+
+                if (!setInstanceAttributes())
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // instance attributes follow the vertex attributes and advance once per instance
+        bool MeshBufferResourceOGL::setInstanceAttributes()
+        {
+            if (!instanceBufferOGL || !instanceBufferOGL->getBufferId() || !glVertexAttribDivisorProc)
+            {
+                return true;
+            }
+
+            if (!renderDeviceOGL->bindBuffer(GL_ARRAY_BUFFER, instanceBufferOGL->getBufferId()))
+            {
+                return false;
+            }
+
+            for (GLuint index = 0; index < instanceAttribs.size(); ++index)
+            {
+                glEnableVertexAttribArrayProc(MAX_VERTEX_ATTRIBUTE_COUNT + index);
+                glVertexAttribPointerProc(MAX_VERTEX_ATTRIBUTE_COUNT + index,
+                                          instanceAttribs[index].size,
+                                          instanceAttribs[index].type,
+                                          instanceAttribs[index].normalized,
+                                          instanceAttribs[index].stride,
+                                          instanceAttribs[index].pointer);
+                glVertexAttribDivisorProc(MAX_VERTEX_ATTRIBUTE_COUNT + index, 1);
+            }
+
+            if (RenderDeviceOGL::checkOpenGLError())
+            {
+                Log(Log::Level::ERR) << "Failed to update instance attributes";
+                return false;
             }
 
             return true;
@@ -44,6 +44,7 @@ namespace ouzel
             virtual bool setIndexSize(uint32_t newIndexSize) override;
             virtual bool setIndexBuffer(BufferResource* newIndexBuffer) override;
             virtual bool setVertexBuffer(BufferResource* newVertexBuffer) override;
+            virtual bool setInstanceBuffer(BufferResource* newInstanceBuffer) override;
 
             bool bindBuffers();
 
@@ -53,9 +54,11 @@ namespace ouzel
 
             inline BufferResourceOGL* getIndexBufferOGL() const { return indexBufferOGL; }
             inline BufferResourceOGL* getVertexBufferOGL() const { return vertexBufferOGL; }
+            inline BufferResourceOGL* getInstanceBufferOGL() const { return instanceBufferOGL; }
 
         protected:
             bool createVertexArray();
+            bool setInstanceAttributes();
 
             RenderDeviceOGL* renderDeviceOGL;
 
@@ -71,11 +74,13 @@ namespace ouzel
                 const GLvoid* pointer;
             };
             std::vector<VertexAttrib> vertexAttribs;
+            std::vector<VertexAttrib> instanceAttribs;
 
             GLuint vertexArrayId = 0;
 
             BufferResourceOGL* indexBufferOGL = nullptr;
             BufferResourceOGL* vertexBufferOGL = nullptr;
+            BufferResourceOGL* instanceBufferOGL = nullptr;
         };
     } // namespace graphics
 } // namespace ouzel
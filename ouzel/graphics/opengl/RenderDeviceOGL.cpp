@@ -56,6 +56,7 @@
 #include "ColorVSGLES3.h"
 #include "TexturePSGLES3.h"
 #include "TextureVSGLES3.h"
+#include "ParticleVSGLES3.h"
 #else
 #include "ColorPSGL2.h"
 #include "ColorVSGL2.h"
@@ -65,10 +66,12 @@
 #include "ColorVSGL3.h"
 #include "TexturePSGL3.h"
 #include "TextureVSGL3.h"
+#include "ParticleVSGL3.h"
 #include "ColorPSGL4.h"
 #include "ColorVSGL4.h"
 #include "TexturePSGL4.h"
 #include "TextureVSGL4.h"
+#include "ParticleVSGL4.h"
 #endif
 
 PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparateProc;
@@ -141,6 +144,8 @@ PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArraysProc;
 PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc;
 PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc;
 PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc;
+PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc;
+PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc;
 
 PFNGLGETSTRINGIPROC glGetStringiProc;
 
@@ -414,6 +419,9 @@ namespace ouzel
                 glMapBufferRangeProc = glMapBufferRangeEXT;
 
                 glRenderbufferStorageMultisampleProc = glRenderbufferStorageMultisampleAPPLE;
+
+                glVertexAttribDivisorProc = glVertexAttribDivisor;
+                glDrawElementsInstancedProc = glDrawElementsInstanced;
 #else
                 glUniform1uivProc = reinterpret_cast<PFNGLUNIFORM1UIVPROC>(getProcAddress("glUniform1uiv"));
                 glUniform2uivProc = reinterpret_cast<PFNGLUNIFORM2UIVPROC>(getProcAddress("glUniform2uiv"));
@@ -448,7 +456,13 @@ namespace ouzel
     #if OUZEL_SUPPORTS_OPENGLES
                 glFramebufferTexture2DMultisampleProc = reinterpret_cast<PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC>(getProcAddress("glFramebufferTexture2DMultisample"));
     #endif
+
+                glVertexAttribDivisorProc = reinterpret_cast<PFNGLVERTEXATTRIBDIVISORPROC>(getProcAddress("glVertexAttribDivisor"));
+                glDrawElementsInstancedProc = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDPROC>(getProcAddress("glDrawElementsInstanced"));
 #endif
+
+                // the particle shader needs vertex arrays, which OpenGL 3 has
+                instancingSupported = glVertexAttribDivisorProc && glDrawElementsInstancedProc && glGenVertexArraysProc;
             }
             else
             {
@@ -458,6 +472,7 @@ namespace ouzel
 #if OUZEL_SUPPORTS_OPENGLES
                 textureBaseLevelSupported = false;
                 textureMaxLevelSupported = false;
+                uintIndicesSupported = false;
 #else
                 renderTargetsSupported = false;
 #endif
@@ -536,6 +551,12 @@ namespace ouzel
                         textureMaxLevelSupported = true;
                     }
 #endif // OUZEL_OPENGL_INTERFACE_EGL
+#if OUZEL_SUPPORTS_OPENGLES
+                    else if (extension == "GL_OES_element_index_uint")
+                    {
+                        uintIndicesSupported = true;
+                    }
+#endif
                 }
 
                 if (!multisamplingSupported)
@@ -643,6 +664,50 @@ namespace ouzel
 
             engine->getCache()->setShader(SHADER_COLOR, colorShader);
 
+            if (instancingSupported)
+            {
+                std::shared_ptr<Shader> particleShader = std::make_shared<Shader>();
+
+                switch (apiMajorVersion)
+                {
+#if OUZEL_SUPPORTS_OPENGLES
+                    case 3:
+                        particleShader->init(std::vector<uint8_t>(std::begin(TexturePSGLES3_glsl), std::end(TexturePSGLES3_glsl)),
+                                             std::vector<uint8_t>(std::begin(ParticleVSGLES3_glsl), std::end(ParticleVSGLES3_glsl)),
+                                             {Vertex::Attribute::Usage::POSITION, Vertex::Attribute::Usage::COLOR, Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                              Vertex::Attribute::Usage::INSTANCE_POSITION, Vertex::Attribute::Usage::INSTANCE_SIZE,
+                                              Vertex::Attribute::Usage::INSTANCE_ROTATION, Vertex::Attribute::Usage::INSTANCE_COLOR},
+                                             {{"color", DataType::FLOAT_VECTOR4}},
+                                             {{"modelViewProj", DataType::FLOAT_MATRIX4}});
+                        break;
+#else
+                    case 3:
+                        particleShader->init(std::vector<uint8_t>(std::begin(TexturePSGL3_glsl), std::end(TexturePSGL3_glsl)),
+                                             std::vector<uint8_t>(std::begin(ParticleVSGL3_glsl), std::end(ParticleVSGL3_glsl)),
+                                             {Vertex::Attribute::Usage::POSITION, Vertex::Attribute::Usage::COLOR, Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                              Vertex::Attribute::Usage::INSTANCE_POSITION, Vertex::Attribute::Usage::INSTANCE_SIZE,
+                                              Vertex::Attribute::Usage::INSTANCE_ROTATION, Vertex::Attribute::Usage::INSTANCE_COLOR},
+                                             {{"color", DataType::FLOAT_VECTOR4}},
+                                             {{"modelViewProj", DataType::FLOAT_MATRIX4}});
+                        break;
+                    case 4:
+                        particleShader->init(std::vector<uint8_t>(std::begin(TexturePSGL4_glsl), std::end(TexturePSGL4_glsl)),
+                                             std::vector<uint8_t>(std::begin(ParticleVSGL4_glsl), std::end(ParticleVSGL4_glsl)),
+                                             {Vertex::Attribute::Usage::POSITION, Vertex::Attribute::Usage::COLOR, Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                              Vertex::Attribute::Usage::INSTANCE_POSITION, Vertex::Attribute::Usage::INSTANCE_SIZE,
+                                              Vertex::Attribute::Usage::INSTANCE_ROTATION, Vertex::Attribute::Usage::INSTANCE_COLOR},
+                                             {{"color", DataType::FLOAT_VECTOR4}},
+                                             {{"modelViewProj", DataType::FLOAT_MATRIX4}});
+                        break;
+#endif
+                    default:
+                        Log(Log::Level::ERR) << "Unsupported OpenGL version";
+                        return false;
+                }
+
+                engine->getCache()->setShader(SHADER_PARTICLE, particleShader);
+            }
+
             glDisable(GL_DITHER);
             glDepthFunc(GL_LEQUAL);
 
@@ -784,9 +849,9 @@ namespace ouzel
             return true;
         }
 
-        bool RenderDeviceOGL::draw(const std::vector<DrawCommand>& drawCommands)
+        bool RenderDeviceOGL::draw(const DrawQueue& queue)
         {
-            if (drawCommands.empty())
+            if (queue.drawCommands.empty())
             {
                 frameBufferClearedFrame = currentFrame;
 
@@ -823,7 +888,7 @@ namespace ouzel
                     return false;
                 }
             }
-            else for (const DrawCommand& drawCommand : drawCommands)
+            else for (const DrawCommand& drawCommand : queue.drawCommands)
             {
 #if !OUZEL_SUPPORTS_OPENGLES
                 setPolygonFillMode(drawCommand.wireframe ? GL_LINE : GL_FILL);
@@ -882,12 +947,7 @@ namespace ouzel
 
                 for (uint32_t layer = 0; layer < Texture::LAYERS; ++layer)
                 {
-                    TextureResourceOGL* textureOGL = nullptr;
-
-                    if (drawCommand.textures.size() > layer)
-                    {
-                        textureOGL = static_cast<TextureResourceOGL*>(drawCommand.textures[layer]);
-                    }
+                    TextureResourceOGL* textureOGL = static_cast<TextureResourceOGL*>(drawCommand.textures[layer]);
 
                     if (textureOGL)
                     {
@@ -930,20 +990,20 @@ namespace ouzel
                 // pixel shader constants
                 const std::vector<ShaderResourceOGL::Location>& pixelShaderConstantLocations = shaderOGL->getPixelShaderConstantLocations();
 
-                if (drawCommand.pixelShaderConstants.size() > pixelShaderConstantLocations.size())
+                if (drawCommand.pixelShaderConstantCount > pixelShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid pixel shader constant size";
                     return false;
                 }
 
-                for (size_t i = 0; i < drawCommand.pixelShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.pixelShaderConstantCount; ++i)
                 {
                     const ShaderResourceOGL::Location& pixelShaderConstantLocation = pixelShaderConstantLocations[i];
-                    const std::vector<float>& pixelShaderConstant = drawCommand.pixelShaderConstants[i];
+                    const ShaderConstant& pixelShaderConstant = queue.shaderConstants[drawCommand.pixelShaderConstantStart + i];
 
                     if (!setUniform(pixelShaderConstantLocation.location,
                                     pixelShaderConstantLocation.dataType,
-                                    pixelShaderConstant.data()))
+                                    queue.getConstantData(pixelShaderConstant)))
                     {
                         return false;
                     }
@@ -952,20 +1012,20 @@ namespace ouzel
                 // vertex shader constants
                 const std::vector<ShaderResourceOGL::Location>& vertexShaderConstantLocations = shaderOGL->getVertexShaderConstantLocations();
 
-                if (drawCommand.vertexShaderConstants.size() > vertexShaderConstantLocations.size())
+                if (drawCommand.vertexShaderConstantCount > vertexShaderConstantLocations.size())
                 {
                     Log(Log::Level::ERR) << "Invalid vertex shader constant size";
                     return false;
                 }
 
-                for (size_t i = 0; i < drawCommand.vertexShaderConstants.size(); ++i)
+                for (uint32_t i = 0; i < drawCommand.vertexShaderConstantCount; ++i)
                 {
                     const ShaderResourceOGL::Location& vertexShaderConstantLocation = vertexShaderConstantLocations[i];
-                    const std::vector<float>& vertexShaderConstant = drawCommand.vertexShaderConstants[i];
+                    const ShaderConstant& vertexShaderConstant = queue.shaderConstants[drawCommand.vertexShaderConstantStart + i];
 
                     if (!setUniform(vertexShaderConstantLocation.location,
                                     vertexShaderConstantLocation.dataType,
-                                    vertexShaderConstant.data()))
+                                    queue.getConstantData(vertexShaderConstant)))
                     {
                         return false;
                     }
@@ -1097,10 +1157,21 @@ namespace ouzel
                     indexCount = (indexBufferOGL->getSize() / meshBufferOGL->getIndexSize()) - drawCommand.startIndex;
                 }
 
-                glDrawElements(mode,
-                               static_cast<GLsizei>(indexCount),
-                               meshBufferOGL->getIndexType(),
-                               static_cast<const char*>(nullptr) + (drawCommand.startIndex * meshBufferOGL->getBytesPerIndex()));
+                if (drawCommand.instanceCount)
+                {
+                    glDrawElementsInstancedProc(mode,
+                                                static_cast<GLsizei>(indexCount),
+                                                meshBufferOGL->getIndexType(),
+                                                static_cast<const char*>(nullptr) + (drawCommand.startIndex * meshBufferOGL->getBytesPerIndex()),
+                                                static_cast<GLsizei>(drawCommand.instanceCount));
+                }
+                else
+                {
+                    glDrawElements(mode,
+                                   static_cast<GLsizei>(indexCount),
+                                   meshBufferOGL->getIndexType(),
+                                   static_cast<const char*>(nullptr) + (drawCommand.startIndex * meshBufferOGL->getBytesPerIndex()));
+                }
 
                 if (checkOpenGLError())
                 {
@@ -95,6 +95,8 @@ extern PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArraysProc;
 extern PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc;
 extern PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc;
 extern PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc;
+extern PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc;
+extern PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc;
 
 extern PFNGLGETSTRINGIPROC glGetStringiProc;
 
@@ -631,7 +633,7 @@ namespace ouzel
 
             virtual void setSize(const Size2& newSize) override;
 
-            virtual bool draw(const std::vector<DrawCommand>& drawCommands) override;
+            virtual bool draw(const DrawQueue& queue) override;
             virtual bool lockContext();
             virtual bool swapBuffers();
             virtual bool generateScreenshot(const std::string& filename) override;
@@ -204,6 +204,40 @@ namespace ouzel
                 }
             }
 
+            // instance attributes have fixed locations after all the vertex attributes, see MeshBufferResourceOGL
+            index = static_cast<GLuint>(Vertex::ATTRIBUTES.size());
+
+            for (const Vertex::Attribute& instanceAttribute : InstanceVertex::ATTRIBUTES)
+            {
+                if (vertexAttributes.find(instanceAttribute.usage) != vertexAttributes.end())
+                {
+                    const GLchar* name;
+
+                    switch (instanceAttribute.usage)
+                    {
+                        case Vertex::Attribute::Usage::INSTANCE_POSITION:
+                            name = "instancePosition";
+                            break;
+                        case Vertex::Attribute::Usage::INSTANCE_SIZE:
+                            name = "instanceSize";
+                            break;
+                        case Vertex::Attribute::Usage::INSTANCE_ROTATION:
+                            name = "instanceRotation";
+                            break;
+                        case Vertex::Attribute::Usage::INSTANCE_COLOR:
+                            name = "instanceColor";
+                            break;
+                        default:
+                            Log(Log::Level::ERR) << "Invalid instance attribute usage";
+                            return false;
+                    }
+
+                    glBindAttribLocationProc(programId, index, name);
+                }
+
+                ++index;
+            }
+
             glLinkProgramProc(programId);
 
             glGetProgramivProc(programId, GL_LINK_STATUS, &status);
@@ -42,10 +42,10 @@ namespace ouzel
         return true;
     }
 
-    bool TTFont::init(const std::vector<uint8_t>& newData, bool newMipmaps)
+    bool TTFont::init(const DataView& newData, bool newMipmaps)
     {
         loaded = false;
-        data = newData;
+        data.assign(newData.begin(), newData.end());
         mipmaps = newMipmaps;
 
         if (!stbtt_InitFont(&font, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0)))
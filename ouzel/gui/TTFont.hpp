@@ -5,6 +5,7 @@
 
 #include "stb_truetype.h"
 #include "gui/Font.hpp"
+#include "files/DataView.hpp"
 
 namespace ouzel
 {
@@ -15,7 +16,7 @@ namespace ouzel
         TTFont(const std::string& filename, bool initMipmaps = true);
 
         bool init(const std::string& filename, bool newMipmaps = true);
-        bool init(const std::vector<uint8_t>& newData, bool newMipmaps = true);
+        bool init(const DataView& newData, bool newMipmaps = true);
 
         virtual bool getVertices(const std::string& text,
                                  const Color& color,
@@ -32,13 +32,13 @@ namespace ouzel
         // Left-top-front
         dst[3].set(min.x, max.y, min.z);
         // Left-bottom-back
-        dst[0].set(min.x, min.y, max.z);
+        dst[4].set(min.x, min.y, max.z);
         // Right-bottom-back
-        dst[1].set(max.x, min.y, max.z);
+        dst[5].set(max.x, min.y, max.z);
         // Right-top-back
-        dst[2].set(max.x, max.y, max.z);
+        dst[6].set(max.x, max.y, max.z);
         // Left-top-back
-        dst[3].set(min.x, max.y, max.z);
+        dst[7].set(min.x, max.y, max.z);
     }
 
     void Box3::merge(const Box3& box)
@@ -0,0 +1,150 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "core/Setup.h"
+#if OUZEL_SUPPORTS_SSE
+#include <xmmintrin.h>
+#elif OUZEL_SUPPORTS_NEON64
+#include <arm_neon.h>
+#endif
+
+namespace ouzel
+{
+    // Kernels are written as templates over one of these, so that the same code processes
+    // SIMDVector::SIZE elements at once and the remainder with SIMDScalar.
+    struct SIMDScalar
+    {
+        typedef float Vector;
+        typedef bool Mask;
+        static const uint32_t SIZE = 1;
+
+        static inline Vector load(const float* source) { return *source; }
+        static inline void store(float* destination, Vector v) { *destination = v; }
+        static inline Vector set(float value) { return value; }
+
+        static inline Vector add(Vector a, Vector b) { return a + b; }
+        static inline Vector sub(Vector a, Vector b) { return a - b; }
+        static inline Vector mul(Vector a, Vector b) { return a * b; }
+        static inline Vector div(Vector a, Vector b) { return a / b; }
+        static inline Vector min(Vector a, Vector b) { return std::min(a, b); }
+        static inline Vector max(Vector a, Vector b) { return std::max(a, b); }
+        static inline Vector sqrt(Vector v) { return sqrtf(v); }
+        static inline Vector round(Vector v) { return nearbyintf(v); }
+
+        static inline Mask lessThan(Vector a, Vector b) { return a < b; }
+        static inline Mask greaterThan(Vector a, Vector b) { return a > b; }
+        static inline Mask greaterEqual(Vector a, Vector b) { return a >= b; }
+        static inline Vector select(Mask mask, Vector a, Vector b) { return mask ? a : b; }
+    };
+
+#if OUZEL_SUPPORTS_SSE
+    struct SIMDVector
+    {
+        typedef __m128 Vector;
+        typedef __m128 Mask;
+        static const uint32_t SIZE = 4;
+
+        static inline Vector load(const float* source) { return _mm_loadu_ps(source); }
+        static inline void store(float* destination, Vector v) { _mm_storeu_ps(destination, v); }
+        static inline Vector set(float value) { return _mm_set1_ps(value); }
+
+        static inline Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+        static inline Vector sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+        static inline Vector mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+        static inline Vector div(Vector a, Vector b) { return _mm_div_ps(a, b); }
+        static inline Vector min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+        static inline Vector max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+        static inline Vector sqrt(Vector v) { return _mm_sqrt_ps(v); }
+        static inline Vector round(Vector v)
+        {
+            // adding and subtracting 1.5 * 2^23 rounds to the nearest integer (for |v| < 2^22)
+            const __m128 magic = _mm_set1_ps(12582912.0f);
+            return _mm_sub_ps(_mm_add_ps(v, magic), magic);
+        }
+
+        static inline Mask lessThan(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+        static inline Mask greaterThan(Vector a, Vector b) { return _mm_cmpgt_ps(a, b); }
+        static inline Mask greaterEqual(Vector a, Vector b) { return _mm_cmpge_ps(a, b); }
+        static inline Vector select(Mask mask, Vector a, Vector b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    };
+#elif OUZEL_SUPPORTS_NEON64
+    struct SIMDVector
+    {
+        typedef float32x4_t Vector;
+        typedef uint32x4_t Mask;
+        static const uint32_t SIZE = 4;
+
+        static inline Vector load(const float* source) { return vld1q_f32(source); }
+        static inline void store(float* destination, Vector v) { vst1q_f32(destination, v); }
+        static inline Vector set(float value) { return vdupq_n_f32(value); }
+
+        static inline Vector add(Vector a, Vector b) { return vaddq_f32(a, b); }
+        static inline Vector sub(Vector a, Vector b) { return vsubq_f32(a, b); }
+        static inline Vector mul(Vector a, Vector b) { return vmulq_f32(a, b); }
+        static inline Vector div(Vector a, Vector b) { return vdivq_f32(a, b); }
+        static inline Vector min(Vector a, Vector b) { return vminq_f32(a, b); }
+        static inline Vector max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+        static inline Vector sqrt(Vector v) { return vsqrtq_f32(v); }
+        static inline Vector round(Vector v) { return vrndnq_f32(v); }
+
+        static inline Mask lessThan(Vector a, Vector b) { return vcltq_f32(a, b); }
+        static inline Mask greaterThan(Vector a, Vector b) { return vcgtq_f32(a, b); }
+        static inline Mask greaterEqual(Vector a, Vector b) { return vcgeq_f32(a, b); }
+        static inline Vector select(Mask mask, Vector a, Vector b) { return vbslq_f32(mask, a, b); }
+    };
+#else
+    typedef SIMDScalar SIMDVector;
+#endif
+
+    // sine and cosine of x in radians, the absolute error is about 1e-6 for |x| < 1e5
+    template<class T>
+    inline void sinCos(typename T::Vector x, typename T::Vector& sine, typename T::Vector& cosine)
+    {
+        typedef typename T::Vector Vector;
+
+        // tau split into parts with few significant bits, so that the products with turns are exact
+        const Vector tau1 = T::set(6.28125f);
+        const Vector tau2 = T::set(1.93500518798828125e-3f);
+        const Vector tau3 = T::set(3.01991598195675286e-7f);
+        const Vector halfPi = T::set(1.57079632679489661923f);
+        const Vector pi = T::set(3.14159265358979323846f);
+        const Vector negativePi = T::set(-3.14159265358979323846f);
+        const Vector negativeHalfPi = T::set(-1.57079632679489661923f);
+
+        // reduce to [-pi, pi]
+        Vector turns = T::round(T::mul(x, T::set(0.159154943091895335769f)));
+        x = T::sub(x, T::mul(turns, tau1));
+        x = T::sub(x, T::mul(turns, tau2));
+        x = T::sub(x, T::mul(turns, tau3));
+
+        // sin(x) = sin(pi - x), reduce to [-pi/2, pi/2]
+        Vector s = T::select(T::greaterThan(x, halfPi), T::sub(pi, x),
+                             T::select(T::lessThan(x, negativeHalfPi), T::sub(negativePi, x), x));
+
+        // cos(x) = sin(x + pi/2)
+        Vector c = T::add(x, halfPi);
+        c = T::select(T::greaterThan(c, halfPi), T::sub(pi, c), c);
+
+        Vector values[2] = {s, c};
+
+        for (Vector& v : values)
+        {
+            // Taylor series up to x^11
+            Vector v2 = T::mul(v, v);
+            Vector p = T::set(-2.50521083854417187751e-8f);
+            p = T::add(T::mul(p, v2), T::set(2.75573192239858906526e-6f));
+            p = T::add(T::mul(p, v2), T::set(-1.98412698412698412698e-4f));
+            p = T::add(T::mul(p, v2), T::set(8.33333333333333333333e-3f));
+            p = T::add(T::mul(p, v2), T::set(-1.66666666666666666667e-1f));
+            v = T::add(v, T::mul(T::mul(p, v2), v));
+        }
+
+        sine = values[0];
+        cosine = values[1];
+    }
+}
@@ -0,0 +1,371 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "AABBTree.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        static const float BOX_MARGIN = 0.1f; // relative to the size of the box
+
+        static inline Box3 combine(const Box3& a, const Box3& b)
+        {
+            Box3 result = a;
+            result.merge(b);
+            return result;
+        }
+
+        static inline bool contains(const Box3& a, const Box3& b)
+        {
+            return a.min.x <= b.min.x && a.min.y <= b.min.y && a.min.z <= b.min.z &&
+                b.max.x <= a.max.x && b.max.y <= a.max.y && b.max.z <= a.max.z;
+        }
+
+        // sum of the edge lengths, used as the cost of a node (works for flat 2D boxes too)
+        static inline float getCost(const Box3& box)
+        {
+            return (box.max.x - box.min.x) + (box.max.y - box.min.y) + (box.max.z - box.min.z);
+        }
+
+        static inline Box3 enlarge(const Box3& box)
+        {
+            Vector3 margin = (box.max - box.min) * BOX_MARGIN;
+            return Box3(box.min - margin, box.max + margin);
+        }
+
+        int32_t AABBTree::createProxy(const Box3& box, Actor* actor)
+        {
+            int32_t proxy = allocateNode();
+
+            nodes[proxy].box = enlarge(box);
+            nodes[proxy].actor = actor;
+            nodes[proxy].height = 0;
+
+            insertLeaf(proxy);
+
+            return proxy;
+        }
+
+        void AABBTree::destroyProxy(int32_t proxy)
+        {
+            removeLeaf(proxy);
+            freeNode(proxy);
+        }
+
+        bool AABBTree::moveProxy(int32_t proxy, const Box3& box)
+        {
+            const Box3& currentBox = nodes[proxy].box;
+            Box3 enlargedBox = enlarge(box);
+
+            // keep the proxy unless it no longer contains the box or has become much larger than needed
+            if (contains(currentBox, box) && getCost(currentBox) <= 2.0f * getCost(enlargedBox))
+            {
+                return false;
+            }
+
+            removeLeaf(proxy);
+            nodes[proxy].box = enlargedBox;
+            insertLeaf(proxy);
+
+            return true;
+        }
+
+        void AABBTree::query(const Box3& box, std::vector<Actor*>& result) const
+        {
+            if (root == NULL_NODE) return;
+
+            std::vector<int32_t> stack;
+            stack.push_back(root);
+
+            while (!stack.empty())
+            {
+                const Node& node = nodes[stack.back()];
+                stack.pop_back();
+
+                if (node.box.intersects(box))
+                {
+                    if (node.isLeaf())
+                    {
+                        result.push_back(node.actor);
+                    }
+                    else
+                    {
+                        stack.push_back(node.child1);
+                        stack.push_back(node.child2);
+                    }
+                }
+            }
+        }
+
+        void AABBTree::clear()
+        {
+            nodes.clear();
+            root = NULL_NODE;
+            freeList = NULL_NODE;
+        }
+
+        int32_t AABBTree::allocateNode()
+        {
+            if (freeList == NULL_NODE)
+            {
+                nodes.push_back(Node());
+                return static_cast<int32_t>(nodes.size() - 1);
+            }
+
+            int32_t node = freeList;
+            freeList = nodes[node].parent;
+            nodes[node] = Node();
+
+            return node;
+        }
+
+        void AABBTree::freeNode(int32_t node)
+        {
+            nodes[node].actor = nullptr;
+            nodes[node].parent = freeList;
+            nodes[node].child1 = NULL_NODE;
+            nodes[node].child2 = NULL_NODE;
+            nodes[node].height = -1;
+            freeList = node;
+        }
+
+        void AABBTree::insertLeaf(int32_t leaf)
+        {
+            if (root == NULL_NODE)
+            {
+                root = leaf;
+                nodes[root].parent = NULL_NODE;
+                return;
+            }
+
+            // find the best sibling
+            Box3 leafBox = nodes[leaf].box;
+            int32_t index = root;
+
+            while (!nodes[index].isLeaf())
+            {
+                const Node& node = nodes[index];
+
+                float cost = getCost(node.box);
+                float combinedCost = getCost(combine(node.box, leafBox));
+
+                // cost of creating a new parent for this node and the new leaf
+                float siblingCost = 2.0f * combinedCost;
+
+                // minimum cost of pushing the leaf further down the tree
+                float inheritanceCost = 2.0f * (combinedCost - cost);
+
+                const Node& child1 = nodes[node.child1];
+                float cost1 = getCost(combine(child1.box, leafBox)) + inheritanceCost;
+                if (!child1.isLeaf()) cost1 -= getCost(child1.box);
+
+                const Node& child2 = nodes[node.child2];
+                float cost2 = getCost(combine(child2.box, leafBox)) + inheritanceCost;
+                if (!child2.isLeaf()) cost2 -= getCost(child2.box);
+
+                if (siblingCost < cost1 && siblingCost < cost2) break;
+
+                index = (cost1 < cost2) ? node.child1 : node.child2;
+            }
+
+            int32_t sibling = index;
+
+            // create a new parent (might reallocate the nodes)
+            int32_t oldParent = nodes[sibling].parent;
+            int32_t newParent = allocateNode();
+            nodes[newParent].parent = oldParent;
+            nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+            nodes[newParent].height = nodes[sibling].height + 1;
+
+            if (oldParent != NULL_NODE)
+            {
+                if (nodes[oldParent].child1 == sibling)
+                    nodes[oldParent].child1 = newParent;
+                else
+                    nodes[oldParent].child2 = newParent;
+            }
+            else
+            {
+                root = newParent;
+            }
+
+            nodes[newParent].child1 = sibling;
+            nodes[newParent].child2 = leaf;
+            nodes[sibling].parent = newParent;
+            nodes[leaf].parent = newParent;
+
+            // fix the heights and boxes of the ancestors
+            index = nodes[leaf].parent;
+
+            while (index != NULL_NODE)
+            {
+                index = balance(index);
+
+                Node& node = nodes[index];
+                node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+                node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+
+                index = node.parent;
+            }
+        }
+
+        void AABBTree::removeLeaf(int32_t leaf)
+        {
+            if (leaf == root)
+            {
+                root = NULL_NODE;
+                return;
+            }
+
+            int32_t parent = nodes[leaf].parent;
+            int32_t grandParent = nodes[parent].parent;
+            int32_t sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+            if (grandParent != NULL_NODE)
+            {
+                // replace the parent with the sibling
+                if (nodes[grandParent].child1 == parent)
+                    nodes[grandParent].child1 = sibling;
+                else
+                    nodes[grandParent].child2 = sibling;
+
+                nodes[sibling].parent = grandParent;
+                freeNode(parent);
+
+                int32_t index = grandParent;
+
+                while (index != NULL_NODE)
+                {
+                    index = balance(index);
+
+                    Node& node = nodes[index];
+                    node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+                    node.box = combine(nodes[node.child1].box, nodes[node.child2].box);
+
+                    index = node.parent;
+                }
+            }
+            else
+            {
+                root = sibling;
+                nodes[sibling].parent = NULL_NODE;
+                freeNode(parent);
+            }
+        }
+
+        // performs a left or right rotation if the subtree of node is imbalanced, returns the new root of the subtree
+        int32_t AABBTree::balance(int32_t iA)
+        {
+            Node& a = nodes[iA];
+
+            if (a.isLeaf() || a.height < 2) return iA;
+
+            int32_t iB = a.child1;
+            int32_t iC = a.child2;
+            Node& b = nodes[iB];
+            Node& c = nodes[iC];
+
+            int32_t heightDifference = c.height - b.height;
+
+            // rotate c up
+            if (heightDifference > 1)
+            {
+                int32_t iF = c.child1;
+                int32_t iG = c.child2;
+                Node& f = nodes[iF];
+                Node& g = nodes[iG];
+
+                c.child1 = iA;
+                c.parent = a.parent;
+                a.parent = iC;
+
+                if (c.parent != NULL_NODE)
+                {
+                    if (nodes[c.parent].child1 == iA)
+                        nodes[c.parent].child1 = iC;
+                    else
+                        nodes[c.parent].child2 = iC;
+                }
+                else
+                {
+                    root = iC;
+                }
+
+                if (f.height > g.height)
+                {
+                    c.child2 = iF;
+                    a.child2 = iG;
+                    g.parent = iA;
+                    a.box = combine(b.box, g.box);
+                    c.box = combine(a.box, f.box);
+                    a.height = 1 + std::max(b.height, g.height);
+                    c.height = 1 + std::max(a.height, f.height);
+                }
+                else
+                {
+                    c.child2 = iG;
+                    a.child2 = iF;
+                    f.parent = iA;
+                    a.box = combine(b.box, f.box);
+                    c.box = combine(a.box, g.box);
+                    a.height = 1 + std::max(b.height, f.height);
+                    c.height = 1 + std::max(a.height, g.height);
+                }
+
+                return iC;
+            }
+
+            // rotate b up
+            if (heightDifference < -1)
+            {
+                int32_t iD = b.child1;
+                int32_t iE = b.child2;
+                Node& d = nodes[iD];
+                Node& e = nodes[iE];
+
+                b.child1 = iA;
+                b.parent = a.parent;
+                a.parent = iB;
+
+                if (b.parent != NULL_NODE)
+                {
+                    if (nodes[b.parent].child1 == iA)
+                        nodes[b.parent].child1 = iB;
+                    else
+                        nodes[b.parent].child2 = iB;
+                }
+                else
+                {
+                    root = iB;
+                }
+
+                if (d.height > e.height)
+                {
+                    b.child2 = iD;
+                    a.child1 = iE;
+                    e.parent = iA;
+                    a.box = combine(c.box, e.box);
+                    b.box = combine(a.box, d.box);
+                    a.height = 1 + std::max(c.height, e.height);
+                    b.height = 1 + std::max(a.height, d.height);
+                }
+                else
+                {
+                    b.child2 = iE;
+                    a.child1 = iD;
+                    d.parent = iA;
+                    a.box = combine(c.box, d.box);
+                    b.box = combine(a.box, e.box);
+                    a.height = 1 + std::max(c.height, d.height);
+                    b.height = 1 + std::max(a.height, e.height);
+                }
+
+                return iB;
+            }
+
+            return iA;
+        }
+    } // namespace scene
+} // namespace ouzel
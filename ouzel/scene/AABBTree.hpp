@@ -0,0 +1,67 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "math/Box3.hpp"
+
+namespace ouzel
+{
+    namespace scene
+    {
+        class Actor;
+
+        // dynamic bounding volume hierarchy, leaves store enlarged boxes so that small movements don't need an update
+        class AABBTree final
+        {
+        public:
+            static const int32_t NULL_NODE = -1;
+
+            AABBTree() {}
+
+            AABBTree(const AABBTree&) = delete;
+            AABBTree& operator=(const AABBTree&) = delete;
+
+            AABBTree(AABBTree&&) = delete;
+            AABBTree& operator=(AABBTree&&) = delete;
+
+            int32_t createProxy(const Box3& box, Actor* actor);
+            void destroyProxy(int32_t proxy);
+            bool moveProxy(int32_t proxy, const Box3& box); // returns true if the proxy was reinserted
+
+            inline Actor* getActor(int32_t proxy) const { return nodes[proxy].actor; }
+            inline const Box3& getBox(int32_t proxy) const { return nodes[proxy].box; }
+            inline int32_t getHeight() const { return (root == NULL_NODE) ? 0 : nodes[root].height; }
+
+            // safe to call from multiple threads as long as the tree is not modified
+            void query(const Box3& box, std::vector<Actor*>& result) const;
+            void clear();
+
+        private:
+            struct Node
+            {
+                Box3 box;
+                Actor* actor = nullptr;
+                int32_t parent = NULL_NODE; // next free node for nodes in the free list
+                int32_t child1 = NULL_NODE;
+                int32_t child2 = NULL_NODE;
+                int32_t height = -1; // 0 for leaves, -1 for free nodes
+
+                inline bool isLeaf() const { return child1 == NULL_NODE; }
+            };
+
+            int32_t allocateNode();
+            void freeNode(int32_t node);
+
+            void insertLeaf(int32_t leaf);
+            void removeLeaf(int32_t leaf);
+            int32_t balance(int32_t node);
+
+            std::vector<Node> nodes;
+            int32_t root = NULL_NODE;
+            int32_t freeList = NULL_NODE;
+        };
+    } // namespace scene
+} // namespace ouzel
@@ -28,10 +28,9 @@ namespace ouzel
             }
         }
 
-        void Actor::visit(std::vector<Actor*>& drawQueue,
+        void Actor::visit(std::vector<Actor*>& actors,
                           const Matrix4& newParentTransform,
                           bool parentTransformDirty,
-                          Camera* camera,
                           int32_t parentOrder,
                           bool parentHidden)
         {
@@ -48,29 +47,26 @@ namespace ouzel
                 calculateTransform();
             }
 
-            if (!worldHidden)
-            {
-                Box3 boundingBox = getBoundingBox();
-
-                if (cullDisabled || (!boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox)))
-                {
-                    auto upperBound = std::upper_bound(drawQueue.begin(), drawQueue.end(), this,
-                                                       [](Actor* a, Actor* b) {
-                                                           return a->worldOrder > b->worldOrder;
-                                                       });
-
-                    drawQueue.insert(upperBound, this);
-                }
-            }
+            visitIndex = static_cast<uint32_t>(actors.size());
+            actors.push_back(this);
 
             for (Actor* actor : children)
             {
-                actor->visit(drawQueue, transform, updateChildrenTransform, camera, worldOrder, worldHidden);
+                actor->visit(actors, transform, updateChildrenTransform, worldOrder, worldHidden);
             }
 
             updateChildrenTransform = false;
         }
 
+        bool Actor::checkVisibility(const Camera* camera) const
+        {
+            if (cullDisabled) return true;
+
+            Box3 boundingBox = getBoundingBox();
+
+            return !boundingBox.isEmpty() && camera->checkVisibility(getTransform(), boundingBox);
+        }
+
         void Actor::draw(Camera* camera, bool wireframe)
         {
             if (transformDirty)
@@ -235,6 +231,8 @@ namespace ouzel
             {
                 component->updateTransform();
             }
+
+            markSpatialIndexDirty();
         }
 
         void Actor::updateTransform(const Matrix4& newParentTransform)
@@ -245,6 +243,17 @@ namespace ouzel
             {
                 component->updateTransform();
             }
+
+            markSpatialIndexDirty();
+        }
+
+        void Actor::markSpatialIndexDirty()
+        {
+            if (dirtyActorIndex == -1 && layer && layer->spatialIndexEnabled)
+            {
+                dirtyActorIndex = static_cast<int32_t>(layer->dirtyActors.size());
+                layer->dirtyActors.push_back(this);
+            }
         }
 
         Vector3 Actor::getWorldPosition() const
@@ -319,6 +328,8 @@ namespace ouzel
 
             component->setActor(this);
             components.push_back(component);
+
+            markSpatialIndexDirty();
         }
 
         bool Actor::removeChildComponent(Component* component)
@@ -332,6 +343,8 @@ namespace ouzel
                 component->setActor(nullptr);
                 components.erase(componentIterator);
                 result = true;
+
+                markSpatialIndexDirty();
             }
 
             std::vector<std::unique_ptr<Component>>::iterator ownedIterator = std::find_if(ownedComponents.begin(), ownedComponents.end(), [component](const std::unique_ptr<Component>& other) {
@@ -350,16 +363,22 @@ namespace ouzel
         {
             components.clear();
             ownedComponents.clear();
+
+            markSpatialIndexDirty();
         }
 
         void Actor::setLayer(Layer* newLayer)
         {
+            if (layer && layer != newLayer) layer->removeFromSpatialIndex(this);
+
             ActorContainer::setLayer(newLayer);
 
             for (Component* component : components)
             {
                 component->setLayer(newLayer);
             }
+
+            markSpatialIndexDirty();
         }
 
         std::vector<Component*> Actor::getComponents(uint32_t type) const
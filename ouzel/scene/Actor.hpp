@@ -4,6 +4,7 @@
 #pragma once
 
 #include "scene/ActorContainer.hpp"
+#include "scene/AABBTree.hpp"
 #include "core/UpdateCallback.hpp"
 #include "math/Box3.hpp"
 #include "math/Color.hpp"
@@ -23,17 +24,18 @@ namespace ouzel
         class Actor: public ActorContainer
         {
             friend ActorContainer;
+            friend Component;
             friend Layer;
         public:
             Actor();
             virtual ~Actor();
 
-            virtual void visit(std::vector<Actor*>& drawQueue,
+            virtual void visit(std::vector<Actor*>& actors,
                                const Matrix4& newParentTransform,
                                bool parentTransformDirty,
-                               Camera* camera,
                                int32_t parentOrder,
                                bool parentHidden);
+            virtual bool checkVisibility(const Camera* camera) const;
             virtual void draw(Camera* camera, bool wireframe);
 
             virtual void setPosition(const Vector2& newPosition);
@@ -65,7 +67,10 @@ namespace ouzel
             virtual bool isPickable() const { return pickable; }
 
             virtual bool isCullDisabled() const { return cullDisabled; }
-            virtual void setCullDisabled(bool newCullDisabled) { cullDisabled = newCullDisabled; }
+            virtual void setCullDisabled(bool newCullDisabled) { cullDisabled = newCullDisabled; markSpatialIndexDirty(); }
+
+            virtual bool isBatchingDisabled() const { return batchingDisabled; }
+            virtual void setBatchingDisabled(bool newBatchingDisabled) { batchingDisabled = newBatchingDisabled; }
 
             virtual void setHidden(bool newHidden);
             virtual bool isHidden() const { return hidden; }
@@ -155,6 +160,9 @@ namespace ouzel
             void updateLocalTransform();
             void updateTransform(const Matrix4& newParentTransform);
 
+            // queues the actor for a spatial index update in the next draw of its layer
+            void markSpatialIndexDirty();
+
             virtual void calculateLocalTransform() const;
             virtual void calculateTransform() const;
 
@@ -175,6 +183,7 @@ namespace ouzel
 
             bool pickable = false;
             bool cullDisabled = false;
+            bool batchingDisabled = false;
             bool hidden = false;
             bool worldHidden = false;
 
@@ -185,6 +194,10 @@ namespace ouzel
             int32_t order = 0;
             int32_t worldOrder = 0;
 
+            uint32_t visitIndex = 0; // position in the last traversal of the layer
+            int32_t spatialIndexProxy = AABBTree::NULL_NODE;
+            int32_t dirtyActorIndex = -1; // position in the dirty actors of the layer
+
             ActorContainer* parent = nullptr;
 
             std::vector<Component*> components;
@@ -101,6 +101,7 @@ namespace ouzel
             {
                 if (entered) actor->leave();
                 actor->parent = nullptr;
+                actor->setLayer(nullptr);
             }
 
             children.clear();
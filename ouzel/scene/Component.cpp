@@ -32,6 +32,20 @@ namespace ouzel
         {
         }
 
+        uint32_t Component::calculateSortKey(const graphics::Shader* shader,
+                                             const graphics::Texture* texture,
+                                             const graphics::BlendState* blendState)
+        {
+            // bit 31: blending, bits 20-30: shader, bits 8-19: texture, bits 0-7: blend state
+            // collisions only cost an extra state change, the draw order stays correct
+            uint32_t shaderBits = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(shader) >> 4) & 0x7FF;
+            uint32_t textureBits = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(texture) >> 4) & 0xFFF;
+            uint32_t blendStateBits = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(blendState) >> 4) & 0xFF;
+            uint32_t blendingBit = (blendState && blendState->isBlendingEnabled()) ? 0x80000000 : 0;
+
+            return blendingBit | (shaderBits << 20) | (textureBits << 8) | blendStateBits;
+        }
+
         bool Component::pointOn(const Vector2& position) const
         {
             return boundingBox.containsPoint(position);
@@ -115,5 +129,10 @@ namespace ouzel
         void Component::updateTransform()
         {
         }
+
+        void Component::markBoundingBoxDirty()
+        {
+            if (actor) actor->markSpatialIndexDirty();
+        }
     } // namespace scene
 } // namespace ouzel
@@ -9,6 +9,8 @@
 #include "math/Matrix4.hpp"
 #include "math/Color.hpp"
 #include "math/Rect.hpp"
+#include "graphics/BlendState.hpp"
+#include "graphics/Shader.hpp"
 #include "graphics/Texture.hpp"
 
 namespace ouzel
@@ -60,14 +62,17 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle);
 
-            virtual void setBoundingBox(const Box3& newBoundingBox) { boundingBox = newBoundingBox; }
+            virtual void setBoundingBox(const Box3& newBoundingBox) { boundingBox = newBoundingBox; markBoundingBoxDirty(); }
             virtual const Box3& getBoundingBox() const { return boundingBox; }
 
+            // render state of the component, used by layers to group draw calls
+            virtual uint32_t getSortKey() const { return 0; }
+
             virtual bool pointOn(const Vector2& position) const;
             virtual bool shapeOverlaps(const std::vector<Vector2>& edges) const;
 
             bool isHidden() const { return hidden; }
-            void setHidden(bool newHidden) { hidden = newHidden; }
+            void setHidden(bool newHidden) { hidden = newHidden; markBoundingBoxDirty(); }
 
             inline Actor* getActor() const { return actor; }
             void removeFromActor();
@@ -77,6 +82,13 @@ namespace ouzel
             virtual void setLayer(Layer* newLayer);
             virtual void updateTransform();
 
+            // must be called after the bounding box changes, so that the spatial index of the layer is updated
+            void markBoundingBoxDirty();
+
+            static uint32_t calculateSortKey(const graphics::Shader* shader,
+                                             const graphics::Texture* texture,
+                                             const graphics::BlendState* blendState);
+
             uint32_t type;
 
             Box3 boundingBox;
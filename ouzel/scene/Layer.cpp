@@ -2,6 +2,7 @@
 // This file is part of the Ouzel engine.
 
 #include <algorithm>
+#include <limits>
 #include "Layer.hpp"
 #include "core/Engine.hpp"
 #include "Actor.hpp"
@@ -15,13 +16,69 @@ namespace ouzel
 {
     namespace scene
     {
+        static const uint32_t CULL_BATCH_SIZE = 256;
+
         Layer::Layer()
         {
             layer = this;
         }
 
+        static Box3 getWorldBoundingBox(const Actor* actor)
+        {
+            Box3 result;
+            Box3 boundingBox = actor->getBoundingBox();
+
+            if (!boundingBox.isEmpty())
+            {
+                Vector3 corners[8];
+                boundingBox.getCorners(corners);
+
+                for (Vector3& corner : corners)
+                {
+                    actor->getTransform().transformPoint(corner);
+                    result.insertPoint(corner);
+                }
+            }
+
+            return result;
+        }
+
+        static Box3 getViewBoundingBox(const Camera* camera)
+        {
+            Box3 result;
+            const Matrix4& inverseViewProjection = camera->getInverseViewProjection();
+
+            for (float x : {-1.0f, 1.0f})
+            {
+                for (float y : {-1.0f, 1.0f})
+                {
+                    for (float z : {0.0f, 1.0f})
+                    {
+                        Vector4 corner;
+                        inverseViewProjection.transformVector(Vector4(x, y, z, 1.0f), corner);
+                        result.insertPoint(Vector3(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w));
+                    }
+                }
+            }
+
+            // orthographic cameras don't cull by depth
+            if (camera->getType() == Camera::Type::ORTHOGRAPHIC)
+            {
+                result.min.z = std::numeric_limits<float>::lowest();
+                result.max.z = std::numeric_limits<float>::max();
+            }
+
+            return result;
+        }
+
         Layer::~Layer()
         {
+            // remove the actors from the spatial index while the layer is still intact
+            for (Actor* actor : children)
+            {
+                actor->setLayer(nullptr);
+            }
+
             if (scene) scene->removeLayer(this);
 
             for (Camera* camera : cameras)
@@ -32,27 +89,395 @@ namespace ouzel
 
         void Layer::draw()
         {
+            // world transforms are updated once for all cameras
+            visitedActors.clear();
+
+            for (Actor* actor : children)
+            {
+                actor->visit(visitedActors, Matrix4::IDENTITY, false, 0, false);
+            }
+
             for (Camera* camera : cameras)
             {
-                std::vector<Actor*> drawQueue;
+                // calculate the view projection before it is read by multiple threads
+                camera->getViewProjection();
+                if (spatialIndexEnabled) camera->getInverseViewProjection();
+            }
+
+            uint32_t batchCount;
+
+            if (spatialIndexEnabled)
+            {
+                updateSpatialIndex();
 
-                for (Actor* actor : children)
+                // each job queries the spatial index for one camera
+                batchCount = 1;
+                if (cullQueues.size() < cameras.size()) cullQueues.resize(cameras.size());
+
+                if (JobSystem* jobSystem = engine->getJobSystem())
+                {
+                    jobSystem->parallelFor(static_cast<uint32_t>(cameras.size()),
+                                           std::bind(&Layer::querySpatialIndex, this,
+                                                     std::placeholders::_1, std::placeholders::_2));
+                }
+                else
                 {
-                    actor->visit(drawQueue, Matrix4::IDENTITY, false, camera, 0, false);
+                    querySpatialIndex(0, static_cast<uint32_t>(cameras.size()));
                 }
+            }
+            else
+            {
+                // each job culls a batch of actors for one camera into its own list
+                batchCount = static_cast<uint32_t>((visitedActors.size() + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE);
+                uint32_t jobCount = batchCount * static_cast<uint32_t>(cameras.size());
+
+                if (cullQueues.size() < jobCount) cullQueues.resize(jobCount);
 
-                for (Actor* actor : drawQueue)
+                // a single batch is not worth handing to the workers
+                JobSystem* jobSystem = engine->getJobSystem();
+
+                if (jobSystem && jobCount > 1)
+                {
+                    jobSystem->parallelFor(jobCount,
+                                           std::bind(&Layer::cull, this, batchCount,
+                                                     std::placeholders::_1, std::placeholders::_2));
+                }
+                else
                 {
-                    actor->draw(camera, false);
+                    cull(batchCount, 0, jobCount);
+                }
+            }
+
+            for (uint32_t cameraIndex = 0; cameraIndex < cameras.size(); ++cameraIndex)
+            {
+                Camera* camera = cameras[cameraIndex];
+
+                // merge in the order of traversal, so that the result does not depend on scheduling
+                drawQueue.clear();
+
+                for (uint32_t batch = 0; batch < batchCount; ++batch)
+                {
+                    const std::vector<Actor*>& cullQueue = cullQueues[cameraIndex * batchCount + batch];
+                    drawQueue.insert(drawQueue.end(), cullQueue.begin(), cullQueue.end());
+                }
+
+                sortDrawQueue();
+
+                for (const DrawEntry& drawEntry : drawEntries)
+                {
+                    drawEntry.actor->draw(camera, false);
 
                     if (camera->getWireframe())
                     {
-                        actor->draw(camera, true);
+                        drawEntry.actor->draw(camera, true);
                     }
                 }
             }
         }
 
+        void Layer::cull(uint32_t batchCount, uint32_t begin, uint32_t end)
+        {
+            for (uint32_t job = begin; job < end; ++job)
+            {
+                const Camera* camera = cameras[job / batchCount];
+                size_t first = (job % batchCount) * CULL_BATCH_SIZE;
+                size_t last = std::min(first + CULL_BATCH_SIZE, visitedActors.size());
+
+                std::vector<Actor*>& cullQueue = cullQueues[job];
+                cullQueue.clear();
+
+                for (size_t i = first; i < last; ++i)
+                {
+                    Actor* actor = visitedActors[i];
+
+                    if (!actor->worldHidden && actor->checkVisibility(camera))
+                    {
+                        cullQueue.push_back(actor);
+                    }
+                }
+            }
+        }
+
+        void Layer::updateSpatialIndex()
+        {
+            // only the actors whose transform, bounding box or culling changed since the last draw
+            for (Actor* actor : dirtyActors)
+            {
+                actor->dirtyActorIndex = -1;
+
+                Box3 boundingBox;
+                auto unculledIterator = std::find(unculledActors.begin(), unculledActors.end(), actor);
+
+                // cull disabled actors are drawn and picked without the index
+                if (actor->cullDisabled)
+                {
+                    if (unculledIterator == unculledActors.end()) unculledActors.push_back(actor);
+                }
+                else
+                {
+                    if (unculledIterator != unculledActors.end()) unculledActors.erase(unculledIterator);
+                    boundingBox = getWorldBoundingBox(actor);
+                }
+
+                if (boundingBox.isEmpty())
+                {
+                    if (actor->spatialIndexProxy != AABBTree::NULL_NODE)
+                    {
+                        spatialIndex.destroyProxy(actor->spatialIndexProxy);
+                        actor->spatialIndexProxy = AABBTree::NULL_NODE;
+                    }
+                }
+                else if (actor->spatialIndexProxy == AABBTree::NULL_NODE)
+                    actor->spatialIndexProxy = spatialIndex.createProxy(boundingBox, actor);
+                else
+                    spatialIndex.moveProxy(actor->spatialIndexProxy, boundingBox);
+            }
+
+            dirtyActors.clear();
+        }
+
+        void Layer::querySpatialIndex(uint32_t begin, uint32_t end)
+        {
+            for (uint32_t cameraIndex = begin; cameraIndex < end; ++cameraIndex)
+            {
+                const Camera* camera = cameras[cameraIndex];
+
+                std::vector<Actor*>& cullQueue = cullQueues[cameraIndex];
+                cullQueue.clear();
+
+                spatialIndex.query(getViewBoundingBox(camera), cullQueue);
+
+                // hidden actors keep their proxies, so that showing them doesn't touch the index
+                cullQueue.erase(std::remove_if(cullQueue.begin(), cullQueue.end(), [camera](Actor* actor) {
+                    return actor->worldHidden || !actor->checkVisibility(camera);
+                }), cullQueue.end());
+
+                for (Actor* actor : unculledActors)
+                {
+                    if (!actor->worldHidden) cullQueue.push_back(actor);
+                }
+
+                // restore the order of traversal
+                std::sort(cullQueue.begin(), cullQueue.end(), [](Actor* a, Actor* b) {
+                    return a->visitIndex < b->visitIndex;
+                });
+            }
+        }
+
+        void Layer::removeFromSpatialIndex(Actor* actor)
+        {
+            if (actor->dirtyActorIndex != -1)
+            {
+                Actor* lastActor = dirtyActors.back();
+                lastActor->dirtyActorIndex = actor->dirtyActorIndex;
+                dirtyActors[static_cast<size_t>(actor->dirtyActorIndex)] = lastActor;
+                dirtyActors.pop_back();
+
+                actor->dirtyActorIndex = -1;
+            }
+
+            auto unculledIterator = std::find(unculledActors.begin(), unculledActors.end(), actor);
+            if (unculledIterator != unculledActors.end()) unculledActors.erase(unculledIterator);
+
+            if (actor->spatialIndexProxy != AABBTree::NULL_NODE)
+            {
+                spatialIndex.destroyProxy(actor->spatialIndexProxy);
+                actor->spatialIndexProxy = AABBTree::NULL_NODE;
+            }
+        }
+
+        void Layer::resetSpatialIndexProxies(const std::vector<Actor*>& actors)
+        {
+            for (Actor* actor : actors)
+            {
+                actor->spatialIndexProxy = AABBTree::NULL_NODE;
+                actor->dirtyActorIndex = -1;
+                resetSpatialIndexProxies(actor->getChildren());
+            }
+        }
+
+        void Layer::markSpatialIndexDirty(const std::vector<Actor*>& actors)
+        {
+            for (Actor* actor : actors)
+            {
+                actor->markSpatialIndexDirty();
+                markSpatialIndexDirty(actor->getChildren());
+            }
+        }
+
+        void Layer::setSpatialIndexEnabled(bool newSpatialIndexEnabled)
+        {
+            if (spatialIndexEnabled == newSpatialIndexEnabled) return;
+
+            spatialIndexEnabled = newSpatialIndexEnabled;
+
+            if (spatialIndexEnabled)
+            {
+                markSpatialIndexDirty(children);
+            }
+            else
+            {
+                spatialIndex.clear();
+                dirtyActors.clear();
+                unculledActors.clear();
+                resetSpatialIndexProxies(children);
+            }
+        }
+
+        bool Layer::isHiddenInLayer(const Actor* actor) const
+        {
+            // worldHidden is updated only when the layer is drawn
+            for (const ActorContainer* container = actor; container && container != this;)
+            {
+                const Actor* current = static_cast<const Actor*>(container);
+                if (current->isHidden()) return true;
+                container = current->getParent();
+            }
+
+            return false;
+        }
+
+        void Layer::getSpatialIndexCandidates(const Box3& box, std::vector<Actor*>& candidates) const
+        {
+            spatialIndex.query(box, candidates);
+
+            // the dirty actors were added or changed since the last draw, so their proxies can be missing or stale
+            candidates.insert(candidates.end(), dirtyActors.begin(), dirtyActors.end());
+            candidates.insert(candidates.end(), unculledActors.begin(), unculledActors.end());
+
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            // same order as the recursive search
+            std::sort(candidates.begin(), candidates.end(), [](Actor* a, Actor* b) {
+                return a->visitIndex > b->visitIndex;
+            });
+        }
+
+        void Layer::findActors(const Vector2& position, std::vector<std::pair<Actor*, Vector3>>& actors) const
+        {
+            if (!spatialIndexEnabled)
+            {
+                ActorContainer::findActors(position, actors);
+                return;
+            }
+
+            std::vector<Actor*> candidates;
+            getSpatialIndexCandidates(Box3(Vector3(position.x, position.y, std::numeric_limits<float>::lowest()),
+                                           Vector3(position.x, position.y, std::numeric_limits<float>::max())), candidates);
+
+            for (Actor* actor : candidates)
+            {
+                if (actor->isPickable() && !isHiddenInLayer(actor) && actor->pointOn(position))
+                {
+                    std::pair<Actor*, ouzel::Vector3> result = std::make_pair(actor, actor->convertWorldToLocal(position));
+
+                    auto upperBound = std::upper_bound(actors.begin(), actors.end(), result,
+                                                       [](const std::pair<Actor*, Vector3>& a,
+                                                          const std::pair<Actor*, Vector3>& b) {
+                                                           return a.first->worldOrder < b.first->worldOrder;
+                                                       });
+
+                    actors.insert(upperBound, result);
+                }
+            }
+        }
+
+        void Layer::findActors(const std::vector<Vector2>& edges, std::vector<Actor*>& actors) const
+        {
+            if (!spatialIndexEnabled)
+            {
+                ActorContainer::findActors(edges, actors);
+                return;
+            }
+
+            Box3 box;
+            for (const Vector2& edge : edges)
+            {
+                box.insertPoint(Vector3(edge.x, edge.y, 0.0f));
+            }
+            box.min.z = std::numeric_limits<float>::lowest();
+            box.max.z = std::numeric_limits<float>::max();
+
+            std::vector<Actor*> candidates;
+            getSpatialIndexCandidates(box, candidates);
+
+            for (Actor* actor : candidates)
+            {
+                if (actor->isPickable() && !isHiddenInLayer(actor) && actor->shapeOverlaps(edges))
+                {
+                    auto upperBound = std::upper_bound(actors.begin(), actors.end(), actor,
+                                                       [](Actor* a, Actor* b) {
+                                                           return a->worldOrder < b->worldOrder;
+                                                       });
+
+                    actors.insert(upperBound, actor);
+                }
+            }
+        }
+
+        void Layer::sortDrawQueue()
+        {
+            drawEntries.clear();
+
+            for (Actor* actor : drawQueue)
+            {
+                // actors with higher world order are drawn first
+                uint64_t orderKey = ~(static_cast<uint32_t>(actor->worldOrder) ^ 0x80000000);
+                uint32_t stateKey = 0;
+
+                if (sortMode == SortMode::STATE)
+                {
+                    for (Component* component : actor->components)
+                    {
+                        if (!component->isHidden())
+                        {
+                            stateKey = component->getSortKey();
+                            break;
+                        }
+                    }
+
+                    // blended actors must keep the painter's order
+                    if (stateKey & 0x80000000) stateKey = 0x80000000;
+                }
+
+                drawEntries.push_back({(orderKey << 32) | stateKey, actor});
+            }
+
+            if (drawEntries.size() < 2) return;
+
+            // LSD radix sort, stable so that equal keys keep the order of traversal
+            sortBuffer.resize(drawEntries.size());
+
+            for (uint32_t shift = 0; shift < 64; shift += 8)
+            {
+                uint32_t offsets[256] = {0};
+
+                for (const DrawEntry& drawEntry : drawEntries)
+                {
+                    ++offsets[(drawEntry.key >> shift) & 0xFF];
+                }
+
+                // all keys have the same digit
+                if (offsets[(drawEntries.front().key >> shift) & 0xFF] == drawEntries.size()) continue;
+
+                uint32_t offset = 0;
+                for (uint32_t& count : offsets)
+                {
+                    uint32_t currentCount = count;
+                    count = offset;
+                    offset += currentCount;
+                }
+
+                for (const DrawEntry& drawEntry : drawEntries)
+                {
+                    sortBuffer[offsets[(drawEntry.key >> shift) & 0xFF]++] = drawEntry;
+                }
+
+                drawEntries.swap(sortBuffer);
+            }
+        }
+
         void Layer::addChildActor(Actor* actor)
         {
             ActorContainer::addChildActor(actor);
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <vector>
 #include "scene/ActorContainer.hpp"
+#include "scene/AABBTree.hpp"
 #include "math/Vector2.hpp"
 
 namespace ouzel
@@ -21,7 +22,14 @@ namespace ouzel
             friend Scene;
             friend Camera;
             friend Light;
+            friend Actor;
         public:
+            enum class SortMode
+            {
+                STABLE, // world order, then the order of traversal
+                STATE // like STABLE, but opaque actors with the same world order are grouped by render state
+            };
+
             Layer();
             virtual ~Layer();
 
@@ -36,6 +44,17 @@ namespace ouzel
             inline int32_t getOrder() const { return order; }
             void setOrder(int32_t newOrder);
 
+            inline SortMode getSortMode() const { return sortMode; }
+            inline void setSortMode(SortMode newSortMode) { sortMode = newSortMode; }
+
+            // bounding volume hierarchy used for culling and picking, it is updated only for the actors that changed,
+            // actors changed since the last draw are picked without it
+            inline bool isSpatialIndexEnabled() const { return spatialIndexEnabled; }
+            void setSpatialIndexEnabled(bool newSpatialIndexEnabled);
+
+            virtual void findActors(const Vector2& position, std::vector<std::pair<Actor*, Vector3>>& actors) const override;
+            virtual void findActors(const std::vector<Vector2>& edges, std::vector<Actor*>& actors) const override;
+
             inline Scene* getScene() const { return scene; }
             void removeFromScene();
 
@@ -51,12 +70,40 @@ namespace ouzel
             virtual void recalculateProjection();
             virtual void enter() override;
 
+            struct DrawEntry
+            {
+                uint64_t key;
+                Actor* actor;
+            };
+
+            void cull(uint32_t batchCount, uint32_t begin, uint32_t end);
+            void updateSpatialIndex();
+            void querySpatialIndex(uint32_t begin, uint32_t end);
+            void removeFromSpatialIndex(Actor* actor);
+            static void resetSpatialIndexProxies(const std::vector<Actor*>& actors);
+            static void markSpatialIndexDirty(const std::vector<Actor*>& actors);
+            bool isHiddenInLayer(const Actor* actor) const;
+            void getSpatialIndexCandidates(const Box3& box, std::vector<Actor*>& candidates) const;
+            void sortDrawQueue();
+
             Scene* scene = nullptr;
 
             std::vector<Camera*> cameras;
             std::vector<Light*> lights;
 
             int32_t order = 0;
+            SortMode sortMode = SortMode::STABLE;
+
+            bool spatialIndexEnabled = false;
+            AABBTree spatialIndex;
+            std::vector<Actor*> dirtyActors; // actors whose proxies have to be updated
+            std::vector<Actor*> unculledActors; // cull disabled actors, they don't have proxies
+
+            std::vector<Actor*> visitedActors;
+            std::vector<std::vector<Actor*>> cullQueues;
+            std::vector<Actor*> drawQueue;
+            std::vector<DrawEntry> drawEntries;
+            std::vector<DrawEntry> sortBuffer;
         };
     } // namespace scene
 } // namespace ouzel
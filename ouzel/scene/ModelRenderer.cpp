@@ -11,7 +11,7 @@ namespace ouzel
         ModelRenderer::ModelRenderer():
             Component(TYPE)
         {
-            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL);
+            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL_ID);
         }
 
         ModelRenderer::ModelRenderer(const ModelData& modelData):
@@ -34,6 +34,8 @@ namespace ouzel
             indexBuffer = modelData.indexBuffer;
             vertexBuffer = modelData.vertexBuffer;
 
+            markBoundingBoxDirty();
+
             return true;
         }
 
@@ -70,17 +72,16 @@ namespace ouzel
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
             float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
 
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+            pixelShaderConstants.resize(1);
+            pixelShaderConstants[0].assign(std::begin(colorVector), std::end(colorVector));
 
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+            vertexShaderConstants.resize(1);
+            vertexShaderConstants[0].assign(std::begin(modelViewProj.m), std::end(modelViewProj.m));
 
-            std::vector<std::shared_ptr<graphics::Texture>> textures;
-            if (wireframe) textures.push_back(whitePixelTexture);
-            else textures.assign(std::begin(material->textures), std::end(material->textures));
+            if (wireframe) drawTextures.assign(1, whitePixelTexture);
+            else drawTextures.assign(std::begin(material->textures), std::end(material->textures));
 
-            engine->getRenderer()->addDrawCommand(textures,
+            engine->getRenderer()->addDrawCommand(drawTextures,
                                                         material->shader,
                                                         pixelShaderConstants,
                                                         vertexShaderConstants,
@@ -98,5 +99,12 @@ namespace ouzel
                                                         scissorRectangle,
                                                         material->cullMode);
         }
+
+        uint32_t ModelRenderer::getSortKey() const
+        {
+            if (!material) return 0;
+
+            return calculateSortKey(material->shader.get(), material->textures[0].get(), material->blendState.get());
+        }
     } // namespace scene
 } // namespace ouzel
@@ -33,6 +33,8 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle) override;
 
+            virtual uint32_t getSortKey() const override;
+
             virtual const std::shared_ptr<graphics::Material>& getMaterial() const { return material; }
             virtual void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial) { material = newMaterial; }
 
@@ -43,6 +45,10 @@ namespace ouzel
             std::shared_ptr<graphics::Buffer> vertexBuffer;
 
             std::shared_ptr<graphics::Texture> whitePixelTexture;
+
+            std::vector<std::shared_ptr<graphics::Texture>> drawTextures;
+            std::vector<std::vector<float>> pixelShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
         };
     } // namespace scene
 } // namespace ouzel
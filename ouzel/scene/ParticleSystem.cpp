@@ -2,6 +2,7 @@
 // This file is part of the Ouzel engine.
 
 #include <cstdlib>
+#include <new>
 #include "core/Setup.h"
 #include "ParticleSystem.hpp"
 #include "core/Engine.hpp"
@@ -12,19 +13,35 @@
 #include "scene/Camera.hpp"
 #include "graphics/MeshBufferResource.hpp"
 #include "graphics/BufferResource.hpp"
+#include "graphics/RenderDevice.hpp"
 #include "utils/Utils.hpp"
 #include "math/MathUtils.hpp"
+#include "math/SIMD.hpp"
+#include "utils/Log.hpp"
 
 namespace ouzel
 {
     namespace scene
     {
+        static const uint32_t PARALLEL_BATCH_SIZE = 256;
+
+        // corners of a particle quad of size 1 and their texture coordinates
+        static const Vector2 QUAD_CORNERS[4] = {
+            Vector2(-0.5f, -0.5f), Vector2(0.5f, -0.5f), Vector2(-0.5f, 0.5f), Vector2(0.5f, 0.5f)
+        };
+
+        static const Vector2 QUAD_TEXTURE_COORDINATES[4] = {
+            Vector2(0.0f, 1.0f), Vector2(1.0f, 1.0f), Vector2(0.0f, 0.0f), Vector2(1.0f, 0.0f)
+        };
+
         ParticleSystem::ParticleSystem():
             Component(TYPE)
         {
-            shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
-            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
-            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL);
+            shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
+            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
+            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL_ID);
+
+            randomState = static_cast<uint32_t>(randomEngine()) | 1; // xorshift state must not be zero
 
             updateCallback.callback = std::bind(&ParticleSystem::update, this, std::placeholders::_1);
         }
@@ -79,19 +96,21 @@ namespace ouzel
 
                 float colorVector[] = {1.0f, 1.0f, 1.0f, opacity};
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+                drawTextures.assign(1, wireframe ? whitePixelTexture : texture);
+
+                pixelShaderConstants.resize(1);
+                pixelShaderConstants[0].assign(std::begin(colorVector), std::end(colorVector));
 
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(transform.m), std::end(transform.m)};
+                vertexShaderConstants.resize(1);
+                vertexShaderConstants[0].assign(std::begin(transform.m), std::end(transform.m));
 
-                engine->getRenderer()->addDrawCommand({wireframe ? whitePixelTexture : texture},
+                engine->getRenderer()->addDrawCommand(drawTextures,
                                                             shader,
                                                             pixelShaderConstants,
                                                             vertexShaderConstants,
                                                             blendState,
                                                             meshBuffer,
-                                                            particleCount * 6,
+                                                            instanced ? 6 : particleCount * 6,
                                                             graphics::Renderer::DrawMode::TRIANGLE_LIST,
                                                             0,
                                                             renderTarget,
@@ -101,10 +120,16 @@ namespace ouzel
                                                             wireframe,
                                                             scissorTest,
                                                             scissorRectangle,
-                                                            graphics::Renderer::CullMode::NONE);
+                                                            graphics::Renderer::CullMode::NONE,
+                                                            instanced ? particleCount : 0);
             }
         }
 
+        uint32_t ParticleSystem::getSortKey() const
+        {
+            return calculateSortKey(shader.get(), texture.get(), blendState.get());
+        }
+
         void ParticleSystem::update(float delta)
         {
             timeSinceUpdate += delta;
@@ -155,69 +180,28 @@ namespace ouzel
 
                 if (active)
                 {
+                    // particles are independent, so large systems are updated on all cores
+                    JobSystem* jobSystem = engine->getJobSystem();
+
+                    if (jobSystem && particleCount > PARALLEL_BATCH_SIZE)
+                    {
+                        jobSystem->parallelFor(particleCount,
+                                               std::bind(&ParticleSystem::updateParticles, this, UPDATE_STEP,
+                                                         std::placeholders::_1, std::placeholders::_2),
+                                               PARALLEL_BATCH_SIZE);
+                    }
+                    else
+                    {
+                        updateParticles(UPDATE_STEP, 0, particleCount);
+                    }
+
                     for (uint32_t counter = particleCount; counter > 0; --counter)
                     {
                         size_t i = counter - 1;
 
-                        particles[i].life -= UPDATE_STEP;
-
-                        if (particles[i].life >= 0.0f)
+                        if (particles.life[i] < 0.0f)
                         {
-                            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
-                            {
-                                Vector2 tmp, radial, tangential;
-
-                                // radial acceleration
-                                if (particles[i].position.x == 0.0f || particles[i].position.y == 0.0f)
-                                {
-                                    radial = particles[i].position;
-                                    radial.normalize();
-                                }
-                                tangential = radial;
-                                radial *= particles[i].radialAcceleration;
-
-                                // tangential acceleration
-                                std::swap(tangential.x, tangential.y);
-                                tangential.x *= - particles[i].tangentialAcceleration;
-                                tangential.y *= particles[i].tangentialAcceleration;
-
-                                // (gravity + radial + tangential) * UPDATE_STEP
-                                tmp.x = radial.x + tangential.x + particleSystemData.gravity.x;
-                                tmp.y = radial.y + tangential.y + particleSystemData.gravity.y;
-                                tmp.x *= UPDATE_STEP;
-                                tmp.y *= UPDATE_STEP;
-
-                                particles[i].direction.x += tmp.x;
-                                particles[i].direction.y += tmp.y;
-                                tmp.x = particles[i].direction.x * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                tmp.y = particles[i].direction.y * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                particles[i].position.x += tmp.x;
-                                particles[i].position.y += tmp.y;
-                            }
-                            else
-                            {
-                                particles[i].angle += particles[i].degreesPerSecond * UPDATE_STEP;
-                                particles[i].radius += particles[i].deltaRadius * UPDATE_STEP;
-                                particles[i].position.x = -cosf(particles[i].angle) * particles[i].radius;
-                                particles[i].position.y = -sinf(particles[i].angle) * particles[i].radius * particleSystemData.yCoordFlipped;
-                            }
-
-                            // color r,g,b,a
-                            particles[i].colorRed += particles[i].deltaColorRed * UPDATE_STEP;
-                            particles[i].colorGreen += particles[i].deltaColorGreen * UPDATE_STEP;
-                            particles[i].colorBlue += particles[i].deltaColorBlue * UPDATE_STEP;
-                            particles[i].colorAlpha += particles[i].deltaColorAlpha * UPDATE_STEP;
-
-                            // size
-                            particles[i].size += (particles[i].deltaSize * UPDATE_STEP);
-                            particles[i].size = std::max(0.0f, particles[i].size);
-
-                            // angle
-                            particles[i].rotation += particles[i].deltaRotation * UPDATE_STEP;
-                        }
-                        else
-                        {
-                            particles[i] = particles[particleCount - 1];
+                            particles.move(particleCount - 1, static_cast<uint32_t>(i));
                             particleCount--;
                         }
                     }
@@ -241,7 +225,7 @@ namespace ouzel
 
                         for (uint32_t i = 0; i < particleCount; i++)
                         {
-                            Vector3 position = particles[i].position;
+                            Vector3 position(particles.positionX[i], particles.positionY[i], 0.0f);
                             inverseTransform.transformPoint(position);
                             boundingBox.insertPoint(Vector2(position.x, position.y));
                         }
@@ -251,12 +235,97 @@ namespace ouzel
                 {
                     for (uint32_t i = 0; i < particleCount; i++)
                     {
-                        boundingBox.insertPoint(particles[i].position);
+                        boundingBox.insertPoint(Vector2(particles.positionX[i], particles.positionY[i]));
                     }
                 }
+
+                markBoundingBoxDirty();
             }
         }
 
+        void ParticleSystem::updateParticles(float step, uint32_t begin, uint32_t end)
+        {
+            uint32_t i = simulateParticles<SIMDVector>(step, begin, end);
+            simulateParticles<SIMDScalar>(step, i, end);
+        }
+
+        // processes particles in groups of T::SIZE and returns the index of the first unprocessed particle,
+        // dead particles are updated too, because they are removed right after the update
+        template<class T>
+        uint32_t ParticleSystem::simulateParticles(float step, uint32_t begin, uint32_t end)
+        {
+            typedef typename T::Vector Vector;
+
+            const Vector stepVector = T::set(step);
+            const Vector flippedStep = T::set(step * static_cast<float>(particleSystemData.yCoordFlipped));
+            const Vector gravityX = T::set(particleSystemData.gravity.x * step);
+            const Vector gravityY = T::set(particleSystemData.gravity.y * step);
+            const Vector tolerance = T::set(TOLERANCE);
+            const Vector zero = T::set(0.0f);
+
+            uint32_t i = begin;
+
+            for (; i + T::SIZE <= end; i += T::SIZE)
+            {
+                T::store(&particles.life[i], T::sub(T::load(&particles.life[i]), stepVector));
+
+                if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
+                {
+                    Vector positionX = T::load(&particles.positionX[i]);
+                    Vector positionY = T::load(&particles.positionY[i]);
+
+                    // normalized position, positions close to zero are left as they are
+                    Vector length = T::sqrt(T::add(T::mul(positionX, positionX), T::mul(positionY, positionY)));
+                    Vector radialX = T::select(T::greaterEqual(length, tolerance), T::div(positionX, length), positionX);
+                    Vector radialY = T::select(T::greaterEqual(length, tolerance), T::div(positionY, length), positionY);
+
+                    Vector radialAcceleration = T::load(&particles.radialAcceleration[i]);
+                    Vector tangentialAcceleration = T::load(&particles.tangentialAcceleration[i]);
+
+                    // (gravity + radial + tangential) * step, tangential is perpendicular to radial
+                    Vector directionX = T::load(&particles.directionX[i]);
+                    Vector directionY = T::load(&particles.directionY[i]);
+                    directionX = T::add(directionX, T::add(T::mul(T::sub(T::mul(radialX, radialAcceleration),
+                                                                         T::mul(radialY, tangentialAcceleration)), stepVector), gravityX));
+                    directionY = T::add(directionY, T::add(T::mul(T::add(T::mul(radialY, radialAcceleration),
+                                                                         T::mul(radialX, tangentialAcceleration)), stepVector), gravityY));
+                    T::store(&particles.directionX[i], directionX);
+                    T::store(&particles.directionY[i], directionY);
+
+                    T::store(&particles.positionX[i], T::add(positionX, T::mul(directionX, flippedStep)));
+                    T::store(&particles.positionY[i], T::add(positionY, T::mul(directionY, flippedStep)));
+                }
+                else
+                {
+                    Vector angle = T::add(T::load(&particles.angle[i]), T::mul(T::load(&particles.degreesPerSecond[i]), stepVector));
+                    Vector radius = T::add(T::load(&particles.radius[i]), T::mul(T::load(&particles.deltaRadius[i]), stepVector));
+                    T::store(&particles.angle[i], angle);
+                    T::store(&particles.radius[i], radius);
+
+                    Vector sine;
+                    Vector cosine;
+                    sinCos<T>(angle, sine, cosine);
+
+                    T::store(&particles.positionX[i], T::sub(zero, T::mul(cosine, radius)));
+                    T::store(&particles.positionY[i], T::sub(zero, T::mul(T::mul(sine, radius), T::set(static_cast<float>(particleSystemData.yCoordFlipped)))));
+                }
+
+                // color r,g,b,a
+                T::store(&particles.colorRed[i], T::add(T::load(&particles.colorRed[i]), T::mul(T::load(&particles.deltaColorRed[i]), stepVector)));
+                T::store(&particles.colorGreen[i], T::add(T::load(&particles.colorGreen[i]), T::mul(T::load(&particles.deltaColorGreen[i]), stepVector)));
+                T::store(&particles.colorBlue[i], T::add(T::load(&particles.colorBlue[i]), T::mul(T::load(&particles.deltaColorBlue[i]), stepVector)));
+                T::store(&particles.colorAlpha[i], T::add(T::load(&particles.colorAlpha[i]), T::mul(T::load(&particles.deltaColorAlpha[i]), stepVector)));
+
+                // size
+                T::store(&particles.size[i], T::max(zero, T::add(T::load(&particles.size[i]), T::mul(T::load(&particles.deltaSize[i]), stepVector))));
+
+                // angle
+                T::store(&particles.rotation[i], T::add(T::load(&particles.rotation[i]), T::mul(T::load(&particles.deltaRotation[i]), stepVector)));
+            }
+
+            return i;
+        }
+
         bool ParticleSystem::init(const ParticleSystemData& newParticleSystemData)
         {
             particleSystemData = newParticleSystemData;
@@ -276,7 +345,14 @@ namespace ouzel
 
         bool ParticleSystem::init(const std::string& filename)
         {
-            particleSystemData = engine->getCache()->getParticleSystemData(filename);
+            std::shared_ptr<const ParticleSystemData> data = engine->getCache()->getParticleSystemData(filename);
+
+            if (!data)
+            {
+                return false;
+            }
+
+            particleSystemData = *data;
 
             texture = particleSystemData.texture;
 
@@ -328,101 +404,294 @@ namespace ouzel
             finished = false;
         }
 
+        template<class T>
+        static std::vector<T> createQuadIndices(uint32_t quadCount)
+        {
+            std::vector<T> result;
+            result.reserve(quadCount * 6);
+
+            for (uint32_t i = 0; i < quadCount; ++i)
+            {
+                result.push_back(static_cast<T>(i * 4 + 0));
+                result.push_back(static_cast<T>(i * 4 + 1));
+                result.push_back(static_cast<T>(i * 4 + 2));
+                result.push_back(static_cast<T>(i * 4 + 1));
+                result.push_back(static_cast<T>(i * 4 + 3));
+                result.push_back(static_cast<T>(i * 4 + 2));
+            }
+
+            return result;
+        }
+
         bool ParticleSystem::createParticleMesh()
         {
-            indices.reserve(particleSystemData.maxParticles * 6);
-            vertices.reserve(particleSystemData.maxParticles * 4);
+            particles.resize(particleSystemData.maxParticles);
+
+            if (engine->getRenderer()->getDevice()->isInstancingSupported())
+            {
+                instanced = true;
+                shader = engine->getCache()->getShader(graphics::SHADER_PARTICLE_ID);
+
+                std::vector<graphics::Vertex> vertices;
+                for (uint32_t corner = 0; corner < 4; ++corner)
+                {
+                    vertices.push_back(graphics::Vertex(Vector3(QUAD_CORNERS[corner]), Color::WHITE,
+                                                        QUAD_TEXTURE_COORDINATES[corner], Vector3(0.0f, 0.0f, -1.0f)));
+                }
+
+                std::vector<uint16_t> indices = createQuadIndices<uint16_t>(1);
+
+                indexBuffer = std::make_shared<graphics::Buffer>();
+                indexBuffer->init(graphics::Buffer::Usage::INDEX, indices.data(), static_cast<uint32_t>(getVectorSize(indices)), 0);
 
-            for (uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+                vertexBuffer = std::make_shared<graphics::Buffer>();
+                vertexBuffer->init(graphics::Buffer::Usage::VERTEX, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)), 0);
+
+                // 20 bytes per particle instead of four 44 byte vertices
+                instanceBuffer = std::make_shared<graphics::Buffer>();
+                instanceBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC,
+                                     static_cast<uint32_t>(particleSystemData.maxParticles * sizeof(graphics::InstanceVertex)));
+
+                meshBuffer = std::make_shared<graphics::MeshBuffer>();
+                meshBuffer->init(sizeof(uint16_t), indexBuffer, vertexBuffer);
+                meshBuffer->setInstanceBuffer(instanceBuffer);
+
+                return true;
+            }
+
+            // four vertices per particle, so 16-bit indices are enough for up to 16384 particles
+            static const uint32_t MAX_PARTICLES_UINT16 = 65536 / 4;
+
+            if (particleSystemData.maxParticles > MAX_PARTICLES_UINT16 &&
+                !engine->getRenderer()->getDevice()->isUIntIndicesSupported())
             {
-                indices.push_back(i * 4 + 0);
-                indices.push_back(i * 4 + 1);
-                indices.push_back(i * 4 + 2);
-                indices.push_back(i * 4 + 1);
-                indices.push_back(i * 4 + 3);
-                indices.push_back(i * 4 + 2);
-
-                vertices.push_back(graphics::Vertex(Vector3(-1.0f, -1.0f, 0.0f), Color::WHITE,
-                                                    Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f)));
-                vertices.push_back(graphics::Vertex(Vector3(1.0f, -1.0f, 0.0f), Color::WHITE,
-                                                    Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f)));
-                vertices.push_back(graphics::Vertex(Vector3(-1.0f, 1.0f, 0.0f),  Color::WHITE,
-                                                    Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f)));
-                vertices.push_back(graphics::Vertex(Vector3(1.0f, 1.0f, 0.0f),  Color::WHITE,
-                                                    Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f)));
+                Log(Log::Level::WARN) << "32-bit indices are not supported, limiting particle count to " << MAX_PARTICLES_UINT16;
+                particleSystemData.maxParticles = MAX_PARTICLES_UINT16;
             }
 
+            uint32_t indexSize;
             indexBuffer = std::make_shared<graphics::Buffer>();
-            indexBuffer->init(graphics::Buffer::Usage::INDEX, indices.data(), static_cast<uint32_t>(getVectorSize(indices)), 0);
+
+            if (particleSystemData.maxParticles > MAX_PARTICLES_UINT16)
+            {
+                std::vector<uint32_t> indices = createQuadIndices<uint32_t>(particleSystemData.maxParticles);
+                indexBuffer->init(graphics::Buffer::Usage::INDEX, indices.data(), static_cast<uint32_t>(getVectorSize(indices)), 0);
+                indexSize = sizeof(uint32_t);
+            }
+            else
+            {
+                std::vector<uint16_t> indices = createQuadIndices<uint16_t>(particleSystemData.maxParticles);
+                indexBuffer->init(graphics::Buffer::Usage::INDEX, indices.data(), static_cast<uint32_t>(getVectorSize(indices)), 0);
+                indexSize = sizeof(uint16_t);
+            }
 
             vertexBuffer = std::make_shared<graphics::Buffer>();
-            vertexBuffer->init(graphics::Buffer::Usage::VERTEX, vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)), graphics::Buffer::DYNAMIC);
+            vertexBuffer->init(graphics::Buffer::Usage::VERTEX, graphics::Buffer::DYNAMIC,
+                               static_cast<uint32_t>(particleSystemData.maxParticles * 4 * sizeof(graphics::Vertex)));
 
             meshBuffer = std::make_shared<graphics::MeshBuffer>();
-            meshBuffer->init(sizeof(uint16_t), indexBuffer, vertexBuffer);
-
-            particles.resize(particleSystemData.maxParticles);
+            meshBuffer->init(indexSize, indexBuffer, vertexBuffer);
 
             return true;
         }
 
+        void ParticleSystem::Particles::resize(uint32_t newSize)
+        {
+            for (std::vector<float>* attribute : {&life, &positionX, &positionY,
+                                                  &colorRed, &colorGreen, &colorBlue, &colorAlpha,
+                                                  &deltaColorRed, &deltaColorGreen, &deltaColorBlue, &deltaColorAlpha,
+                                                  &angle, &size, &deltaSize, &rotation, &deltaRotation,
+                                                  &radialAcceleration, &tangentialAcceleration,
+                                                  &directionX, &directionY, &radius, &degreesPerSecond, &deltaRadius})
+            {
+                attribute->resize(newSize);
+            }
+        }
+
+        void ParticleSystem::Particles::move(uint32_t from, uint32_t to)
+        {
+            for (std::vector<float>* attribute : {&life, &positionX, &positionY,
+                                                  &colorRed, &colorGreen, &colorBlue, &colorAlpha,
+                                                  &deltaColorRed, &deltaColorGreen, &deltaColorBlue, &deltaColorAlpha,
+                                                  &angle, &size, &deltaSize, &rotation, &deltaRotation,
+                                                  &radialAcceleration, &tangentialAcceleration,
+                                                  &directionX, &directionY, &radius, &degreesPerSecond, &deltaRadius})
+            {
+                (*attribute)[to] = (*attribute)[from];
+            }
+        }
+
         bool ParticleSystem::updateParticleMesh()
         {
             if (actor)
             {
-                for (uint32_t counter = particleCount; counter > 0; --counter)
+                Vector2 offset;
+
+                if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
                 {
-                    size_t i = counter - 1;
+                    offset = actor->getPosition();
+                }
 
-                    Vector2 position;
+                if (instanced)
+                {
+                    graphics::InstanceVertex* instances = static_cast<graphics::InstanceVertex*>(instanceBuffer->map(static_cast<uint32_t>(particleCount * sizeof(graphics::InstanceVertex))));
 
-                    if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE)
+                    if (!instances)
                     {
-                        position = particles[i].position;
+                        return false;
                     }
-                    else if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+
+                    writeInstances(instances, offset);
+
+                    return instanceBuffer->unmap();
+                }
+
+                // only the vertices of live particles are uploaded, the rest of the buffer is not drawn
+                graphics::Vertex* vertices = static_cast<graphics::Vertex*>(vertexBuffer->map(static_cast<uint32_t>(particleCount * 4 * sizeof(graphics::Vertex))));
+
+                if (!vertices)
+                {
+                    return false;
+                }
+
+                expandParticles(vertices, offset);
+
+                if (!vertexBuffer->unmap())
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void ParticleSystem::expandParticles(graphics::Vertex* vertices, const Vector2& offset)
+        {
+            uint32_t i = expandParticles<SIMDVector>(vertices, offset, 0, particleCount);
+            expandParticles<SIMDScalar>(vertices, offset, i, particleCount);
+        }
+
+        // writes four vertices for each particle, returns the index of the first unprocessed particle
+        template<class T>
+        uint32_t ParticleSystem::expandParticles(graphics::Vertex* vertices, const Vector2& offset, uint32_t begin, uint32_t end)
+        {
+            typedef typename T::Vector Vector;
+
+            const Vector offsetX = T::set(offset.x);
+            const Vector offsetY = T::set(offset.y);
+            const Vector half = T::set(0.5f);
+            const Vector degreesToRadians = T::set(-TAU / 360.0f);
+            const Vector zero = T::set(0.0f);
+            const Vector one = T::set(1.0f);
+            const Vector colorScale = T::set(255.0f);
+
+            float x[4][T::SIZE];
+            float y[4][T::SIZE];
+            float color[4][T::SIZE];
+
+            uint32_t i = begin;
+
+            for (; i + T::SIZE <= end; i += T::SIZE)
+            {
+                Vector positionX = T::add(T::load(&particles.positionX[i]), offsetX);
+                Vector positionY = T::add(T::load(&particles.positionY[i]), offsetY);
+                Vector size = T::mul(T::load(&particles.size[i]), half);
+
+                Vector sine;
+                Vector cosine;
+                sinCos<T>(T::mul(T::load(&particles.rotation[i]), degreesToRadians), sine, cosine);
+
+                // corners of the rotated quad are combinations of these
+                Vector p = T::mul(size, cosine);
+                Vector q = T::mul(size, sine);
+
+                T::store(x[0], T::add(positionX, T::sub(q, p)));
+                T::store(y[0], T::sub(T::sub(positionY, q), p));
+                T::store(x[1], T::add(positionX, T::add(p, q)));
+                T::store(y[1], T::add(positionY, T::sub(q, p)));
+                T::store(x[2], T::sub(T::sub(positionX, p), q));
+                T::store(y[2], T::add(positionY, T::sub(p, q)));
+                T::store(x[3], T::add(positionX, T::sub(p, q)));
+                T::store(y[3], T::add(positionY, T::add(q, p)));
+
+                T::store(color[0], T::mul(T::min(T::max(T::load(&particles.colorRed[i]), zero), one), colorScale));
+                T::store(color[1], T::mul(T::min(T::max(T::load(&particles.colorGreen[i]), zero), one), colorScale));
+                T::store(color[2], T::mul(T::min(T::max(T::load(&particles.colorBlue[i]), zero), one), colorScale));
+                T::store(color[3], T::mul(T::min(T::max(T::load(&particles.colorAlpha[i]), zero), one), colorScale));
+
+                for (uint32_t lane = 0; lane < T::SIZE; ++lane)
+                {
+                    Color vertexColor(static_cast<uint8_t>(color[0][lane]),
+                                      static_cast<uint8_t>(color[1][lane]),
+                                      static_cast<uint8_t>(color[2][lane]),
+                                      static_cast<uint8_t>(color[3][lane]));
+
+                    graphics::Vertex* quad = &vertices[(i + lane) * 4];
+
+                    // the mapped memory is uninitialized
+                    for (uint32_t corner = 0; corner < 4; ++corner)
                     {
-                        position = actor->getPosition() + particles[i].position;
+                        new (&quad[corner]) graphics::Vertex(Vector3(x[corner][lane], y[corner][lane], 0.0f), vertexColor,
+                                                             QUAD_TEXTURE_COORDINATES[corner], Vector3(0.0f, 0.0f, -1.0f));
                     }
+                }
+            }
 
-                    float size_2 = particles[i].size / 2.0f;
-                    Vector2 v1(-size_2, -size_2);
-                    Vector2 v2(size_2, size_2);
+            return i;
+        }
 
-                    float r = -degToRad(particles[i].rotation);
-                    float cr = cosf(r);
-                    float sr = sinf(r);
+        void ParticleSystem::writeInstances(graphics::InstanceVertex* instances, const Vector2& offset)
+        {
+            uint32_t i = writeInstances<SIMDVector>(instances, offset, 0, particleCount);
+            writeInstances<SIMDScalar>(instances, offset, i, particleCount);
+        }
 
-                    Vector2 a(v1.x * cr - v1.y * sr, v1.x * sr + v1.y * cr);
-                    Vector2 b(v2.x * cr - v1.y * sr, v2.x * sr + v1.y * cr);
-                    Vector2 c(v2.x * cr - v2.y * sr, v2.x * sr + v2.y * cr);
-                    Vector2 d(v1.x * cr - v2.y * sr, v1.x * sr + v2.y * cr);
+        // writes the instance of each particle, the particle shader turns it into the same quad as expandParticles,
+        // returns the index of the first unprocessed particle
+        template<class T>
+        uint32_t ParticleSystem::writeInstances(graphics::InstanceVertex* instances, const Vector2& offset, uint32_t begin, uint32_t end)
+        {
+            typedef typename T::Vector Vector;
 
-                    Color color(static_cast<uint8_t>(particles[i].colorRed * 255),
-                                static_cast<uint8_t>(particles[i].colorGreen * 255),
-                                static_cast<uint8_t>(particles[i].colorBlue * 255),
-                                static_cast<uint8_t>(particles[i].colorAlpha * 255));
+            const Vector offsetX = T::set(offset.x);
+            const Vector offsetY = T::set(offset.y);
+            const Vector degreesToRadians = T::set(-TAU / 360.0f);
+            const Vector zero = T::set(0.0f);
+            const Vector one = T::set(1.0f);
+            const Vector colorScale = T::set(255.0f);
 
-                    vertices[i * 4 + 0].position = a + position;
-                    vertices[i * 4 + 0].color = color;
+            float x[T::SIZE];
+            float y[T::SIZE];
+            float rotation[T::SIZE];
+            float color[4][T::SIZE];
 
-                    vertices[i * 4 + 1].position = b + position;
-                    vertices[i * 4 + 1].color = color;
+            uint32_t i = begin;
 
-                    vertices[i * 4 + 2].position = d + position;
-                    vertices[i * 4 + 2].color = color;
+            for (; i + T::SIZE <= end; i += T::SIZE)
+            {
+                T::store(x, T::add(T::load(&particles.positionX[i]), offsetX));
+                T::store(y, T::add(T::load(&particles.positionY[i]), offsetY));
+                T::store(rotation, T::mul(T::load(&particles.rotation[i]), degreesToRadians));
 
-                    vertices[i * 4 + 3].position = c + position;
-                    vertices[i * 4 + 3].color = color;
-                }
+                T::store(color[0], T::mul(T::min(T::max(T::load(&particles.colorRed[i]), zero), one), colorScale));
+                T::store(color[1], T::mul(T::min(T::max(T::load(&particles.colorGreen[i]), zero), one), colorScale));
+                T::store(color[2], T::mul(T::min(T::max(T::load(&particles.colorBlue[i]), zero), one), colorScale));
+                T::store(color[3], T::mul(T::min(T::max(T::load(&particles.colorAlpha[i]), zero), one), colorScale));
 
-                if (!vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(getVectorSize(vertices))))
+                for (uint32_t lane = 0; lane < T::SIZE; ++lane)
                 {
-                    return false;
+                    // the mapped memory is uninitialized
+                    new (&instances[i + lane]) graphics::InstanceVertex(Vector2(x[lane], y[lane]),
+                                                                        particles.size[i + lane],
+                                                                        rotation[lane],
+                                                                        Color(static_cast<uint8_t>(color[0][lane]),
+                                                                              static_cast<uint8_t>(color[1][lane]),
+                                                                              static_cast<uint8_t>(color[2][lane]),
+                                                                              static_cast<uint8_t>(color[3][lane])));
                 }
             }
 
-            return true;
+            return i;
         }
 
         void ParticleSystem::emitParticles(uint32_t count)
@@ -451,67 +720,69 @@ namespace ouzel
                     {
                         if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
                         {
-                            particles[i].life = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f);
+                            particles.life[i] = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * getRandomValue(), 0.0f);
 
-                            particles[i].position = particleSystemData.sourcePosition + position + Vector2(particleSystemData.sourcePositionVariance.x * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine),
-                                                                                                             particleSystemData.sourcePositionVariance.y * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine));
+                            particles.positionX[i] = particleSystemData.sourcePosition.x + position.x + particleSystemData.sourcePositionVariance.x * getRandomValue();
+                            particles.positionY[i] = particleSystemData.sourcePosition.y + position.y + particleSystemData.sourcePositionVariance.y * getRandomValue();
 
-                            particles[i].size = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f);
+                            particles.size[i] = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * getRandomValue(), 0.0f);
 
-                            float finishSize = fmaxf(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f);
-                            particles[i].deltaSize = (finishSize - particles[i].size) / particles[i].life;
+                            float finishSize = fmaxf(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * getRandomValue(), 0.0f);
+                            particles.deltaSize[i] = (finishSize - particles.size[i]) / particles.life[i];
 
-                            particles[i].colorRed = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            particles[i].colorGreen = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            particles[i].colorBlue = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            particles[i].colorAlpha = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
+                            particles.colorRed[i] = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * getRandomValue(), 0.0f, 1.0f);
+                            particles.colorGreen[i] = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * getRandomValue(), 0.0f, 1.0f);
+                            particles.colorBlue[i] = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * getRandomValue(), 0.0f, 1.0f);
+                            particles.colorAlpha[i] = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * getRandomValue(), 0.0f, 1.0f);
 
-                            float finishColorRed = clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            float finishColorGreen = clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            float finishColorBlue = clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
-                            float finishColorAlpha = clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine), 0.0f, 1.0f);
+                            float finishColorRed = clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * getRandomValue(), 0.0f, 1.0f);
+                            float finishColorGreen = clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * getRandomValue(), 0.0f, 1.0f);
+                            float finishColorBlue = clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * getRandomValue(), 0.0f, 1.0f);
+                            float finishColorAlpha = clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * getRandomValue(), 0.0f, 1.0f);
 
-                            particles[i].deltaColorRed = (finishColorRed - particles[i].colorRed) / particles[i].life;
-                            particles[i].deltaColorGreen = (finishColorGreen - particles[i].colorGreen) / particles[i].life;
-                            particles[i].deltaColorBlue = (finishColorBlue - particles[i].colorBlue) / particles[i].life;
-                            particles[i].deltaColorAlpha = (finishColorAlpha - particles[i].colorAlpha) / particles[i].life;
+                            particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / particles.life[i];
+                            particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / particles.life[i];
+                            particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / particles.life[i];
+                            particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / particles.life[i];
 
                             //_particles[i].finishColor = finishColor;
 
-                            particles[i].rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
+                            particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * getRandomValue();
 
-                            float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
-                            particles[i].deltaRotation = (finishRotation - particles[i].rotation) / particles[i].life;
+                            float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * getRandomValue();
+                            particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / particles.life[i];
 
-                            particles[i].radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
-                            particles[i].tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
+                            particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * getRandomValue();
+                            particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * getRandomValue();
 
                             if (particleSystemData.rotationIsDir)
                             {
-                                float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine));
+                                float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * getRandomValue());
                                 Vector2 v(cosf(a), sinf(a));
-                                float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
+                                float s = particleSystemData.speed + particleSystemData.speedVariance * getRandomValue();
                                 Vector2 dir = v * s;
-                                particles[i].direction = dir;
-                                particles[i].rotation = -radToDeg(dir.getAngle());
+                                particles.directionX[i] = dir.x;
+                                particles.directionY[i] = dir.y;
+                                particles.rotation[i] = -radToDeg(dir.getAngle());
                             }
                             else
                             {
-                                float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine));
+                                float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * getRandomValue());
                                 Vector2 v(cosf(a), sinf(a));
-                                float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
+                                float s = particleSystemData.speed + particleSystemData.speedVariance * getRandomValue();
                                 Vector2 dir = v * s;
-                                particles[i].direction = dir;
+                                particles.directionX[i] = dir.x;
+                                particles.directionY[i] = dir.y;
                             }
                         }
                         else
                         {
-                            particles[i].radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
-                            particles[i].angle = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine));
-                            particles[i].degreesPerSecond = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine));
+                            particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * getRandomValue();
+                            particles.angle[i] = degToRad(particleSystemData.angle + particleSystemData.angleVariance * getRandomValue());
+                            particles.degreesPerSecond[i] = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * getRandomValue());
 
-                            float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0f, 1.0f}(randomEngine);
-                            particles[i].deltaRadius = (endRadius - particles[i].radius) / particles[i].life;
+                            float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * getRandomValue();
+                            particles.deltaRadius[i] = (endRadius - particles.radius[i]) / particles.life[i];
                         }
                     }
 
@@ -41,6 +41,8 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle) override;
 
+            virtual uint32_t getSortKey() const override;
+
             bool init(const ParticleSystemData& newParticleSystemData);
             bool init(const std::string& filename);
 
@@ -56,12 +58,27 @@ namespace ouzel
 
         protected:
             void update(float delta);
+            void updateParticles(float step, uint32_t begin, uint32_t end);
+            template<class T> uint32_t simulateParticles(float step, uint32_t begin, uint32_t end);
+            void expandParticles(graphics::Vertex* vertices, const Vector2& offset);
+            template<class T> uint32_t expandParticles(graphics::Vertex* vertices, const Vector2& offset, uint32_t begin, uint32_t end);
+            void writeInstances(graphics::InstanceVertex* instances, const Vector2& offset);
+            template<class T> uint32_t writeInstances(graphics::InstanceVertex* instances, const Vector2& offset, uint32_t begin, uint32_t end);
 
             bool createParticleMesh();
             bool updateParticleMesh();
 
             void emitParticles(uint32_t count);
 
+            // xorshift, returns a value in the range [-1, 1)
+            inline float getRandomValue()
+            {
+                randomState ^= randomState << 13;
+                randomState ^= randomState >> 17;
+                randomState ^= randomState << 5;
+                return static_cast<float>(randomState >> 8) / 8388608.0f - 1.0f;
+            }
+
             ParticleSystemData particleSystemData;
 
             std::shared_ptr<graphics::Shader> shader;
@@ -69,48 +86,56 @@ namespace ouzel
             std::shared_ptr<graphics::Texture> texture;
             std::shared_ptr<graphics::Texture> whitePixelTexture;
 
-            struct Particle
+            // structure of arrays, so that the particles can be updated with vector instructions
+            struct Particles
             {
-                float life = 0.0f;
+                void resize(uint32_t newSize);
+                void move(uint32_t from, uint32_t to);
 
-                Vector2 position;
+                std::vector<float> life;
 
-                float colorRed = 0.0f;
-                float colorGreen = 0.0f;
-                float colorBlue = 0.0f;
-                float colorAlpha = 0.0f;
+                std::vector<float> positionX;
+                std::vector<float> positionY;
 
-                float deltaColorRed = 0.0f;
-                float deltaColorGreen = 0.0f;
-                float deltaColorBlue = 0.0f;
-                float deltaColorAlpha = 0.0f;
+                std::vector<float> colorRed;
+                std::vector<float> colorGreen;
+                std::vector<float> colorBlue;
+                std::vector<float> colorAlpha;
 
-                float angle = 0.0f;
-                float speed = 0.0f;
+                std::vector<float> deltaColorRed;
+                std::vector<float> deltaColorGreen;
+                std::vector<float> deltaColorBlue;
+                std::vector<float> deltaColorAlpha;
 
-                float size = 0.0f;
-                float deltaSize = 0.0f;
+                std::vector<float> angle;
 
-                float rotation = 0.0f;
-                float deltaRotation = 0.0f;
+                std::vector<float> size;
+                std::vector<float> deltaSize;
 
-                float radialAcceleration = 0.0f;
-                float tangentialAcceleration = 0.0f;
+                std::vector<float> rotation;
+                std::vector<float> deltaRotation;
 
-                Vector2 direction;
-                float radius = 0.0f;
-                float degreesPerSecond = 0.0f;
-                float deltaRadius = 0.0f;
+                std::vector<float> radialAcceleration;
+                std::vector<float> tangentialAcceleration;
+
+                std::vector<float> directionX;
+                std::vector<float> directionY;
+                std::vector<float> radius;
+                std::vector<float> degreesPerSecond;
+                std::vector<float> deltaRadius;
             };
 
-            std::vector<Particle> particles;
+            Particles particles;
 
             std::shared_ptr<graphics::MeshBuffer> meshBuffer;
             std::shared_ptr<graphics::Buffer> indexBuffer;
             std::shared_ptr<graphics::Buffer> vertexBuffer;
+            std::shared_ptr<graphics::Buffer> instanceBuffer;
+            bool instanced = false; // one quad that the particle shader draws for every particle
 
-            std::vector<uint16_t> indices;
-            std::vector<graphics::Vertex> vertices;
+            std::vector<std::shared_ptr<graphics::Texture>> drawTextures;
+            std::vector<std::vector<float>> pixelShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
 
             uint32_t particleCount = 0;
 
@@ -123,6 +148,8 @@ namespace ouzel
 
             bool needsMeshUpdate = false;
 
+            uint32_t randomState;
+
             UpdateCallback updateCallback;
         };
     } // namespace scene
@@ -16,8 +16,8 @@ namespace ouzel
         ShapeRenderer::ShapeRenderer():
             Component(TYPE)
         {
-            shader = engine->getCache()->getShader(graphics::SHADER_COLOR);
-            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
+            shader = engine->getCache()->getShader(graphics::SHADER_COLOR_ID);
+            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
 
             indexBuffer = std::make_shared<graphics::Buffer>();
             indexBuffer->init(graphics::Buffer::Usage::INDEX, graphics::Buffer::DYNAMIC);
@@ -61,15 +61,15 @@ namespace ouzel
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
             float colorVector[] = {1.0f, 1.0f, 1.0f, opacity};
 
-            for (const DrawCommand& drawCommand : drawCommands)
-            {
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+            pixelShaderConstants.resize(1);
+            pixelShaderConstants[0].assign(std::begin(colorVector), std::end(colorVector));
 
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+            vertexShaderConstants.resize(1);
+            vertexShaderConstants[0].assign(std::begin(modelViewProj.m), std::end(modelViewProj.m));
 
-                engine->getRenderer()->addDrawCommand(std::vector<std::shared_ptr<graphics::Texture>>(),
+            for (const DrawCommand& drawCommand : drawCommands)
+            {
+                engine->getRenderer()->addDrawCommand(drawTextures,
                                                             shader,
                                                             pixelShaderConstants,
                                                             vertexShaderConstants,
@@ -89,6 +89,11 @@ namespace ouzel
             }
         }
 
+        uint32_t ShapeRenderer::getSortKey() const
+        {
+            return calculateSortKey(shader.get(), nullptr, blendState.get());
+        }
+
         void ShapeRenderer::clear()
         {
             boundingBox.reset();
@@ -98,6 +103,7 @@ namespace ouzel
             vertices.clear();
 
             dirty = true;
+            markBoundingBoxDirty();
         }
 
         bool ShapeRenderer::line(const Vector2& start, const Vector2& finish, const Color& color, float thickness)
@@ -161,6 +167,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            markBoundingBoxDirty();
+
             return true;
         }
 
@@ -284,6 +292,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            markBoundingBoxDirty();
+
             return true;
         }
 
@@ -432,6 +442,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            markBoundingBoxDirty();
+
             return true;
         }
 
@@ -506,6 +518,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            markBoundingBoxDirty();
+
             return true;
         }
 
@@ -580,6 +594,8 @@ namespace ouzel
             drawCommands.push_back(command);
 
             dirty = true;
+            markBoundingBoxDirty();
+
             return true;
         }
     } // namespace scene
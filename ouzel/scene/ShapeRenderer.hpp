@@ -34,6 +34,8 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle) override;
 
+            virtual uint32_t getSortKey() const override;
+
             void clear();
 
             bool line(const Vector2& start,
@@ -85,6 +87,10 @@ namespace ouzel
 
             std::vector<DrawCommand> drawCommands;
 
+            std::vector<std::shared_ptr<graphics::Texture>> drawTextures;
+            std::vector<std::vector<float>> pixelShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
+
             std::vector<uint16_t> indices;
             std::vector<ouzel::graphics::Vertex> vertices;
             bool dirty = false;
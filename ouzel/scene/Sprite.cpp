@@ -9,6 +9,7 @@
 #include "SceneManager.hpp"
 #include "files/FileSystem.hpp"
 #include "Layer.hpp"
+#include "Actor.hpp"
 #include "assets/Cache.hpp"
 
 namespace ouzel
@@ -18,7 +19,7 @@ namespace ouzel
         Sprite::Sprite():
             Component(TYPE)
         {
-            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL);
+            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL_ID);
 
             updateCallback.callback = std::bind(&Sprite::update, this, std::placeholders::_1);
 
@@ -51,8 +52,8 @@ namespace ouzel
         {
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::Renderer::CullMode::NONE;
-            material->blendState = spriteData.blendState ? spriteData.blendState : engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
-            material->shader = spriteData.shader ? spriteData.shader : engine->getCache()->getShader(graphics::SHADER_TEXTURE);
+            material->blendState = spriteData.blendState ? spriteData.blendState : engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
+            material->shader = spriteData.shader ? spriteData.shader : engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
             material->textures[0] = spriteData.texture;
 
             animations = spriteData.animations;
@@ -72,13 +73,19 @@ namespace ouzel
         {
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::Renderer::CullMode::NONE;
-            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
-            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
+            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
+            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
 
-            SpriteData spriteData = engine->getCache()->getSpriteData(filename, mipmaps, spritesX, spritesY, pivot);
-            material->textures[0] = spriteData.texture;
+            std::shared_ptr<const SpriteData> spriteData = engine->getCache()->getSpriteData(filename, mipmaps, spritesX, spritesY, pivot);
 
-            animations = spriteData.animations;
+            if (!spriteData)
+            {
+                return false;
+            }
+
+            material->textures[0] = spriteData->texture;
+
+            animations = spriteData->animations;
 
             animationQueue.clear();
             animationQueue.push_back({&animations[""], false});
@@ -95,8 +102,8 @@ namespace ouzel
         {
             material = std::make_shared<graphics::Material>();
             material->cullMode = graphics::Renderer::CullMode::NONE;
-            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
-            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
+            material->shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
+            material->blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
             material->textures[0] = newTexture;
             animations.clear();
 
@@ -227,39 +234,70 @@ namespace ouzel
                 size_t currentFrame = static_cast<size_t>(currentTime / currentAnimation->animation->frameInterval);
                 if (currentFrame >= currentAnimation->animation->frames.size()) currentFrame = currentAnimation->animation->frames.size() - 1;
 
-                Matrix4 modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
+                const SpriteData::Frame& frame = currentAnimation->animation->frames[currentFrame];
+
                 float colorVector[] = {material->diffuseColor.normR(), material->diffuseColor.normG(), material->diffuseColor.normB(), material->diffuseColor.normA() * opacity * material->opacity};
 
-                std::vector<std::vector<float>> pixelShaderConstants(1);
-                pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-                std::vector<std::vector<float>> vertexShaderConstants(1);
-                vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
-                std::vector<std::shared_ptr<graphics::Texture>> textures;
-                if (wireframe) textures.push_back(whitePixelTexture);
-                else textures.assign(std::begin(material->textures), std::end(material->textures));
-
-                engine->getRenderer()->addDrawCommand(textures,
-                                                            material->shader,
-                                                            pixelShaderConstants,
-                                                            vertexShaderConstants,
-                                                            material->blendState,
-                                                            currentAnimation->animation->frames[currentFrame].getMeshBuffer(),
-                                                            0,
-                                                            graphics::Renderer::DrawMode::TRIANGLE_LIST,
-                                                            0,
-                                                            renderTarget,
-                                                            renderViewport,
-                                                            depthWrite,
-                                                            depthTest,
-                                                            wireframe,
-                                                            scissorTest,
-                                                            scissorRectangle,
-                                                            material->cullMode);
+                pixelShaderConstants.resize(1);
+                pixelShaderConstants[0].assign(std::begin(colorVector), std::end(colorVector));
+
+                if (wireframe) drawTextures.assign(1, whitePixelTexture);
+                else drawTextures.assign(std::begin(material->textures), std::end(material->textures));
+
+                if (!frame.getVertices().empty() && !(actor && actor->isBatchingDisabled()))
+                {
+                    engine->getRenderer()->addBatchedDrawCommand(drawTextures,
+                                                                 material->shader,
+                                                                 pixelShaderConstants,
+                                                                 renderViewProjection,
+                                                                 transformMatrix * offsetMatrix,
+                                                                 material->blendState,
+                                                                 frame.getIndices(),
+                                                                 frame.getVertices(),
+                                                                 renderTarget,
+                                                                 renderViewport,
+                                                                 depthWrite,
+                                                                 depthTest,
+                                                                 wireframe,
+                                                                 scissorTest,
+                                                                 scissorRectangle,
+                                                                 material->cullMode);
+                }
+                else
+                {
+                    Matrix4 modelViewProj = renderViewProjection * transformMatrix * offsetMatrix;
+
+                    vertexShaderConstants.resize(1);
+                    vertexShaderConstants[0].assign(std::begin(modelViewProj.m), std::end(modelViewProj.m));
+
+                    engine->getRenderer()->addDrawCommand(drawTextures,
+                                                          material->shader,
+                                                          pixelShaderConstants,
+                                                          vertexShaderConstants,
+                                                          material->blendState,
+                                                          frame.getMeshBuffer(),
+                                                          0,
+                                                          graphics::Renderer::DrawMode::TRIANGLE_LIST,
+                                                          0,
+                                                          renderTarget,
+                                                          renderViewport,
+                                                          depthWrite,
+                                                          depthTest,
+                                                          wireframe,
+                                                          scissorTest,
+                                                          scissorRectangle,
+                                                          material->cullMode);
+                }
             }
         }
 
+        uint32_t Sprite::getSortKey() const
+        {
+            if (!material) return 0;
+
+            return calculateSortKey(material->shader.get(), material->textures[0].get(), material->blendState.get());
+        }
+
         void Sprite::setOffset(const Vector2& newOffset)
         {
             offset = newOffset;
@@ -376,6 +414,8 @@ namespace ouzel
 
         void Sprite::updateBoundingBox()
         {
+            Box3 previousBoundingBox = boundingBox;
+
             if (currentAnimation != animationQueue.end() &&
                 currentAnimation->animation->frameInterval > 0.0f &&
                 !currentAnimation->animation->frames.empty())
@@ -392,6 +432,12 @@ namespace ouzel
             {
                 boundingBox.reset();
             }
+
+            // animated sprites call this every frame, but most frames have the same size
+            if (boundingBox.min != previousBoundingBox.min || boundingBox.max != previousBoundingBox.max)
+            {
+                markBoundingBoxDirty();
+            }
         }
     } // namespace scene
 } // namespace ouzel
@@ -52,6 +52,8 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle) override;
 
+            virtual uint32_t getSortKey() const override;
+
             inline const std::shared_ptr<graphics::Material>& getMaterial() const { return material; }
             inline void setMaterial(const std::shared_ptr<graphics::Material>& newMaterial) { material = newMaterial; }
 
@@ -89,6 +91,11 @@ namespace ouzel
 
             std::shared_ptr<graphics::Texture> whitePixelTexture;
 
+            // kept between frames to avoid per-draw allocations
+            std::vector<std::shared_ptr<graphics::Texture>> drawTextures;
+            std::vector<std::vector<float>> pixelShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
+
             Vector2 offset;
             Matrix4 offsetMatrix = Matrix4::IDENTITY;
 
@@ -17,7 +17,7 @@ namespace ouzel
                                  const Vector2& pivot):
             name(frameName)
         {
-            std::vector<uint16_t> indices = {0, 1, 2, 1, 3, 2};
+            indices = {0, 1, 2, 1, 3, 2};
 
             Vector2 textCoords[4];
             Vector2 finalOffset(-sourceSize.width * pivot.x + sourceOffset.x,
@@ -50,7 +50,7 @@ namespace ouzel
                 textCoords[3] = Vector2(rightBottom.x, rightBottom.y);
             }
 
-            std::vector<graphics::Vertex> vertices = {
+            vertices = {
                 graphics::Vertex(Vector3(finalOffset.x, finalOffset.y, 0.0f), Color::WHITE,
                                  textCoords[0], Vector3(0.0f, 0.0f, -1.0f)),
                 graphics::Vertex(Vector3(finalOffset.x + frameRectangle.size.width, finalOffset.y, 0.0f), Color::WHITE,
@@ -74,9 +74,9 @@ namespace ouzel
         }
 
         SpriteData::Frame::Frame(const std::string& frameName,
-                                 const std::vector<uint16_t>& indices,
-                                 const std::vector<graphics::Vertex>& vertices):
-            name(frameName)
+                                 const std::vector<uint16_t>& frameIndices,
+                                 const std::vector<graphics::Vertex>& frameVertices):
+            name(frameName), indices(frameIndices), vertices(frameVertices)
         {
             for (const graphics::Vertex& vertex : vertices)
             {
@@ -94,13 +94,13 @@ namespace ouzel
         }
 
         SpriteData::Frame::Frame(const std::string& frameName,
-                                 const std::vector<uint16_t>& indices,
-                                 const std::vector<graphics::Vertex>& vertices,
+                                 const std::vector<uint16_t>& frameIndices,
+                                 const std::vector<graphics::Vertex>& frameVertices,
                                  const Rect& frameRectangle,
                                  const Size2& sourceSize,
                                  const Vector2& sourceOffset,
                                  const Vector2& pivot):
-            name(frameName)
+            name(frameName), indices(frameIndices), vertices(frameVertices)
         {
             for (const graphics::Vertex& vertex : vertices)
             {
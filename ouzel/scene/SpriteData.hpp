@@ -47,9 +47,14 @@ namespace ouzel
                 inline const Box2& getBoundingBox() const { return boundingBox; }
                 inline const std::shared_ptr<graphics::MeshBuffer>& getMeshBuffer() const { return meshBuffer; }
 
+                inline const std::vector<uint16_t>& getIndices() const { return indices; }
+                inline const std::vector<graphics::Vertex>& getVertices() const { return vertices; }
+
             protected:
                 std::string name;
                 Box2 boundingBox;
+                std::vector<uint16_t> indices;
+                std::vector<graphics::Vertex> vertices;
                 std::shared_ptr<graphics::MeshBuffer> meshBuffer;
                 std::shared_ptr<graphics::Buffer> indexBuffer;
                 std::shared_ptr<graphics::Buffer> vertexBuffer;
@@ -25,9 +25,9 @@ namespace ouzel
             color(initColor),
             mipmaps(initMipmaps)
         {
-            shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE);
-            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA);
-            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL);
+            shader = engine->getCache()->getShader(graphics::SHADER_TEXTURE_ID);
+            blendState = engine->getCache()->getBlendState(graphics::BLEND_ALPHA_ID);
+            whitePixelTexture = engine->getCache()->getTexture(graphics::TEXTURE_WHITE_PIXEL_ID);
 
             indexBuffer = std::make_shared<graphics::Buffer>();
             indexBuffer->init(graphics::Buffer::Usage::INDEX, graphics::Buffer::DYNAMIC);
@@ -97,13 +97,15 @@ namespace ouzel
             Matrix4 modelViewProj = renderViewProjection * transformMatrix;
             float colorVector[] = {color.normR(), color.normG(), color.normB(), color.normA() * opacity};
 
-            std::vector<std::vector<float>> pixelShaderConstants(1);
-            pixelShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+            drawTextures.assign(1, wireframe ? whitePixelTexture : texture);
 
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+            pixelShaderConstants.resize(1);
+            pixelShaderConstants[0].assign(std::begin(colorVector), std::end(colorVector));
 
-            engine->getRenderer()->addDrawCommand({wireframe ? whitePixelTexture : texture},
+            vertexShaderConstants.resize(1);
+            vertexShaderConstants[0].assign(std::begin(modelViewProj.m), std::end(modelViewProj.m));
+
+            engine->getRenderer()->addDrawCommand(drawTextures,
                                                         shader,
                                                         pixelShaderConstants,
                                                         vertexShaderConstants,
@@ -122,6 +124,11 @@ namespace ouzel
                                                         graphics::Renderer::CullMode::NONE);
         }
 
+        uint32_t TextRenderer::getSortKey() const
+        {
+            return calculateSortKey(shader.get(), texture.get(), blendState.get());
+        }
+
         void TextRenderer::setText(const std::string& newText)
         {
             text = newText;
@@ -154,6 +161,8 @@ namespace ouzel
                 vertices.clear();
                 texture.reset();
             }
+
+            markBoundingBoxDirty();
         }
     } // namespace scene
 } // namespace ouzel
@@ -40,6 +40,8 @@ namespace ouzel
                               bool scissorTest,
                               const Rect& scissorRectangle) override;
 
+            virtual uint32_t getSortKey() const override;
+
             void setFont(const std::string& fontFile);
 
             inline float getFontSize() const { return fontSize; }
@@ -81,6 +83,10 @@ namespace ouzel
             std::vector<uint16_t> indices;
             std::vector<graphics::Vertex> vertices;
 
+            std::vector<std::shared_ptr<graphics::Texture>> drawTextures;
+            std::vector<std::vector<float>> pixelShaderConstants;
+            std::vector<std::vector<float>> vertexShaderConstants;
+
             Color color = Color::WHITE;
 
             bool mipmaps = true;
@@ -0,0 +1,273 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include "JobSystem.hpp"
+#include "Lock.hpp"
+
+namespace ouzel
+{
+    JobSystem::JobSystem(uint32_t initWorkerCount):
+        workerCount(initWorkerCount), pendingJobs(0), running(true)
+    {
+        for (uint32_t i = 0; i <= workerCount; ++i)
+        {
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+
+        workers.reserve(workerCount);
+
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            workers.push_back(Thread(std::bind(&JobSystem::main, this, i), "Worker"));
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        running = false;
+
+        {
+            Lock lock(sleepMutex);
+            sleepCondition.broadcast();
+        }
+
+        // joins the worker threads
+        workers.clear();
+    }
+
+    void JobSystem::run(const std::function<void()>& function, Counter* counter, Counter* dependency)
+    {
+        if (counter) ++counter->value;
+
+        if (dependency)
+        {
+            Lock lock(dependency->mutex);
+
+            if (dependency->value != 0)
+            {
+                dependency->continuations.push_back(std::make_pair(function, counter));
+                return;
+            }
+        }
+
+        push(getQueueIndex(), {function, counter});
+    }
+
+    void JobSystem::runBackground(const std::function<void()>& function, Counter* counter)
+    {
+        if (counter) ++counter->value;
+
+        Job job = {function, counter};
+
+        if (workerCount == 0)
+        {
+            execute(job);
+            return;
+        }
+
+        ++pendingJobs;
+
+        {
+            Lock lock(backgroundQueue.mutex);
+            backgroundQueue.jobs.push_back(std::move(job));
+        }
+
+        Lock lock(sleepMutex);
+        sleepCondition.signal();
+    }
+
+    void JobSystem::wait(Counter& counter, bool onlyOwnJobs)
+    {
+        uint32_t queueIndex = getQueueIndex();
+        Job job;
+
+        for (;;)
+        {
+            {
+                Lock lock(counter.mutex);
+                if (counter.value == 0) return;
+            }
+
+            if (onlyOwnJobs ? popCounterJob(counter, job) : pop(queueIndex, job))
+            {
+                execute(job);
+            }
+            else
+            {
+                Lock lock(counter.mutex);
+                if (counter.value == 0) return;
+
+                // wake up periodically to help with jobs pushed in the meantime
+                counter.condition.wait(counter.mutex, std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    void JobSystem::parallelFor(uint32_t count,
+                                const std::function<void(uint32_t begin, uint32_t end)>& function,
+                                uint32_t minBatchSize)
+    {
+        if (count == 0) return;
+
+        // a few batches per thread, so that the threads that finish early can steal the rest
+        uint32_t batchCount = (workerCount + 1) * 4;
+        uint32_t batchSize = std::max(std::max(minBatchSize, 1U), (count + batchCount - 1) / batchCount);
+
+        if (batchSize >= count)
+        {
+            function(0, count);
+            return;
+        }
+
+        Counter counter;
+
+        for (uint32_t begin = batchSize; begin < count; begin += batchSize)
+        {
+            uint32_t end = std::min(begin + batchSize, count);
+            run([&function, begin, end]() { function(begin, end); }, &counter);
+        }
+
+        function(0, batchSize);
+        wait(counter);
+    }
+
+    void JobSystem::main(uint32_t queueIndex)
+    {
+        Job job;
+
+        while (running)
+        {
+            if (pop(queueIndex, job) || popBackground(job))
+            {
+                execute(job);
+            }
+            else
+            {
+                Lock lock(sleepMutex);
+                while (running && pendingJobs == 0) sleepCondition.wait(sleepMutex);
+            }
+        }
+    }
+
+    uint32_t JobSystem::getQueueIndex() const
+    {
+        Thread::ID currentThreadId = Thread::getCurrentThreadId();
+
+        for (uint32_t i = 0; i < workers.size(); ++i)
+        {
+            if (workers[i].getId() == currentThreadId) return i;
+        }
+
+        return workerCount;
+    }
+
+    void JobSystem::push(uint32_t queueIndex, Job job)
+    {
+        ++pendingJobs;
+
+        {
+            Lock lock(queues[queueIndex]->mutex);
+            queues[queueIndex]->jobs.push_back(std::move(job));
+        }
+
+        Lock lock(sleepMutex);
+        sleepCondition.signal();
+    }
+
+    bool JobSystem::pop(uint32_t queueIndex, Job& job)
+    {
+        // the own queue is used as a stack, other queues are stolen from the opposite end
+        {
+            Queue& queue = *queues[queueIndex];
+            Lock lock(queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                --pendingJobs;
+                return true;
+            }
+        }
+
+        for (uint32_t i = 1; i < queues.size(); ++i)
+        {
+            Queue& queue = *queues[(queueIndex + i) % queues.size()];
+            Lock lock(queue.mutex);
+
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                --pendingJobs;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool JobSystem::popBackground(Job& job)
+    {
+        Lock lock(backgroundQueue.mutex);
+
+        if (backgroundQueue.jobs.empty()) return false;
+
+        job = std::move(backgroundQueue.jobs.front());
+        backgroundQueue.jobs.pop_front();
+        --pendingJobs;
+
+        return true;
+    }
+
+    bool JobSystem::popCounterJob(const Counter& counter, Job& job)
+    {
+        for (const std::unique_ptr<Queue>& queue : queues)
+        {
+            Lock lock(queue->mutex);
+
+            auto i = std::find_if(queue->jobs.begin(), queue->jobs.end(), [&counter](const Job& queuedJob) {
+                return queuedJob.counter == &counter;
+            });
+
+            if (i != queue->jobs.end())
+            {
+                job = std::move(*i);
+                queue->jobs.erase(i);
+                --pendingJobs;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JobSystem::execute(Job& job)
+    {
+        job.function();
+
+        if (Counter* counter = job.counter)
+        {
+            std::vector<std::pair<std::function<void()>, Counter*>> continuations;
+
+            {
+                // the counter may be destroyed by the waiting thread as soon as the mutex is released
+                Lock lock(counter->mutex);
+
+                if (--counter->value == 0)
+                {
+                    continuations.swap(counter->continuations);
+                    counter->condition.broadcast();
+                }
+            }
+
+            uint32_t queueIndex = getQueueIndex();
+
+            for (const auto& continuation : continuations)
+            {
+                push(queueIndex, {continuation.first, continuation.second});
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "thread/Condition.hpp"
+#include "thread/Mutex.hpp"
+#include "thread/Thread.hpp"
+
+namespace ouzel
+{
+    class JobSystem final
+    {
+    public:
+        class Counter final
+        {
+            friend JobSystem;
+        public:
+            Counter(): value(0) {}
+
+            Counter(const Counter&) = delete;
+            Counter& operator=(const Counter&) = delete;
+
+            Counter(Counter&&) = delete;
+            Counter& operator=(Counter&&) = delete;
+
+            inline bool isDone() const { return value == 0; }
+
+        private:
+            std::atomic<uint32_t> value;
+            Mutex mutex;
+            Condition condition;
+            std::vector<std::pair<std::function<void()>, Counter*>> continuations;
+        };
+
+        // workerCount of 0 runs all jobs on the threads that wait for them
+        explicit JobSystem(uint32_t initWorkerCount);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        JobSystem(JobSystem&&) = delete;
+        JobSystem& operator=(JobSystem&&) = delete;
+
+        inline uint32_t getWorkerCount() const { return workerCount; }
+
+        // counter is incremented now and decremented when the job finishes,
+        // the job is not started before dependency is done
+        void run(const std::function<void()>& function, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+        // for long jobs (like loading files), they are executed only by the workers, so that the threads that wait
+        // for their own jobs are not held up by them, without workers the job is executed immediately
+        void runBackground(const std::function<void()>& function, Counter* counter = nullptr);
+
+        // executes pending jobs until the counter reaches zero, except the background jobs, by default it takes
+        // any job from any queue, so the waiting thread can end up running unrelated work (like loading or culling),
+        // with onlyOwnJobs it runs only the jobs of this counter and otherwise blocks
+        void wait(Counter& counter, bool onlyOwnJobs = false);
+
+        // calls function for [begin, end) ranges covering [0, count) and waits for all of them
+        void parallelFor(uint32_t count,
+                         const std::function<void(uint32_t begin, uint32_t end)>& function,
+                         uint32_t minBatchSize = 1);
+
+    private:
+        struct Job
+        {
+            std::function<void()> function;
+            Counter* counter;
+        };
+
+        struct Queue
+        {
+            Mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void main(uint32_t queueIndex);
+        uint32_t getQueueIndex() const;
+        void push(uint32_t queueIndex, Job job);
+        bool pop(uint32_t queueIndex, Job& job);
+        bool popBackground(Job& job);
+        bool popCounterJob(const Counter& counter, Job& job);
+        void execute(Job& job);
+
+        uint32_t workerCount;
+        // one queue per worker, the last one is shared by all other threads
+        std::vector<std::unique_ptr<Queue>> queues;
+        Queue backgroundQueue;
+        std::vector<Thread> workers;
+
+        std::atomic<uint32_t> pendingJobs;
+        std::atomic<bool> running;
+        Mutex sleepMutex;
+        Condition sleepCondition;
+    };
+}
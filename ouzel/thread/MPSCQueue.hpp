@@ -0,0 +1,175 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "thread/Lock.hpp"
+#include "thread/Mutex.hpp"
+
+namespace ouzel
+{
+    // Multi-producer single-consumer queue. Values are pushed without locking into a bounded ring buffer;
+    // when the ring is full they go to a mutex-protected overflow list, so push never blocks on the consumer.
+    // Values pushed by one thread are consumed in the order they were pushed.
+    template<class T>
+    class MPSCQueue final
+    {
+    public:
+        // capacity is rounded up to a power of two
+        explicit MPSCQueue(uint32_t initCapacity):
+            enqueuePosition(0), overflowing(false)
+        {
+            capacity = 1;
+            while (capacity < initCapacity) capacity <<= 1;
+            mask = capacity - 1;
+
+            cells.reset(new Cell[capacity]);
+
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~MPSCQueue()
+        {
+            size_t end = enqueuePosition.load(std::memory_order_acquire);
+
+            for (; dequeuePosition != end; ++dequeuePosition)
+            {
+                reinterpret_cast<T*>(&cells[dequeuePosition & mask].storage)->~T();
+            }
+        }
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        MPSCQueue(MPSCQueue&&) = delete;
+        MPSCQueue& operator=(MPSCQueue&&) = delete;
+
+        // can be called from any thread, including the consumer thread while draining
+        void push(T value)
+        {
+            // once a thread has used the overflow list, it keeps using it until the consumer empties it
+            if (!overflowing.load(std::memory_order_acquire) && tryPush(value)) return;
+
+            Lock lock(overflowMutex);
+            overflowing.store(true, std::memory_order_release);
+            overflow.push_back(std::move(value));
+        }
+
+        // must be called only from the consumer thread, calls function for every value until the queue is empty
+        template<class F>
+        void drain(F function)
+        {
+            for (;;)
+            {
+                while (tryPop(function)) {}
+
+                // values are added to the overflow list only while the flag is set
+                if (!overflowing.load(std::memory_order_acquire)) return;
+
+                {
+                    Lock lock(overflowMutex);
+
+                    if (overflow.empty())
+                    {
+                        overflowing.store(false, std::memory_order_release);
+                        return;
+                    }
+
+                    overflowValues.swap(overflow);
+                }
+
+                // values pushed to the ring before the overflowing ones have to be consumed first
+                size_t end = enqueuePosition.load(std::memory_order_acquire);
+
+                while (dequeuePosition != end)
+                {
+                    if (!tryPop(function)) std::this_thread::yield(); // a producer is still writing the value
+                }
+
+                for (T& value : overflowValues)
+                {
+                    function(value);
+                }
+
+                overflowValues.clear();
+            }
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+        };
+
+        bool tryPush(T& value)
+        {
+            size_t position = enqueuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+
+            for (;;)
+            {
+                cell = &cells[position & mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                if (difference == 0)
+                {
+                    if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0)
+                    return false; // full
+                else
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+
+            new (&cell->storage) T(std::move(value));
+            cell->sequence.store(position + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        template<class F>
+        bool tryPop(F& function)
+        {
+            Cell& cell = cells[dequeuePosition & mask];
+
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) return false;
+
+            T* value = reinterpret_cast<T*>(&cell.storage);
+            function(*value);
+            value->~T();
+
+            cell.sequence.store(dequeuePosition + capacity, std::memory_order_release);
+            ++dequeuePosition;
+
+            return true;
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<Cell[]> cells;
+
+        char enqueuePadding[64];
+        std::atomic<size_t> enqueuePosition;
+        char dequeuePadding[64];
+        size_t dequeuePosition = 0;
+
+        std::atomic<bool> overflowing;
+        Mutex overflowMutex;
+        std::vector<T> overflow;
+        std::vector<T> overflowValues;
+    };
+}
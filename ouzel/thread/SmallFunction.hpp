@@ -0,0 +1,152 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ouzel
+{
+    // move-only void() callable, stores callables of up to STORAGE_SIZE bytes without allocating memory
+    class SmallFunction final
+    {
+    public:
+        static const size_t STORAGE_SIZE = 56;
+
+        SmallFunction() {}
+
+        template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, SmallFunction>::value>::type>
+        SmallFunction(F&& function)
+        {
+            typedef typename std::decay<F>::type Callable;
+
+            static const bool inplace = sizeof(Callable) <= STORAGE_SIZE &&
+                std::alignment_of<Callable>::value <= std::alignment_of<Storage>::value &&
+                std::is_nothrow_move_constructible<Callable>::value;
+
+            construct<Callable>(std::forward<F>(function), std::integral_constant<bool, inplace>());
+        }
+
+        SmallFunction(SmallFunction&& other)
+        {
+            if (other.operations)
+            {
+                other.operations->move(&storage, &other.storage);
+                operations = other.operations;
+                other.operations = nullptr;
+            }
+        }
+
+        SmallFunction& operator=(SmallFunction&& other)
+        {
+            if (&other != this)
+            {
+                reset();
+
+                if (other.operations)
+                {
+                    other.operations->move(&storage, &other.storage);
+                    operations = other.operations;
+                    other.operations = nullptr;
+                }
+            }
+
+            return *this;
+        }
+
+        SmallFunction(const SmallFunction&) = delete;
+        SmallFunction& operator=(const SmallFunction&) = delete;
+
+        ~SmallFunction()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            if (operations)
+            {
+                operations->destroy(&storage);
+                operations = nullptr;
+            }
+        }
+
+        explicit operator bool() const { return operations != nullptr; }
+
+        void operator()()
+        {
+            operations->invoke(&storage);
+        }
+
+    private:
+        typedef std::aligned_storage<STORAGE_SIZE>::type Storage;
+
+        struct Operations
+        {
+            void (*invoke)(void* storage);
+            void (*move)(void* destination, void* source);
+            void (*destroy)(void* storage);
+        };
+
+        template<class Callable>
+        struct InplaceOperations
+        {
+            static void invoke(void* storage) { (*static_cast<Callable*>(storage))(); }
+            static void move(void* destination, void* source)
+            {
+                new (destination) Callable(std::move(*static_cast<Callable*>(source)));
+                static_cast<Callable*>(source)->~Callable();
+            }
+            static void destroy(void* storage) { static_cast<Callable*>(storage)->~Callable(); }
+
+            static const Operations operations;
+        };
+
+        template<class Callable>
+        struct HeapOperations
+        {
+            static void invoke(void* storage) { (**static_cast<Callable**>(storage))(); }
+            static void move(void* destination, void* source)
+            {
+                *static_cast<Callable**>(destination) = *static_cast<Callable**>(source);
+            }
+            static void destroy(void* storage) { delete *static_cast<Callable**>(storage); }
+
+            static const Operations operations;
+        };
+
+        template<class Callable, class F>
+        void construct(F&& function, std::true_type)
+        {
+            new (&storage) Callable(std::forward<F>(function));
+            operations = &InplaceOperations<Callable>::operations;
+        }
+
+        template<class Callable, class F>
+        void construct(F&& function, std::false_type)
+        {
+            *reinterpret_cast<Callable**>(&storage) = new Callable(std::forward<F>(function));
+            operations = &HeapOperations<Callable>::operations;
+        }
+
+        const Operations* operations = nullptr;
+        Storage storage;
+    };
+
+    template<class Callable>
+    const SmallFunction::Operations SmallFunction::InplaceOperations<Callable>::operations = {
+        &SmallFunction::InplaceOperations<Callable>::invoke,
+        &SmallFunction::InplaceOperations<Callable>::move,
+        &SmallFunction::InplaceOperations<Callable>::destroy
+    };
+
+    template<class Callable>
+    const SmallFunction::Operations SmallFunction::HeapOperations<Callable>::operations = {
+        &SmallFunction::HeapOperations<Callable>::invoke,
+        &SmallFunction::HeapOperations<Callable>::move,
+        &SmallFunction::HeapOperations<Callable>::destroy
+    };
+}
@@ -67,7 +67,7 @@ PerspectiveSample::PerspectiveSample():
     rotate->start();
 
     engine->getCache()->loadAsset("cube.obj");
-    boxModel.init(engine->getCache()->getModelData("cube.obj"));
+    boxModel.init(*engine->getCache()->getModelData("cube.obj"));
     box.addComponent(&boxModel);
     box.setPosition(Vector3(-160.0f, 0.0f, -50.0f));
     layer.addChild(&box);
@@ -0,0 +1,21 @@
+#version 400
+in vec3 position0;
+in vec4 color0;
+in vec2 texCoord0;
+in vec2 instancePosition;
+in float instanceSize;
+in float instanceRotation;
+in vec4 instanceColor;
+uniform mat4 modelViewProj;
+out vec4 exColor;
+out vec2 exTexCoord;
+void main()
+{
+    vec2 corner = position0.xy * instanceSize;
+    float sine = sin(instanceRotation);
+    float cosine = cos(instanceRotation);
+    vec2 position = instancePosition + vec2(corner.x * cosine - corner.y * sine, corner.x * sine + corner.y * cosine);
+    gl_Position = modelViewProj * vec4(position, position0.z, 1.0);
+    exColor = color0 * instanceColor;
+    exTexCoord = texCoord0;
+}
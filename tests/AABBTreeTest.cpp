@@ -0,0 +1,361 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Test.hpp"
+#include "scene/AABBTree.hpp"
+#include "scene/Actor.hpp"
+#include "scene/Component.hpp"
+#include "scene/Layer.hpp"
+
+using namespace ouzel;
+using namespace ouzel::scene;
+
+static const float WORLD_SIZE = 10000.0f;
+static const float VIEW_WIDTH = 1920.0f;
+static const float VIEW_HEIGHT = 1080.0f;
+static const uint32_t TEST_ACTORS = 2000;
+static const uint32_t TEST_ITERATIONS = 200;
+static const uint32_t BENCHMARK_FRAMES = 100;
+static const uint32_t PICKING_GROUPS = 40;
+static const uint32_t PICKING_CHILDREN = 8;
+static const uint32_t PICKING_PROBES = 300;
+static const float PICKING_WORLD_SIZE = 1000.0f;
+
+class Scene2D
+{
+public:
+    explicit Scene2D(uint32_t count):
+        actors(new Actor[count]), boxes(count), proxies(count), randomEngine(count)
+    {
+        for (Box3& box : boxes) box = createBox();
+    }
+
+    Box3 createBox()
+    {
+        std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+        std::uniform_real_distribution<float> size(10.0f, 50.0f);
+
+        Vector3 min(position(randomEngine), position(randomEngine), 0.0f);
+        return Box3(min, min + Vector3(size(randomEngine), size(randomEngine), 0.0f));
+    }
+
+    Box3 createView()
+    {
+        std::uniform_real_distribution<float> x(0.0f, WORLD_SIZE - VIEW_WIDTH);
+        std::uniform_real_distribution<float> y(0.0f, WORLD_SIZE - VIEW_HEIGHT);
+
+        Vector3 min(x(randomEngine), y(randomEngine), 0.0f);
+        return Box3(min, min + Vector3(VIEW_WIDTH, VIEW_HEIGHT, 0.0f));
+    }
+
+    // the same kind of movement as sprites walking around
+    void moveActors()
+    {
+        std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+
+        for (Box3& box : boxes)
+        {
+            Vector3 offset(step(randomEngine), step(randomEngine), 0.0f);
+            box.min += offset;
+            box.max += offset;
+        }
+    }
+
+    std::unique_ptr<Actor[]> actors;
+    std::vector<Box3> boxes;
+    std::vector<int32_t> proxies;
+    std::mt19937 randomEngine;
+};
+
+// the tree has to return exactly the actors whose enlarged boxes intersect the query box
+static void checkQuery(const AABBTree& tree, Scene2D& scene, const std::vector<bool>& alive)
+{
+    Box3 view = scene.createView();
+
+    std::vector<Actor*> result;
+    tree.query(view, result);
+    std::sort(result.begin(), result.end());
+    CHECK(std::adjacent_find(result.begin(), result.end()) == result.end());
+
+    std::vector<Actor*> expected;
+
+    for (uint32_t i = 0; i < scene.boxes.size(); ++i)
+    {
+        if (!alive[i]) continue;
+
+        CHECK(tree.getActor(scene.proxies[i]) == &scene.actors[i]);
+
+        // the enlarged box must cover the actual box
+        const Box3& enlargedBox = tree.getBox(scene.proxies[i]);
+        CHECK(enlargedBox.min.x <= scene.boxes[i].min.x && enlargedBox.min.y <= scene.boxes[i].min.y &&
+              enlargedBox.max.x >= scene.boxes[i].max.x && enlargedBox.max.y >= scene.boxes[i].max.y);
+
+        if (enlargedBox.intersects(view)) expected.push_back(&scene.actors[i]);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    CHECK(result == expected);
+}
+
+static void testTree()
+{
+    Scene2D scene(TEST_ACTORS);
+    std::vector<bool> alive(TEST_ACTORS, true);
+    AABBTree tree;
+
+    for (uint32_t i = 0; i < TEST_ACTORS; ++i)
+        scene.proxies[i] = tree.createProxy(scene.boxes[i], &scene.actors[i]);
+
+    std::uniform_int_distribution<uint32_t> actorIndex(0, TEST_ACTORS - 1);
+
+    for (uint32_t iteration = 0; iteration < TEST_ITERATIONS; ++iteration)
+    {
+        scene.moveActors();
+
+        for (uint32_t i = 0; i < TEST_ACTORS; ++i)
+            if (alive[i]) tree.moveProxy(scene.proxies[i], scene.boxes[i]);
+
+        // actors leave and join the layer, the freed nodes are reused
+        for (uint32_t change = 0; change < 10; ++change)
+        {
+            uint32_t i = actorIndex(scene.randomEngine);
+
+            if (alive[i])
+            {
+                tree.destroyProxy(scene.proxies[i]);
+            }
+            else
+            {
+                scene.boxes[i] = scene.createBox();
+                scene.proxies[i] = tree.createProxy(scene.boxes[i], &scene.actors[i]);
+            }
+
+            alive[i] = !alive[i];
+        }
+
+        checkQuery(tree, scene, alive);
+    }
+
+    // a balanced tree of 2000 leaves is 11 levels high
+    CHECK(tree.getHeight() < 32);
+
+    tree.clear();
+    std::vector<Actor*> result;
+    tree.query(scene.createView(), result);
+    CHECK(result.empty());
+}
+
+// The spatial index has to find the same actors as the recursive search of ActorContainer, also for the actors that
+// changed since the last draw. Their world order and traversal order are updated only by the draw, so the order of
+// the results is compared only after drawing.
+static void checkPicking(Layer& layer, std::mt19937& randomEngine, bool drawn)
+{
+    std::uniform_real_distribution<float> position(0.0f, PICKING_WORLD_SIZE);
+
+    for (uint32_t probe = 0; probe < PICKING_PROBES; ++probe)
+    {
+        Vector2 point(position(randomEngine), position(randomEngine));
+
+        std::vector<std::pair<Actor*, Vector3>> pointResult;
+        std::vector<std::pair<Actor*, Vector3>> pointExpected;
+        layer.findActors(point, pointResult);
+        layer.ActorContainer::findActors(point, pointExpected);
+
+        std::vector<Vector2> edges = {
+            point, point + Vector2(60.0f, 0.0f), point + Vector2(60.0f, 40.0f), point + Vector2(0.0f, 40.0f)
+        };
+
+        std::vector<Actor*> shapeResult;
+        std::vector<Actor*> shapeExpected;
+        layer.findActors(edges, shapeResult);
+        layer.ActorContainer::findActors(edges, shapeExpected);
+
+        std::vector<Actor*> result;
+        std::vector<Actor*> expected;
+        for (const auto& i : pointResult) result.push_back(i.first);
+        for (const auto& i : pointExpected) expected.push_back(i.first);
+
+        if (!drawn)
+        {
+            std::sort(result.begin(), result.end());
+            std::sort(expected.begin(), expected.end());
+            std::sort(shapeResult.begin(), shapeResult.end());
+            std::sort(shapeExpected.begin(), shapeExpected.end());
+        }
+
+        CHECK(result == expected);
+        CHECK(shapeResult == shapeExpected);
+    }
+}
+
+static void testLayerPicking()
+{
+    TestEngine testEngine;
+    std::mt19937 randomEngine(1);
+    std::uniform_real_distribution<float> position(0.0f, PICKING_WORLD_SIZE);
+    std::uniform_real_distribution<float> offset(-50.0f, 50.0f);
+
+    Layer layer;
+    layer.setSpatialIndexEnabled(true);
+
+    std::vector<Actor*> groups;
+    std::vector<Actor*> actors;
+    std::vector<Component*> components;
+
+    for (uint32_t group = 0; group < PICKING_GROUPS; ++group)
+    {
+        std::unique_ptr<Actor> parent(new Actor());
+        parent->setPosition(Vector2(position(randomEngine), position(randomEngine)));
+        groups.push_back(parent.get());
+
+        for (uint32_t child = 0; child <= PICKING_CHILDREN; ++child)
+        {
+            std::unique_ptr<Actor> newActor(new Actor());
+            Actor* actor = (child == 0) ? parent.get() : newActor.get();
+            if (child > 0) actor->setPosition(Vector2(offset(randomEngine), offset(randomEngine)));
+
+            std::unique_ptr<Component> component(new Component(Component::NONE));
+            component->setBoundingBox(Box3(Vector3(-20.0f, -10.0f, 0.0f), Vector3(20.0f, 10.0f, 0.0f)));
+            components.push_back(component.get());
+            actor->addComponent(std::move(component));
+
+            actor->setPickable(actors.size() % 5 != 0);
+            actor->setCullDisabled(actors.size() % 7 == 0);
+            actor->setOrder(static_cast<int32_t>(actors.size() % 3));
+            actors.push_back(actor);
+
+            if (child > 0) parent->addChild(std::move(newActor));
+        }
+
+        layer.addChild(std::move(parent));
+    }
+
+    // nothing is in the index before the first draw
+    checkPicking(layer, randomEngine, false);
+    layer.draw();
+    checkPicking(layer, randomEngine, true);
+
+    std::uniform_int_distribution<size_t> actorIndex(0, actors.size() - 1);
+    std::uniform_int_distribution<size_t> groupIndex(0, groups.size() - 1);
+
+    for (uint32_t iteration = 0; iteration < 20; ++iteration)
+    {
+        for (uint32_t i = 0; i < 30; ++i)
+            actors[actorIndex(randomEngine)]->setPosition(Vector2(position(randomEngine), position(randomEngine)));
+
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            Component* component = components[actorIndex(randomEngine)];
+            Vector3 size(fabsf(offset(randomEngine)), fabsf(offset(randomEngine)), 0.0f);
+            component->setBoundingBox(Box3(-size, size));
+        }
+
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            Actor* actor = actors[actorIndex(randomEngine)];
+            actor->setCullDisabled(!actor->isCullDisabled());
+        }
+
+        // the children of hidden parents are not updated before the next draw
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            Actor* group = groups[groupIndex(randomEngine)];
+            group->setHidden(!group->isHidden());
+        }
+
+        checkPicking(layer, randomEngine, true);
+        layer.draw();
+        checkPicking(layer, randomEngine, true);
+    }
+
+    // the removed actors must not stay in the index or in the list of the changed actors
+    for (uint32_t group = 0; group < PICKING_GROUPS; group += 4)
+    {
+        Actor* child = groups[group]->getChildren().front();
+        child->setPosition(Vector2(position(randomEngine), position(randomEngine)));
+        groups[group]->removeChild(child);
+        actors.erase(std::find(actors.begin(), actors.end(), child));
+    }
+
+    checkPicking(layer, randomEngine, true);
+    layer.draw();
+    checkPicking(layer, randomEngine, true);
+
+    layer.setSpatialIndexEnabled(false);
+    layer.setSpatialIndexEnabled(true);
+    checkPicking(layer, randomEngine, true);
+    layer.draw();
+    checkPicking(layer, randomEngine, true);
+}
+
+static void benchmark(uint32_t count)
+{
+    Scene2D scene(count);
+    AABBTree tree;
+
+    double createTime = measure([&tree, &scene, count]() {
+        for (uint32_t i = 0; i < count; ++i)
+            scene.proxies[i] = tree.createProxy(scene.boxes[i], &scene.actors[i]);
+    });
+
+    std::vector<Box3> views;
+    for (uint32_t frame = 0; frame < BENCHMARK_FRAMES; ++frame) views.push_back(scene.createView());
+
+    std::vector<Actor*> result;
+    size_t visibleCount = 0;
+    uint32_t reinsertCount = 0;
+    double moveTime = 0.0;
+
+    double queryTime = measure([&]() {
+        for (const Box3& view : views)
+        {
+            result.clear();
+            tree.query(view, result);
+            visibleCount += result.size();
+        }
+    });
+
+    // the cost of testing every actor against the view, which is what the layer does without the index
+    double scanTime = measure([&]() {
+        for (const Box3& view : views)
+        {
+            result.clear();
+            for (uint32_t i = 0; i < count; ++i)
+                if (scene.boxes[i].intersects(view)) result.push_back(&scene.actors[i]);
+        }
+    });
+
+    for (uint32_t frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+    {
+        scene.moveActors();
+
+        moveTime += measure([&tree, &scene, &reinsertCount, count]() {
+            for (uint32_t i = 0; i < count; ++i)
+                if (tree.moveProxy(scene.proxies[i], scene.boxes[i])) ++reinsertCount;
+        });
+    }
+
+    Log(Log::Level::INFO) << count << " actors: build " << createTime * 1000.0 << " ms, update " <<
+        moveTime * 1000.0 / BENCHMARK_FRAMES << " ms/frame (" << reinsertCount / BENCHMARK_FRAMES <<
+        " reinserted), query " << queryTime * 1000000.0 / BENCHMARK_FRAMES << " us (" <<
+        visibleCount / BENCHMARK_FRAMES << " visible), linear scan " << scanTime * 1000000.0 / BENCHMARK_FRAMES <<
+        " us, height " << tree.getHeight();
+}
+
+int main()
+{
+    testTree();
+    testLayerPicking();
+
+    const uint32_t counts[] = {1000, 10000, 100000};
+
+    for (uint32_t count : counts)
+        benchmark(count);
+
+    return EXIT_SUCCESS;
+}
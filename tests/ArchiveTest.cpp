@@ -0,0 +1,201 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+#include "Test.hpp"
+#include "files/Archive.hpp"
+#include "files/FileMapping.hpp"
+#include "files/FileSystem.hpp"
+#include "thread/Thread.hpp"
+#include "utils/Utils.hpp"
+
+using namespace ouzel;
+
+static const uint32_t ENTRY_COUNT = 64;
+static const uint32_t THREAD_COUNT = 16;
+static const uint32_t READS_PER_THREAD = 500;
+
+struct Entry
+{
+    std::string name;
+    std::vector<uint8_t> data;
+    bool deflated;
+};
+
+static uint32_t crc32(const std::vector<uint8_t>& data)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint8_t b : data)
+    {
+        crc ^= b;
+        for (uint32_t bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+// Deflate stream made of stored blocks, so that the archive can be written without a compressor
+static std::vector<uint8_t> deflateStored(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> result;
+    size_t offset = 0;
+
+    do
+    {
+        uint16_t size = static_cast<uint16_t>(std::min(data.size() - offset, static_cast<size_t>(0xFFFF)));
+        bool last = (offset + size == data.size());
+
+        uint8_t header[5];
+        header[0] = last ? 1 : 0;
+        encodeUInt16Little(header + 1, size);
+        encodeUInt16Little(header + 3, static_cast<uint16_t>(~size));
+
+        result.insert(result.end(), header, header + sizeof(header));
+        result.insert(result.end(), data.begin() + static_cast<std::ptrdiff_t>(offset),
+                      data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += size;
+    }
+    while (offset < data.size());
+
+    return result;
+}
+
+static std::vector<uint8_t> createArchive(const std::vector<Entry>& entries)
+{
+    std::vector<uint8_t> result;
+    std::vector<uint8_t> centralDirectory;
+
+    for (const Entry& entry : entries)
+    {
+        std::vector<uint8_t> stored = entry.deflated ? deflateStored(entry.data) : entry.data;
+        uint32_t crc = crc32(entry.data);
+        uint32_t headerOffset = static_cast<uint32_t>(result.size());
+
+        uint8_t localHeader[30] = {};
+        encodeUInt32Little(localHeader, 0x04034b50);
+        encodeUInt16Little(localHeader + 4, 20);
+        encodeUInt16Little(localHeader + 8, entry.deflated ? 8 : 0);
+        encodeUInt32Little(localHeader + 14, crc);
+        encodeUInt32Little(localHeader + 18, static_cast<uint32_t>(stored.size()));
+        encodeUInt32Little(localHeader + 22, static_cast<uint32_t>(entry.data.size()));
+        encodeUInt16Little(localHeader + 26, static_cast<uint16_t>(entry.name.size()));
+
+        result.insert(result.end(), localHeader, localHeader + sizeof(localHeader));
+        result.insert(result.end(), entry.name.begin(), entry.name.end());
+        result.insert(result.end(), stored.begin(), stored.end());
+
+        uint8_t centralHeader[46] = {};
+        encodeUInt32Little(centralHeader, 0x02014b50);
+        encodeUInt16Little(centralHeader + 4, 20);
+        encodeUInt16Little(centralHeader + 6, 20);
+        encodeUInt16Little(centralHeader + 10, entry.deflated ? 8 : 0);
+        encodeUInt32Little(centralHeader + 16, crc);
+        encodeUInt32Little(centralHeader + 20, static_cast<uint32_t>(stored.size()));
+        encodeUInt32Little(centralHeader + 24, static_cast<uint32_t>(entry.data.size()));
+        encodeUInt16Little(centralHeader + 28, static_cast<uint16_t>(entry.name.size()));
+        encodeUInt32Little(centralHeader + 42, headerOffset);
+
+        centralDirectory.insert(centralDirectory.end(), centralHeader, centralHeader + sizeof(centralHeader));
+        centralDirectory.insert(centralDirectory.end(), entry.name.begin(), entry.name.end());
+    }
+
+    uint8_t end[22] = {};
+    encodeUInt32Little(end, 0x06054b50);
+    encodeUInt16Little(end + 8, static_cast<uint16_t>(entries.size()));
+    encodeUInt16Little(end + 10, static_cast<uint16_t>(entries.size()));
+    encodeUInt32Little(end + 12, static_cast<uint32_t>(centralDirectory.size()));
+    encodeUInt32Little(end + 16, static_cast<uint32_t>(result.size()));
+
+    result.insert(result.end(), centralDirectory.begin(), centralDirectory.end());
+    result.insert(result.end(), end, end + sizeof(end));
+
+    return result;
+}
+
+int main()
+{
+    TestEngine testEngine;
+    FileSystem* fileSystem = testEngine.getFileSystem();
+
+    std::mt19937 randomEngine(1);
+    std::vector<Entry> entries(ENTRY_COUNT);
+
+    for (uint32_t i = 0; i < ENTRY_COUNT; ++i)
+    {
+        Entry& entry = entries[i];
+        entry.name = "dir/entry" + std::to_string(i) + ".bin";
+        entry.deflated = (i % 2 == 1);
+
+        // includes empty entries and entries that need several Deflate blocks
+        size_t size = (i % 16 == 0) ? 0 : std::uniform_int_distribution<size_t>(1, 200000)(randomEngine);
+        entry.data.resize(size);
+        for (uint8_t& b : entry.data) b = static_cast<uint8_t>(randomEngine());
+    }
+
+    std::string filename = fileSystem->getTempDirectory() + FileSystem::DIRECTORY_SEPARATOR + "ouzel_archive_test.zip";
+    CHECK(fileSystem->writeFile(filename, createArchive(entries)));
+
+    Archive archive;
+    CHECK(archive.open(filename));
+
+    for (const Entry& entry : entries)
+    {
+        std::vector<uint8_t> data;
+        CHECK(archive.readFile(entry.name, data));
+        CHECK(data == entry.data);
+
+        FileMapping mapping;
+        CHECK(archive.mapFile(entry.name, mapping));
+        CHECK(std::vector<uint8_t>(mapping.getData().begin(), mapping.getData().end()) == entry.data);
+    }
+
+    CHECK(!archive.fileExists("missing.bin"));
+
+    // all threads read from the same file descriptor, a shared file position would mix up their data
+    std::atomic<uint32_t> failures(0);
+    std::vector<Thread> threads;
+
+    double time = measure([&]() {
+        for (uint32_t t = 0; t < THREAD_COUNT; ++t)
+        {
+            threads.push_back(Thread([&archive, &entries, &failures, t]() {
+                std::mt19937 threadRandomEngine(t + 100);
+                std::vector<uint8_t> data;
+
+                for (uint32_t i = 0; i < READS_PER_THREAD; ++i)
+                {
+                    const Entry& entry = entries[threadRandomEngine() % ENTRY_COUNT];
+
+                    if (i % 4 == 0)
+                    {
+                        FileMapping mapping;
+                        if (!archive.mapFile(entry.name, mapping) ||
+                            std::vector<uint8_t>(mapping.getData().begin(), mapping.getData().end()) != entry.data)
+                            ++failures;
+                    }
+                    else if (!archive.readFile(entry.name, data) || data != entry.data)
+                    {
+                        ++failures;
+                    }
+                }
+            }));
+        }
+
+        // joins the threads
+        threads.clear();
+    });
+
+    CHECK(failures == 0);
+
+    Log(Log::Level::INFO) << THREAD_COUNT * READS_PER_THREAD << " concurrent reads from " << THREAD_COUNT <<
+        " threads took " << time * 1000.0 << " ms";
+
+    return EXIT_SUCCESS;
+}
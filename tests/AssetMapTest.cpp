@@ -0,0 +1,156 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Test.hpp"
+#include "assets/AssetMap.hpp"
+
+using namespace ouzel;
+using namespace ouzel::assets;
+
+static const uint32_t OPERATION_COUNT = 300000;
+static const uint32_t KEY_COUNT = 3000;
+static const uint32_t BENCHMARK_ASSET_COUNT = 10000;
+static const uint32_t BENCHMARK_LOOKUP_COUNT = 4000000;
+
+static uint32_t getKeyIndex(const std::string& name)
+{
+    return static_cast<uint32_t>(std::stoul(name.substr(5)));
+}
+
+// random inserts, erases and lookups checked against std::unordered_map
+static void testOperations()
+{
+    std::mt19937 randomEngine(1);
+    AssetMap<uint32_t> assetMap;
+    std::unordered_map<std::string, uint32_t> reference;
+
+    for (uint32_t i = 0; i < OPERATION_COUNT; ++i)
+    {
+        std::string name = "asset" + std::to_string(randomEngine() % KEY_COUNT);
+        AssetId id(name);
+        uint32_t operation = randomEngine() % 10;
+
+        if (operation < 5)
+        {
+            uint32_t value = randomEngine();
+            assetMap.insert(id, name) = value;
+            reference[name] = value;
+        }
+        else if (operation < 7)
+        {
+            CHECK(assetMap.erase(id) == (reference.erase(name) > 0));
+        }
+        else if (operation == 7 && randomEngine() % 500 == 0)
+        {
+            uint32_t remainder = randomEngine() % 3;
+
+            assetMap.eraseIf([remainder](const std::string& assetName) {
+                return getKeyIndex(assetName) % 3 == remainder;
+            });
+
+            for (auto r = reference.begin(); r != reference.end();)
+            {
+                if (getKeyIndex(r->first) % 3 == remainder)
+                    r = reference.erase(r);
+                else
+                    ++r;
+            }
+        }
+        else
+        {
+            const uint32_t* value = assetMap.find(id);
+            auto r = reference.find(name);
+
+            CHECK((value != nullptr) == (r != reference.end()));
+            if (value) CHECK(*value == r->second);
+        }
+
+        CHECK(assetMap.size() == reference.size());
+    }
+
+    for (const auto& r : reference)
+    {
+        const uint32_t* value = assetMap.find(AssetId(r.first));
+        CHECK(value && *value == r.second);
+    }
+
+    assetMap.clear();
+    CHECK(assetMap.size() == 0);
+    CHECK(!assetMap.find(AssetId("asset0")));
+}
+
+// the references to the assets must stay valid when the table grows
+static void testReferenceStability()
+{
+    AssetMap<uint32_t> assetMap;
+    uint32_t& first = assetMap.insert(AssetId("first"), "first");
+    first = 42;
+
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        std::string name = "asset" + std::to_string(i);
+        assetMap.insert(AssetId(name), name) = i;
+    }
+
+    CHECK(first == 42);
+    CHECK(assetMap.find(AssetId("first")) == &first);
+}
+
+template<class F>
+static void benchmark(const std::string& label, const std::vector<uint32_t>& order, F function)
+{
+    uint64_t sum = 0;
+    double time = measure([&order, &function, &sum]() {
+        for (uint32_t index : order) sum += function(index);
+    });
+
+    Log(Log::Level::INFO) << label << ": " << order.size() / time / 1000000.0 << " M lookups/s (" << sum % 7 << ")";
+}
+
+static void benchmarkLookups()
+{
+    std::mt19937 randomEngine(1);
+    std::vector<std::string> names;
+    std::vector<AssetId> ids;
+    std::map<std::string, uint32_t> stringMap;
+    AssetMap<uint32_t> assetMap;
+
+    for (uint32_t i = 0; i < BENCHMARK_ASSET_COUNT; ++i)
+    {
+        std::string name = "textures/level" + std::to_string(i / 100) + "/sprite_" + std::to_string(i) + ".png";
+        names.push_back(name);
+        ids.push_back(AssetId(name));
+        stringMap[name] = i;
+        assetMap.insert(AssetId(name), name) = i;
+    }
+
+    std::vector<uint32_t> order(BENCHMARK_LOOKUP_COUNT);
+    for (uint32_t& index : order) index = randomEngine() % BENCHMARK_ASSET_COUNT;
+
+    benchmark("std::map", order, [&stringMap, &names](uint32_t index) {
+        return stringMap.find(names[index])->second;
+    });
+    benchmark("AssetMap, name hashed for each lookup", order, [&assetMap, &names](uint32_t index) {
+        return *assetMap.find(AssetId(names[index]));
+    });
+    benchmark("AssetMap, stored id", order, [&assetMap, &ids](uint32_t index) {
+        return *assetMap.find(ids[index]);
+    });
+}
+
+int main()
+{
+    static_assert(AssetId("abc").getHash() == hashAssetName("abc"), "Asset ids must be computable at compile time");
+    CHECK(AssetId("abc") == AssetId(std::string("abc")));
+
+    testOperations();
+    testReferenceStability();
+    benchmarkLookups();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Test.hpp"
+#include "audio/Kernels.hpp"
+
+using namespace ouzel;
+using namespace ouzel::audio;
+
+static const uint32_t MAX_CHANNELS = 8;
+static const uint32_t BENCHMARK_FRAMES = 512;
+static const uint32_t BENCHMARK_ITERATIONS = 20000;
+static const float MAX_DIFFERENCE = 0.00001f;
+
+static std::vector<float> createSamples(std::mt19937& randomEngine, uint32_t count, float range)
+{
+    std::uniform_real_distribution<float> distribution(-range, range);
+    std::vector<float> samples(count);
+    for (float& sample : samples) sample = distribution(randomEngine);
+    return samples;
+}
+
+static void checkEqual(const std::vector<float>& a, const std::vector<float>& b)
+{
+    CHECK(a.size() == b.size());
+    for (uint32_t i = 0; i < a.size(); ++i) CHECK(fabsf(a[i] - b[i]) <= MAX_DIFFERENCE);
+}
+
+// the kernels have to match a plain loop for any frame count, including the frames left over after the vectors
+static void testKernels(uint32_t frames, uint16_t channels)
+{
+    std::mt19937 randomEngine(frames * MAX_CHANNELS + channels);
+    uint32_t count = frames * channels;
+
+    std::vector<float> source = createSamples(randomEngine, count, 1.0f);
+    std::vector<float> destination = createSamples(randomEngine, count, 1.0f);
+
+    std::vector<float> expected = destination;
+    for (uint32_t i = 0; i < count; ++i) expected[i] += source[i];
+    std::vector<float> result = destination;
+    mix(result.data(), source.data(), count);
+    checkEqual(result, expected);
+
+    std::vector<float> loud = createSamples(randomEngine, count, 2.0f);
+    expected = loud;
+    for (float& sample : expected) sample = std::min(std::max(sample, -1.0f), 1.0f);
+    result = loud;
+    clampSamples(result.data(), count);
+    checkEqual(result, expected);
+
+    std::vector<float> startGains = createSamples(randomEngine, channels, 1.0f);
+    std::vector<float> endGains = createSamples(randomEngine, channels, 1.0f);
+    expected = source;
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        float t = static_cast<float>(frame) / static_cast<float>(frames);
+        for (uint32_t channel = 0; channel < channels; ++channel)
+            expected[frame * channels + channel] *= startGains[channel] + (endGains[channel] - startGains[channel]) * t;
+    }
+    result = source;
+    applyGainRamp(result.data(), frames, channels, startGains.data(), endGains.data());
+    checkEqual(result, expected);
+
+    std::vector<int16_t> converted(count);
+    convertToS16(source.data(), converted.data(), count);
+    for (uint32_t i = 0; i < count; ++i) CHECK(converted[i] == static_cast<int16_t>(source[i] * 32767.0f));
+
+    std::vector<float> stereo(frames * 2);
+    convertMonoToStereo(source.data(), stereo.data(), frames);
+    for (uint32_t frame = 0; frame < frames; ++frame)
+        CHECK(stereo[frame * 2] == source[frame] && stereo[frame * 2 + 1] == source[frame]);
+}
+
+static double toNanosecondsPerFrame(double time)
+{
+    return time * 1000000000.0 / (static_cast<double>(BENCHMARK_FRAMES) * BENCHMARK_ITERATIONS);
+}
+
+static void benchmarkKernels(uint16_t channels)
+{
+    std::mt19937 randomEngine(channels);
+    uint32_t count = BENCHMARK_FRAMES * channels;
+
+    std::vector<float> source = createSamples(randomEngine, count, 0.001f);
+    std::vector<float> destination(count, 0.0f);
+    std::vector<float> startGains(channels, 1.0f);
+    std::vector<float> endGains(channels, 1.0f);
+    std::vector<int16_t> converted(count);
+
+    double mixTime = measure([&]() {
+        for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i)
+            mix(destination.data(), source.data(), count);
+    });
+
+    double scalarMixTime = measure([&]() {
+        for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i)
+            mixKernel<SIMDScalar>(destination.data(), source.data(), 0, count);
+    });
+
+    double gainRampTime = measure([&]() {
+        for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i)
+            applyGainRamp(destination.data(), BENCHMARK_FRAMES, channels, startGains.data(), endGains.data());
+    });
+
+    double convertTime = measure([&]() {
+        for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; ++i)
+        {
+            clampSamples(destination.data(), count);
+            convertToS16(destination.data(), converted.data(), count);
+        }
+    });
+
+    Log(Log::Level::INFO) << channels << " channels: mix " << toNanosecondsPerFrame(mixTime) <<
+        " ns/frame (scalar " << toNanosecondsPerFrame(scalarMixTime) << "), gain ramp " <<
+        toNanosecondsPerFrame(gainRampTime) << " ns/frame, clamp and convert " <<
+        toNanosecondsPerFrame(convertTime) << " ns/frame (" << converted[0] << ")";
+}
+
+int main()
+{
+    const uint32_t frameCounts[] = {0, 1, 3, 4, 7, 64, 509, 512};
+
+    for (uint32_t frames : frameCounts)
+        for (uint16_t channels = 1; channels <= MAX_CHANNELS; ++channels)
+            testKernels(frames, channels);
+
+    const uint16_t benchmarkChannels[] = {2, 6, 8};
+
+    for (uint16_t channels : benchmarkChannels)
+        benchmarkKernels(channels);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Test.hpp"
+#include "audio/offline/AudioDeviceOffline.hpp"
+#include "files/FileSystem.hpp"
+#include "utils/Utils.hpp"
+
+using namespace ouzel;
+using namespace ouzel::audio;
+
+static const uint32_t BUFFER_FRAMES = 512;
+static const uint32_t SAMPLE_RATE = 44100;
+static const uint16_t CHANNELS = 2;
+static const uint32_t TEST_VOICES = 6;
+static const uint32_t TEST_BUSES = 2;
+static const uint32_t TEST_FRAMES = 10000; // not a multiple of the buffer size
+static const uint32_t BENCHMARK_VOICES = 64;
+static const uint32_t BENCHMARK_BUSES = 8;
+static const uint32_t BENCHMARK_SECONDS = 60;
+static const float BUS_GAIN = 0.5f;
+static const float MAX_DIFFERENCE = 0.00001f;
+
+class TestAudioDevice: public AudioDeviceOffline
+{
+public:
+    TestAudioDevice()
+    {
+        bufferSize = BUFFER_FRAMES;
+        sampleRate = SAMPLE_RATE;
+        channels = CHANNELS;
+    }
+};
+
+// a sine wave panned between the two channels, it stands in for a Sound
+class Voice
+{
+public:
+    explicit Voice(uint32_t index):
+        frequency(110.0f + index * 37.0f),
+        pan((index % 5) / 4.0f)
+    {
+    }
+
+    void render(uint32_t frames, uint16_t channels, float gain, float* result)
+    {
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            float sample = next() * gain;
+            result[frame * channels + 0] += sample * (1.0f - pan);
+            result[frame * channels + 1] += sample * pan;
+        }
+    }
+
+    float next()
+    {
+        const float pi = 3.14159265358979323846f;
+        float sample = sinf(phase);
+
+        phase += 2.0f * pi * frequency / SAMPLE_RATE;
+        if (phase > 2.0f * pi) phase -= 2.0f * pi;
+
+        return sample;
+    }
+
+    float frequency;
+    float pan;
+    float phase = 0.0f;
+};
+
+// the same graph as buses of a Mixer that each play several Sounds
+static void setRenderGraph(AudioDevice& device, std::vector<Voice>& voices, uint32_t busCount)
+{
+    RenderGraph* renderGraph = device.acquireRenderGraph();
+
+    for (uint32_t bus = 0; bus < busCount; ++bus)
+    {
+        uint32_t busNode = renderGraph->beginNode([](Vector3&, Quaternion&, float&, float& gain, float&) {
+            gain = BUS_GAIN;
+        });
+
+        for (uint32_t index = bus; index < voices.size(); index += busCount)
+        {
+            Voice* voice = &voices[index];
+
+            uint32_t voiceNode = renderGraph->beginNode(nullptr, [voice](uint32_t frames,
+                                                                         uint16_t channels,
+                                                                         uint32_t,
+                                                                         const Vector3&,
+                                                                         const Quaternion&,
+                                                                         float,
+                                                                         float gain,
+                                                                         float,
+                                                                         float* result) {
+                voice->render(frames, channels, gain, result);
+                return true;
+            });
+            renderGraph->endNode(voiceNode);
+        }
+
+        renderGraph->endNode(busNode);
+    }
+
+    renderGraph->prepare(AudioDevice::MAX_RENDER_FRAMES, CHANNELS);
+    device.setRenderGraph(renderGraph);
+}
+
+// the expected output, the voices of each bus are mixed in the order they were added
+static std::vector<float> renderGolden(uint32_t voiceCount, uint32_t busCount, uint32_t frames)
+{
+    std::vector<Voice> voices;
+    for (uint32_t index = 0; index < voiceCount; ++index) voices.push_back(Voice(index));
+
+    std::vector<float> result(frames * CHANNELS, 0.0f);
+
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        for (uint32_t bus = 0; bus < busCount; ++bus)
+        {
+            float busSamples[CHANNELS] = {0.0f, 0.0f};
+            for (uint32_t index = bus; index < voiceCount; index += busCount)
+                voices[index].render(1, CHANNELS, BUS_GAIN, busSamples);
+
+            for (uint16_t channel = 0; channel < CHANNELS; ++channel)
+                result[frame * CHANNELS + channel] += busSamples[channel];
+        }
+
+        for (uint16_t channel = 0; channel < CHANNELS; ++channel)
+        {
+            float& sample = result[frame * CHANNELS + channel];
+            sample = std::min(std::max(sample, -1.0f), 1.0f);
+        }
+    }
+
+    return result;
+}
+
+// the header has to describe the 32-bit float samples that follow it
+static std::vector<float> readWave(FileSystem* fileSystem, const std::string& filename)
+{
+    std::vector<uint8_t> data;
+    CHECK(fileSystem->readFile(filename, data, false));
+    CHECK(data.size() >= 44);
+
+    uint32_t dataSize = static_cast<uint32_t>(data.size() - 44);
+
+    CHECK(std::string(data.begin(), data.begin() + 4) == "RIFF");
+    CHECK(decodeUInt32Little(data.data() + 4) == 36 + dataSize);
+    CHECK(std::string(data.begin() + 8, data.begin() + 16) == "WAVEfmt ");
+    CHECK(decodeUInt16Little(data.data() + 20) == 3); // IEEE float
+    CHECK(decodeUInt16Little(data.data() + 22) == CHANNELS);
+    CHECK(decodeUInt32Little(data.data() + 24) == SAMPLE_RATE);
+    CHECK(decodeUInt16Little(data.data() + 34) == 32);
+    CHECK(std::string(data.begin() + 36, data.begin() + 40) == "data");
+    CHECK(decodeUInt32Little(data.data() + 40) == dataSize);
+
+    std::vector<float> samples(dataSize / sizeof(float));
+    for (uint32_t i = 0; i < samples.size(); ++i)
+    {
+        uint32_t value = decodeUInt32Little(data.data() + 44 + i * sizeof(float));
+        memcpy(&samples[i], &value, sizeof(float));
+    }
+
+    return samples;
+}
+
+static void testGoldenOutput(FileSystem* fileSystem)
+{
+    std::string filename = fileSystem->getTempDirectory() + FileSystem::DIRECTORY_SEPARATOR + "ouzel_offline_test.wav";
+    std::vector<float> expected = renderGolden(TEST_VOICES, TEST_BUSES, TEST_FRAMES);
+
+    // renders on the calling thread
+    {
+        TestAudioDevice device;
+        std::vector<Voice> voices;
+        for (uint32_t index = 0; index < TEST_VOICES; ++index) voices.push_back(Voice(index));
+        setRenderGraph(device, voices, TEST_BUSES);
+
+        CHECK(device.openOutputFile(filename));
+        CHECK(device.render(TEST_FRAMES));
+        device.closeOutputFile();
+
+        CHECK(device.getRenderedFrames() == TEST_FRAMES);
+
+        AudioProfiler::Stats stats = device.getProfiler().getStats();
+        CHECK(stats.callbackCount == (TEST_FRAMES + BUFFER_FRAMES - 1) / BUFFER_FRAMES);
+        CHECK(stats.renderedFrames == TEST_FRAMES);
+        device.getProfiler().reset();
+    }
+
+    std::vector<float> samples = readWave(fileSystem, filename);
+    CHECK(samples.size() == expected.size());
+    for (uint32_t i = 0; i < samples.size(); ++i) CHECK(fabsf(samples[i] - expected[i]) <= MAX_DIFFERENCE);
+
+    // the render thread has to produce exactly the same file
+    {
+        TestAudioDevice device;
+        std::vector<Voice> voices;
+        for (uint32_t index = 0; index < TEST_VOICES; ++index) voices.push_back(Voice(index));
+        setRenderGraph(device, voices, TEST_BUSES);
+
+        CHECK(device.openOutputFile(filename));
+        device.start(TEST_FRAMES);
+        while (device.isRunning()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        device.stop();
+        device.closeOutputFile();
+
+        CHECK(device.getRenderedFrames() == TEST_FRAMES);
+        device.getProfiler().reset();
+    }
+
+    CHECK(readWave(fileSystem, filename) == samples);
+}
+
+static void benchmark()
+{
+    TestAudioDevice device;
+    std::vector<Voice> voices;
+    for (uint32_t index = 0; index < BENCHMARK_VOICES; ++index) voices.push_back(Voice(index));
+    setRenderGraph(device, voices, BENCHMARK_BUSES);
+
+    uint64_t frames = static_cast<uint64_t>(SAMPLE_RATE) * BENCHMARK_SECONDS;
+
+    double time = measure([&device, frames]() {
+        CHECK(device.render(frames));
+    });
+
+    AudioProfiler::Stats stats = device.getProfiler().getStats();
+
+    Log(Log::Level::INFO) << BENCHMARK_VOICES << " voices, " << BUFFER_FRAMES << " frames: " <<
+        BENCHMARK_SECONDS / time << "x real time, " <<
+        static_cast<double>(stats.totalRenderTime) / stats.callbackCount << " us per callback (max " <<
+        stats.maxRenderTime << " us)";
+
+    device.getProfiler().reset();
+}
+
+int main()
+{
+    TestEngine testEngine;
+
+    testGoldenOutput(testEngine.getFileSystem());
+    benchmark();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cmath>
+#include <vector>
+#include "Test.hpp"
+#include "audio/AudioDevice.hpp"
+
+using namespace ouzel;
+using namespace ouzel::audio;
+
+static const uint32_t VOICE_COUNT = 256;
+static const uint32_t BUS_COUNT = 8;
+static const uint32_t BUFFER_FRAMES = 512;
+static const uint32_t CALLBACK_COUNT = 200;
+static const uint32_t SAMPLE_RATE = 44100;
+
+// Device without an audio API, it renders the graph when the benchmark asks for data
+class BenchmarkDevice: public AudioDevice
+{
+public:
+    explicit BenchmarkDevice(uint32_t renderWorkerCount):
+        AudioDevice(Audio::Driver::EMPTY)
+    {
+        format = Audio::Format::FLOAT32;
+        sampleRate = SAMPLE_RATE;
+        channels = 2;
+
+        if (renderWorkerCount > 0) renderWorkers.reset(new RenderWorkers(renderWorkerCount));
+    }
+
+    bool render(std::vector<uint8_t>& result)
+    {
+        return getData(BUFFER_FRAMES, result);
+    }
+};
+
+// stands in for a decoded, resampled and panned sound
+static bool renderVoice(float& phase, float frequency,
+                        uint32_t frames, uint16_t channels, uint32_t sampleRate,
+                        float gain, float* result)
+{
+    const float pi = 3.14159265358979323846f;
+    float step = 2.0f * pi * frequency / sampleRate;
+
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        float sample = sinf(phase) * gain;
+        float pan = 0.5f + 0.5f * sinf(phase * 0.01f);
+
+        result[frame * channels + 0] += sample * (1.0f - pan);
+        result[frame * channels + 1] += sample * pan;
+
+        phase += step;
+        if (phase > 2.0f * pi) phase -= 2.0f * pi;
+    }
+
+    return true;
+}
+
+// renders VOICE_COUNT voices grouped into buses and returns the time of one callback in milliseconds
+static double renderVoices(uint32_t renderWorkerCount, std::vector<uint8_t>& output)
+{
+    BenchmarkDevice device(renderWorkerCount);
+    std::vector<float> phases(VOICE_COUNT, 0.0f);
+
+    RenderGraph* renderGraph = device.acquireRenderGraph();
+
+    for (uint32_t bus = 0; bus < BUS_COUNT; ++bus)
+    {
+        uint32_t busNode = renderGraph->beginNode([](Vector3&, Quaternion&, float&, float& gain, float&) {
+            gain = 1.0f / VOICE_COUNT;
+        });
+
+        for (uint32_t voice = bus; voice < VOICE_COUNT; voice += BUS_COUNT)
+        {
+            float* phase = &phases[voice];
+            float frequency = 110.0f + voice * 3.0f;
+
+            uint32_t voiceNode = renderGraph->beginNode(nullptr, [phase, frequency](uint32_t frames,
+                                                                                    uint16_t channels,
+                                                                                    uint32_t sampleRate,
+                                                                                    const Vector3&,
+                                                                                    const Quaternion&,
+                                                                                    float,
+                                                                                    float gain,
+                                                                                    float,
+                                                                                    float* result) {
+                return renderVoice(*phase, frequency, frames, channels, sampleRate, gain, result);
+            });
+            renderGraph->endNode(voiceNode);
+        }
+
+        renderGraph->endNode(busNode);
+    }
+
+    renderGraph->prepare(BUFFER_FRAMES, 2);
+    device.setRenderGraph(renderGraph);
+
+    std::vector<uint8_t> data;
+    output.clear();
+
+    double time = measure([&device, &data, &output]() {
+        for (uint32_t i = 0; i < CALLBACK_COUNT; ++i)
+        {
+            CHECK(device.render(data));
+            output.insert(output.end(), data.begin(), data.end());
+        }
+    });
+
+    return time * 1000.0 / CALLBACK_COUNT;
+}
+
+int main()
+{
+    std::vector<uint8_t> expected;
+    double serialTime = renderVoices(0, expected);
+
+    Log(Log::Level::INFO) << VOICE_COUNT << " voices, " << BUFFER_FRAMES << " frames: " <<
+        serialTime << " ms per callback on the audio thread";
+
+    for (uint32_t renderWorkerCount = 1; renderWorkerCount <= 3; ++renderWorkerCount)
+    {
+        std::vector<uint8_t> output;
+        double time = renderVoices(renderWorkerCount, output);
+
+        // the children are mixed in a fixed order, so the workers must not change the result
+        CHECK(output == expected);
+
+        Log(Log::Level::INFO) << VOICE_COUNT << " voices, " << BUFFER_FRAMES << " frames: " <<
+            time << " ms per callback with " << renderWorkerCount << " render workers (" <<
+            serialTime / time << "x)";
+    }
+
+    return EXIT_SUCCESS;
+}
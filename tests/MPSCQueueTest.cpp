@@ -0,0 +1,115 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include "Test.hpp"
+#include "thread/Lock.hpp"
+#include "thread/MPSCQueue.hpp"
+#include "thread/Mutex.hpp"
+#include "thread/SmallFunction.hpp"
+#include "thread/Thread.hpp"
+
+using namespace ouzel;
+
+static const uint32_t MAX_PRODUCERS = 16;
+static const uint32_t PUSH_COUNT = 400000; // in total, divided between the producers
+static const uint32_t QUEUE_CAPACITY = 1024; // the same as the audio command queue
+
+// what the command queues looked like before MPSCQueue
+class LockedQueue final
+{
+public:
+    void push(std::function<void()> function)
+    {
+        Lock lock(mutex);
+        functions.push(std::move(function));
+    }
+
+    template<class F>
+    void drain(F function)
+    {
+        for (;;)
+        {
+            std::function<void()> current;
+
+            {
+                Lock lock(mutex);
+                if (functions.empty()) return;
+                current = std::move(functions.front());
+                functions.pop();
+            }
+
+            function(current);
+        }
+    }
+
+private:
+    Mutex mutex;
+    std::queue<std::function<void()>> functions;
+};
+
+// Pushes commands from the producer threads while the calling thread consumes them. Every command checks that
+// the commands of its producer arrive in order. Returns the number of pushes per second.
+template<class Value, class Queue>
+static double benchmark(Queue& queue, uint32_t producerCount)
+{
+    uint32_t pushesPerProducer = PUSH_COUNT / producerCount;
+    std::vector<uint32_t> nextValues(producerCount, 0);
+    uint32_t consumedCount = 0;
+    bool ordered = true;
+
+    double time = measure([&]() {
+        std::vector<Thread> producers;
+
+        for (uint32_t producer = 0; producer < producerCount; ++producer)
+        {
+            producers.push_back(Thread([&queue, &nextValues, &consumedCount, &ordered, producer, pushesPerProducer]() {
+                uint32_t* nextValue = &nextValues[producer];
+                uint32_t* consumed = &consumedCount;
+                bool* order = &ordered;
+
+                for (uint32_t value = 0; value < pushesPerProducer; ++value)
+                {
+                    queue.push(Value([nextValue, consumed, order, value]() {
+                        if (*nextValue != value) *order = false;
+                        *nextValue = value + 1;
+                        ++*consumed;
+                    }));
+                }
+            }));
+        }
+
+        while (consumedCount < pushesPerProducer * producerCount)
+        {
+            queue.drain([](Value& function) {
+                function();
+            });
+        }
+
+        // joins the producers
+        producers.clear();
+    });
+
+    CHECK(ordered);
+
+    return pushesPerProducer * producerCount / time;
+}
+
+int main()
+{
+    for (uint32_t producerCount = 1; producerCount <= MAX_PRODUCERS; producerCount *= 2)
+    {
+        LockedQueue lockedQueue;
+        double lockedRate = benchmark<std::function<void()>>(lockedQueue, producerCount);
+
+        MPSCQueue<SmallFunction> queue(QUEUE_CAPACITY);
+        double rate = benchmark<SmallFunction>(queue, producerCount);
+
+        Log(Log::Level::INFO) << producerCount << " producers: MPSCQueue " << rate / 1000000.0 <<
+            " M pushes/s, mutex and std::queue " << lockedRate / 1000000.0 << " M pushes/s";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <cmath>
+#include <vector>
+#include "Test.hpp"
+#include "scene/Actor.hpp"
+#include "scene/ParticleSystem.hpp"
+
+using namespace ouzel;
+using namespace ouzel::scene;
+
+static const float UPDATE_STEP = 1.0f / 60.0f;
+static const uint32_t TEST_PARTICLES = 1003; // not a multiple of the vector size
+static const uint32_t TEST_STEPS = 100;
+static const float MAX_DIFFERENCE = 0.001f;
+
+// Gives access to the particle kernels without a renderer. The particles are emitted by hand and the vertices and
+// instances are written to vectors instead of mapped buffers.
+class TestParticleSystem: public ParticleSystem
+{
+public:
+    explicit TestParticleSystem(uint32_t count)
+    {
+        particleSystemData.emitterType = ParticleSystemData::EmitterType::GRAVITY;
+        particleSystemData.maxParticles = count;
+        particleSystemData.particleLifespan = 1000.0f; // no particle dies during the test
+        particleSystemData.particleLifespanVariance = 0.0f;
+        particleSystemData.gravity = Vector2(0.0f, -100.0f);
+        particleSystemData.radialAcceleration = 20.0f;
+        particleSystemData.tangentialAcceleration = 10.0f;
+        particleSystemData.startRotationVariance = 180.0f;
+        particleSystemData.finishRotation = 360.0f;
+
+        actor.addComponent(this);
+        particles.resize(count);
+        emitParticles(count);
+    }
+
+    ~TestParticleSystem()
+    {
+        removeFromActor();
+    }
+
+    inline uint32_t getParticleCount() const { return particleCount; }
+
+    void simulate()
+    {
+        updateParticles(UPDATE_STEP, 0, particleCount);
+    }
+
+    // ranges shorter than the vector size are updated by the scalar kernel
+    void simulateScalar()
+    {
+        for (uint32_t i = 0; i < particleCount; ++i) updateParticles(UPDATE_STEP, i, i + 1);
+    }
+
+    // the scalar kernels are the reference for the vector kernels
+    void checkVectorKernels()
+    {
+        Particles initialParticles = particles;
+
+        for (uint32_t step = 0; step < TEST_STEPS; ++step) simulate();
+        Particles vectorParticles = particles;
+
+        particles = initialParticles;
+        for (uint32_t step = 0; step < TEST_STEPS; ++step) simulateScalar();
+
+        for (uint32_t i = 0; i < particleCount; ++i)
+        {
+            checkEqual(vectorParticles.positionX[i], particles.positionX[i]);
+            checkEqual(vectorParticles.positionY[i], particles.positionY[i]);
+            checkEqual(vectorParticles.colorAlpha[i], particles.colorAlpha[i]);
+            checkEqual(vectorParticles.size[i], particles.size[i]);
+            checkEqual(vectorParticles.rotation[i], particles.rotation[i]);
+        }
+    }
+
+    // the particle shader has to turn each instance into the quad that expandParticles writes
+    void checkInstances()
+    {
+        const Vector2 offset(10.0f, -20.0f);
+
+        std::vector<graphics::Vertex> vertices(particleCount * 4);
+        expandParticles(vertices.data(), offset);
+
+        std::vector<graphics::InstanceVertex> instances(particleCount);
+        writeInstances(instances.data(), offset);
+
+        for (uint32_t i = 0; i < particleCount; ++i)
+        {
+            const graphics::InstanceVertex& instance = instances[i];
+            float sine = sinf(instance.rotation);
+            float cosine = cosf(instance.rotation);
+
+            for (uint32_t corner = 0; corner < 4; ++corner)
+            {
+                const graphics::Vertex& vertex = vertices[i * 4 + corner];
+
+                // the corners of the quad in the vertex buffer, in the same order
+                float x = ((corner & 1) ? 0.5f : -0.5f) * instance.size;
+                float y = ((corner & 2) ? 0.5f : -0.5f) * instance.size;
+
+                checkEqual(instance.position.x + x * cosine - y * sine, vertex.position.x);
+                checkEqual(instance.position.y + x * sine + y * cosine, vertex.position.y);
+                CHECK(instance.color.getIntValue() == vertex.color.getIntValue());
+            }
+        }
+    }
+
+private:
+    static void checkEqual(float a, float b)
+    {
+        CHECK(fabsf(a - b) <= MAX_DIFFERENCE * std::max(1.0f, fabsf(b)));
+    }
+
+    Actor actor;
+};
+
+static void benchmark(uint32_t count)
+{
+    TestParticleSystem particleSystem(count);
+    CHECK(particleSystem.getParticleCount() == count);
+
+    uint32_t iterations = std::max(10000000U / count, 1U);
+
+    double simulateTime = measure([&particleSystem, iterations]() {
+        for (uint32_t i = 0; i < iterations; ++i) particleSystem.simulate();
+    });
+
+    double scalarSimulateTime = measure([&particleSystem, iterations]() {
+        for (uint32_t i = 0; i < iterations; ++i) particleSystem.simulateScalar();
+    });
+
+    double particles = static_cast<double>(count) * iterations / 1000.0; // in thousands, so the rate is per ms
+
+    Log(Log::Level::INFO) << count << " particles: " << particles / (simulateTime * 1000.0) <<
+        "k particles/ms, scalar kernel " << particles / (scalarSimulateTime * 1000.0) << "k particles/ms";
+}
+
+int main()
+{
+    TestEngine testEngine;
+
+    // radius emitters don't set the life of their particles, so they can't be simulated for several steps
+    TestParticleSystem particleSystem(TEST_PARTICLES);
+    particleSystem.checkVectorKernels();
+    particleSystem.checkInstances();
+
+    const uint32_t counts[] = {10000, 100000, 1000000};
+
+    for (uint32_t count : counts)
+        benchmark(count);
+
+    return EXIT_SUCCESS;
+}
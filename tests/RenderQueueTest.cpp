@@ -0,0 +1,191 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+#include "Test.hpp"
+#include "graphics/Renderer.hpp"
+#include "graphics/empty/RenderDeviceEmpty.hpp"
+#include "scene/Actor.hpp"
+#include "scene/Camera.hpp"
+#include "scene/Layer.hpp"
+#include "scene/Sprite.hpp"
+
+using namespace ouzel;
+using namespace ouzel::graphics;
+using namespace ouzel::scene;
+
+static const uint32_t SPRITE_COUNT = 5000; // sprites per frame
+// the batch buffers alternate between two sets and their staging data is swapped with the buffer data, so every
+// buffer has to be filled twice before its vectors are big enough
+static const uint32_t WARMUP_FRAMES = 4;
+static const uint32_t BENCHMARK_FRAMES = 200;
+
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void* result = malloc(size ? size : 1)) return result;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    free(pointer);
+}
+
+// every sprite has its own color, so that neighbouring sprites can't be merged into one batch
+static float getSpriteRed(uint32_t index)
+{
+    return Color(static_cast<uint8_t>(index % 255), 255, 255, 255).normR();
+}
+
+// Empty device that checks the commands and constants it receives instead of drawing them
+class TestRenderDevice: public RenderDeviceEmpty
+{
+public:
+    virtual bool draw(const DrawQueue& queue) override
+    {
+        CHECK(queue.drawCommands.size() == expectedDrawCount);
+
+        for (uint32_t i = 0; i < queue.drawCommands.size(); ++i)
+        {
+            const DrawCommand& drawCommand = queue.drawCommands[i];
+            CHECK(drawCommand.pixelShaderConstantCount == 1);
+            CHECK(drawCommand.vertexShaderConstantCount == 1);
+
+            const ShaderConstant& pixelShaderConstant = queue.shaderConstants[drawCommand.pixelShaderConstantStart];
+            CHECK(pixelShaderConstant.size == 4);
+            CHECK(queue.getConstantData(pixelShaderConstant)[0] == getSpriteRed(i));
+
+            const ShaderConstant& vertexShaderConstant = queue.shaderConstants[drawCommand.vertexShaderConstantStart];
+            CHECK(vertexShaderConstant.size == 16);
+        }
+
+        return true;
+    }
+
+    uint32_t expectedDrawCount = 0;
+};
+
+class TestRenderer: public Renderer
+{
+public:
+    TestRenderer():
+        Renderer(Driver::EMPTY)
+    {
+        device.reset(new TestRenderDevice());
+    }
+
+    bool init()
+    {
+        return Renderer::init(nullptr, Size2(800.0f, 600.0f), 1, Texture::Filter::POINT, 1, false, false, false);
+    }
+};
+
+// TestEngine with a renderer that draws to the test device
+class RenderTestEngine: public TestEngine
+{
+public:
+    bool initRenderer()
+    {
+        TestRenderer* testRenderer = new TestRenderer();
+        renderer.reset(testRenderer);
+        return testRenderer->init();
+    }
+};
+
+// a camera and a grid of sprites, every other sprite is drawn outside of the batches
+class TestScene
+{
+public:
+    TestScene()
+    {
+        cameraActor.addComponent(&camera);
+        layer.addChild(&cameraActor);
+        // the scene does this when it is entered
+        camera.recalculateProjection();
+
+        std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+        CHECK(texture->init({255, 255, 255, 255}, Size2(1.0f, 1.0f)));
+
+        for (uint32_t i = 0; i < SPRITE_COUNT; ++i)
+        {
+            std::unique_ptr<Sprite> sprite(new Sprite());
+            CHECK(sprite->init(texture));
+            sprite->getMaterial()->diffuseColor = Color(static_cast<uint8_t>(i % 255), 255, 255, 255);
+
+            std::unique_ptr<Actor> actor(new Actor());
+            actor->addComponent(sprite.get());
+            actor->setPosition(Vector2(static_cast<float>(i % 100) * 4.0f - 200.0f,
+                                       static_cast<float>(i / 100) * 4.0f - 100.0f));
+            actor->setBatchingDisabled(i % 2 != 0);
+            layer.addChild(actor.get());
+
+            sprites.push_back(std::move(sprite));
+            actors.push_back(std::move(actor));
+        }
+    }
+
+    Layer layer;
+    Camera camera;
+    Actor cameraActor;
+    std::vector<std::unique_ptr<Sprite>> sprites;
+    std::vector<std::unique_ptr<Actor>> actors;
+};
+
+// draws the layer the way the engine does and returns the number of allocations made during the frame
+static uint64_t renderFrame(Renderer* renderer, TestScene& scene)
+{
+    uint64_t startAllocationCount = allocationCount;
+
+    scene.layer.draw();
+    renderer->flushCommands();
+    CHECK(renderer->getDevice()->process());
+
+    return allocationCount - startAllocationCount;
+}
+
+int main()
+{
+    RenderTestEngine testEngine;
+    CHECK(testEngine.initRenderer());
+
+    Renderer* renderer = testEngine.getRenderer();
+    static_cast<TestRenderDevice*>(renderer->getDevice())->expectedDrawCount = SPRITE_COUNT;
+
+    uint64_t setupAllocationCount = allocationCount;
+    TestScene scene;
+    setupAllocationCount = allocationCount - setupAllocationCount;
+
+    // the queues, the batch buffers and the layer's lists grow during the first frames
+    uint64_t warmupAllocationCount = 0;
+    for (uint32_t frame = 0; frame < WARMUP_FRAMES; ++frame)
+        warmupAllocationCount += renderFrame(renderer, scene);
+
+    uint64_t steadyAllocationCount = 0;
+
+    double time = measure([&]() {
+        for (uint32_t frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+            steadyAllocationCount += renderFrame(renderer, scene);
+    });
+
+    Log(Log::Level::INFO) << SPRITE_COUNT << " sprites per frame: " <<
+        time * 1000000000.0 / (static_cast<double>(SPRITE_COUNT) * BENCHMARK_FRAMES) << " ns/sprite, " <<
+        setupAllocationCount << " allocations to set up the scene, " <<
+        warmupAllocationCount << " allocations in " << WARMUP_FRAMES << " warmup frames, " <<
+        steadyAllocationCount << " allocations in " << BENCHMARK_FRAMES << " steady frames";
+
+    CHECK(steadyAllocationCount == 0);
+
+    return EXIT_SUCCESS;
+}
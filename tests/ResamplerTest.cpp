@@ -0,0 +1,89 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Test.hpp"
+#include "audio/Resampler.hpp"
+
+using namespace ouzel;
+using namespace ouzel::audio;
+
+static const uint16_t CHANNELS = 2;
+static const uint32_t FRAMES = 20000;
+static const uint32_t MAX_BLOCK_FRAMES = 300;
+// the read position is accumulated per block, so the blocks are allowed to drift by a rounding error
+static const float MAX_DIFFERENCE = 0.0001f;
+
+static std::vector<float> createSource(uint32_t frames)
+{
+    const float pi = 3.14159265358979323846f;
+    std::vector<float> samples(frames * CHANNELS);
+
+    for (uint32_t frame = 0; frame < frames; ++frame)
+    {
+        samples[frame * CHANNELS + 0] = sinf(2.0f * pi * frame / 37.0f);
+        samples[frame * CHANNELS + 1] = 0.5f * sinf(2.0f * pi * frame / 101.0f) + 0.25f * cosf(2.0f * pi * frame / 13.0f);
+    }
+
+    return samples;
+}
+
+// resampling a stream in blocks of random size must give the same frames as resampling it in one call
+static void testBlockBoundaries(Resampler::Quality quality, double ratio)
+{
+    Resampler single(quality);
+    uint32_t sourceFrames = single.getSourceFrames(FRAMES, ratio);
+    std::vector<float> source = createSource(sourceFrames);
+
+    std::vector<float> expected(FRAMES * CHANNELS);
+    single.process(source.data(), sourceFrames, CHANNELS, expected.data(), FRAMES, ratio);
+
+    std::mt19937 randomEngine(1);
+    Resampler blocks(quality);
+    std::vector<float> result(FRAMES * CHANNELS);
+    uint32_t sourceOffset = 0;
+
+    for (uint32_t offset = 0; offset < FRAMES;)
+    {
+        uint32_t frames = std::min(static_cast<uint32_t>(randomEngine() % MAX_BLOCK_FRAMES) + 1, FRAMES - offset);
+        uint32_t neededFrames = blocks.getSourceFrames(frames, ratio);
+        CHECK(sourceOffset + neededFrames <= sourceFrames);
+
+        blocks.process(source.data() + sourceOffset * CHANNELS, neededFrames, CHANNELS,
+                       result.data() + offset * CHANNELS, frames, ratio);
+
+        sourceOffset += neededFrames;
+        offset += frames;
+    }
+
+    float maxDifference = 0.0f;
+    for (uint32_t i = 0; i < result.size(); ++i)
+        maxDifference = std::max(maxDifference, fabsf(result[i] - expected[i]));
+
+    if (maxDifference > MAX_DIFFERENCE)
+    {
+        Log(Log::Level::ERR) << "Quality " << static_cast<int>(quality) << ", ratio " << ratio <<
+            ": block output differs by " << maxDifference;
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main()
+{
+    const Resampler::Quality qualities[] = {
+        Resampler::Quality::LINEAR,
+        Resampler::Quality::CUBIC,
+        Resampler::Quality::SINC
+    };
+
+    const double ratios[] = {0.5, 44100.0 / 48000.0, 1.0, 48000.0 / 44100.0, 1.5, 2.0, 3.3};
+
+    for (Resampler::Quality quality : qualities)
+        for (double ratio : ratios)
+            testBlockBoundaries(quality, ratio);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,12 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#include "Test.hpp"
+
+std::string DEVELOPER_NAME = "org.ouzel";
+std::string APPLICATION_NAME = "tests";
+
+// the tests have their own main functions and never run the engine
+void ouzelMain(const std::vector<std::string>&)
+{
+}
@@ -0,0 +1,39 @@
+// Copyright (C) 2018 Elviss Strazdins
+// This file is part of the Ouzel engine.
+
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include "core/Engine.hpp"
+#include "utils/Log.hpp"
+
+// Engine that is never initialized, so it has no window, renderer or audio device. The tests use only the parts of
+// the engine that work without them (file system, cache and the job system if they create one).
+class TestEngine: public ouzel::Engine
+{
+public:
+    virtual void executeOnMainThread(const std::function<void(void)>& func) override
+    {
+        func();
+    }
+};
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            ouzel::Log(ouzel::Log::Level::ERR) << __FILE__ << ":" << __LINE__ << ": " << #condition << " failed"; \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+// returns the time that the function took in seconds
+inline double measure(const std::function<void()>& function)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}